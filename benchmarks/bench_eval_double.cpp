@@ -43,3 +43,8 @@ NONIUS_BENCHMARK("eval_double_single_dispatch", [](nonius::chronometer meter) {
     double r;
     meter.measure([&](int i) { r = eval_double_single_dispatch(*e); });
 })
+
+NONIUS_BENCHMARK("eval_double_iterative", [](nonius::chronometer meter) {
+    double r;
+    meter.measure([&](int i) { r = eval_double_iterative(*e); });
+})
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <chrono>
+#include <functional>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/functions.h>
+#include <symengine/visitor.h>
+#include <symengine/derivative.h>
+#include <symengine/subs.h>
+
+using SymEngine::Basic;
+using SymEngine::Symbol;
+using SymEngine::RCP;
+using SymEngine::symbol;
+using SymEngine::integer;
+using SymEngine::add;
+using SymEngine::mul;
+using SymEngine::pow;
+using SymEngine::sin;
+using SymEngine::cos;
+using SymEngine::exp;
+using SymEngine::rcp_static_cast;
+using SymEngine::has_symbol;
+using SymEngine::vec_basic;
+
+// Time of N (10 by default) repetitions of diff, has_symbol and subs w.r.t.
+// every symbol of a sum of M (100 by default) large terms, each of which
+// depends on a single symbol. With WITH_SYMENGINE_SYMBOL_SIGNATURE, the
+// terms without the symbol are skipped.
+void report(const char *name, std::function<void()> f)
+{
+    auto t1 = std::chrono::high_resolution_clock::now();
+    f();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    double t = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    std::cout << name << ": " << t << "ms" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+    unsigned n = 10, m = 100;
+    if (argc >= 2)
+        n = std::atoi(argv[1]);
+    if (argc >= 3)
+        m = std::atoi(argv[2]);
+
+    vec_basic x;
+    RCP<const Basic> e = integer(0);
+    for (unsigned j = 0; j < m; j++) {
+        x.push_back(symbol("x" + std::to_string(j)));
+        RCP<const Basic> t = x[j];
+        for (unsigned k = 0; k < 20; k++) {
+            t = add(mul(sin(t), pow(x[j], integer(k + 2))),
+                    exp(mul(integer(k + 1), x[j])));
+        }
+        e = add(e, t);
+    }
+
+    unsigned count = 0;
+    report("diff", [&]() {
+        for (unsigned i = 0; i < n; i++) {
+            for (const auto &s : x) {
+                auto d = e->diff(rcp_static_cast<const Symbol>(s));
+                count += d->get_args().size();
+            }
+        }
+    });
+    report("has_symbol", [&]() {
+        for (unsigned i = 0; i < n; i++) {
+            for (unsigned j = 0; j < m; j++) {
+                // A symbol that doesn't occur, so all terms are searched
+                count += has_symbol(*e, *symbol("y" + std::to_string(j)));
+            }
+        }
+    });
+    report("subs", [&]() {
+        for (unsigned i = 0; i < n; i++) {
+            for (const auto &s : x) {
+                auto r = e->subs({{s, integer(i)}});
+                count += r->get_args().size();
+            }
+        }
+    });
+    std::cout << "count: " << count << std::endl;
+    return 0;
+}
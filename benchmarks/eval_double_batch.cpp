@@ -0,0 +1,116 @@
+#include <iostream>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/functions.h>
+#include <symengine/lambda_double.h>
+#include <symengine/bytecode_double.h>
+#ifdef HAVE_SYMENGINE_LLVM
+#include <symengine/llvm_double.h>
+#endif
+
+using SymEngine::Basic;
+using SymEngine::RCP;
+using SymEngine::Symbol;
+using SymEngine::rcp_static_cast;
+using SymEngine::symbol;
+using SymEngine::integer;
+using SymEngine::add;
+using SymEngine::mul;
+using SymEngine::pow;
+using SymEngine::div;
+using SymEngine::sin;
+using SymEngine::cos;
+using SymEngine::vec_basic;
+using SymEngine::LambdaRealDoubleVisitor;
+using SymEngine::BytecodeRealDoubleVisitor;
+
+// Points per second for evaluating the Jacobian of a small model at N points
+// (100000 by default), one point per call and with call_batch().
+void report(const char *name, unsigned n, std::function<void()> f)
+{
+    auto t1 = std::chrono::high_resolution_clock::now();
+    f();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    double t = std::chrono::duration<double>(t2 - t1).count();
+    std::cout << name << ": " << static_cast<long>(n / t) << " points/s"
+              << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+    unsigned n = 100000;
+    if (argc >= 2)
+        n = std::atoi(argv[1]);
+
+    const unsigned m = 4;
+    vec_basic x, f, jac;
+    for (unsigned j = 0; j < m; j++)
+        x.push_back(symbol("x" + std::to_string(j)));
+    for (unsigned k = 0; k < m; k++) {
+        RCP<const Basic> e = integer(0);
+        for (unsigned j = 0; j < m; j++) {
+            e = add(e, mul(sin(mul(x[j], x[k])),
+                           div(pow(x[j], integer(2)),
+                               add(integer(1), pow(x[k], integer(2))))));
+        }
+        f.push_back(add(e, cos(x[k])));
+    }
+    for (auto &e : f) {
+        for (auto &s : x)
+            jac.push_back(e->diff(rcp_static_cast<const Symbol>(s)));
+    }
+
+    std::vector<double> inps(m * n), outs(jac.size() * n), point(m),
+        values(jac.size());
+    for (unsigned i = 0; i < m * n; i++)
+        inps[i] = 0.5 + 1e-6 * i;
+
+    LambdaRealDoubleVisitor l;
+    l.init(x, jac);
+    report("LambdaRealDoubleVisitor::call", n, [&]() {
+        for (unsigned i = 0; i < n; i++) {
+            for (unsigned j = 0; j < m; j++)
+                point[j] = inps[j * n + i];
+            l.call(values.data(), point.data());
+        }
+    });
+    report("LambdaRealDoubleVisitor::call_batch", n,
+           [&]() { l.call_batch(outs.data(), inps.data(), n); });
+
+    BytecodeRealDoubleVisitor b;
+    b.init(x, jac);
+    report("BytecodeRealDoubleVisitor::call", n, [&]() {
+        for (unsigned i = 0; i < n; i++) {
+            for (unsigned j = 0; j < m; j++)
+                point[j] = inps[j * n + i];
+            b.call(values.data(), point.data());
+        }
+    });
+    report("BytecodeRealDoubleVisitor::call_batch", n,
+           [&]() { b.call_batch(outs.data(), inps.data(), n); });
+
+#ifdef HAVE_SYMENGINE_LLVM
+    SymEngine::LLVMDoubleVisitor v;
+    v.init(x, jac);
+    report("LLVMDoubleVisitor::call", n, [&]() {
+        for (unsigned i = 0; i < n; i++) {
+            for (unsigned j = 0; j < m; j++)
+                point[j] = inps[j * n + i];
+            v.call(values.data(), point.data());
+        }
+    });
+    report("LLVMDoubleVisitor::call_batch", n,
+           [&]() { v.call_batch(outs.data(), inps.data(), n); });
+#endif
+
+    return 0;
+}
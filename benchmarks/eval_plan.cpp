@@ -0,0 +1,97 @@
+#include <iostream>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/functions.h>
+#include <symengine/real_double.h>
+#include <symengine/eval_double.h>
+
+using SymEngine::Basic;
+using SymEngine::RCP;
+using SymEngine::symbol;
+using SymEngine::integer;
+using SymEngine::real_double;
+using SymEngine::add;
+using SymEngine::mul;
+using SymEngine::pow;
+using SymEngine::div;
+using SymEngine::sin;
+using SymEngine::cos;
+using SymEngine::vec_basic;
+using SymEngine::map_basic_basic;
+using SymEngine::EvalPlan;
+
+// Evaluations per second of an expression in 10 symbols, N times (10000 by
+// default): with subs() and eval_double(), with the symbol values, and with
+// an EvalPlan when all values change and when only one of them changes.
+void report(const char *name, unsigned n, std::function<void()> f)
+{
+    auto t1 = std::chrono::high_resolution_clock::now();
+    f();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    double t = std::chrono::duration<double>(t2 - t1).count();
+    std::cout << name << ": " << static_cast<long>(n / t) << " evaluations/s"
+              << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+    unsigned n = 10000;
+    if (argc >= 2)
+        n = std::atoi(argv[1]);
+
+    const unsigned m = 10;
+    vec_basic x;
+    for (unsigned j = 0; j < m; j++)
+        x.push_back(symbol("x" + std::to_string(j)));
+    RCP<const Basic> e = integer(0);
+    for (unsigned j = 0; j < m; j++) {
+        for (unsigned k = 0; k < m; k++) {
+            e = add(e, mul(sin(mul(x[j], x[k])),
+                           div(cos(integer(j + k)),
+                               add(integer(1), pow(x[k], integer(2))))));
+        }
+    }
+
+    std::vector<double> values(m, 0.5);
+    double sum = 0;
+    report("subs + eval_double", n, [&]() {
+        for (unsigned i = 0; i < n; i++) {
+            values[0] = 0.001 * i;
+            map_basic_basic d;
+            for (unsigned j = 0; j < m; j++)
+                d[x[j]] = real_double(values[j]);
+            sum += eval_double(*e->subs(d));
+        }
+    });
+    report("eval_double with values", n, [&]() {
+        for (unsigned i = 0; i < n; i++) {
+            values[0] = 0.001 * i;
+            sum += eval_double(*e, x, values);
+        }
+    });
+    EvalPlan plan(*e, x);
+    report("EvalPlan, all values change", n, [&]() {
+        for (unsigned i = 0; i < n; i++) {
+            for (unsigned j = 0; j < m; j++)
+                values[j] = 0.001 * (i + j);
+            sum += plan.call(values);
+        }
+    });
+    report("EvalPlan, one value changes", n, [&]() {
+        for (unsigned i = 0; i < n; i++) {
+            values[0] = 0.001 * i;
+            sum += plan.call(values);
+        }
+    });
+    std::cout << "sum: " << sum << std::endl;
+    return 0;
+}
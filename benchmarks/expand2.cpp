@@ -46,6 +46,7 @@ int main(int argc, char *argv[])
 
     // std::cout << "Expanding: " << *f << std::endl;
 
+    SymEngine::reset_allocation_stats();
     auto t1 = std::chrono::high_resolution_clock::now();
     r = expand(f);
     auto t2 = std::chrono::high_resolution_clock::now();
@@ -55,6 +56,7 @@ int main(int argc, char *argv[])
               << "ms" << std::endl;
     std::cout << "number of terms: "
               << rcp_dynamic_cast<const Add>(r)->dict_.size() << std::endl;
+    SymEngine::print_allocation_stats(std::cout);
 
     return 0;
 }
@@ -0,0 +1,68 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/dict.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+
+using SymEngine::Basic;
+using SymEngine::Add;
+using SymEngine::symbol;
+using SymEngine::integer;
+using SymEngine::RCP;
+using SymEngine::rcp_dynamic_cast;
+
+// Scaling of expand(f, nthreads) for the expand2 problem
+// f = (x + y + z + w)**N * ((x + y + z + w)**N + w) with 1, 2, 4, ... threads
+// up to the number of hardware threads (or the second argument). SymEngine
+// has to be built with WITH_OPENMP for the threads to be used.
+int main(int argc, char *argv[])
+{
+    int N = 15;
+    unsigned max_threads = std::thread::hardware_concurrency();
+    if (argc >= 2)
+        N = std::atoi(argv[1]);
+    if (argc >= 3)
+        max_threads = std::atoi(argv[2]);
+    if (max_threads == 0)
+        max_threads = 1;
+    SymEngine::print_stack_on_segfault();
+
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> w = symbol("w");
+    RCP<const Basic> i = integer(N);
+
+    RCP<const Basic> e, f, r, r1;
+
+    e = pow(add(add(add(x, y), z), w), i);
+    f = mul(e, add(e, w));
+
+    double t_serial = 0;
+    for (unsigned n = 1;; n = std::min(2 * n, max_threads)) {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        r = expand(f, n);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        double t = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        if (n == 1) {
+            t_serial = t;
+            r1 = r;
+        }
+        std::cout << n << " threads: " << static_cast<long>(t) << "ms"
+                  << ", speedup " << t_serial / t << ", number of terms: "
+                  << rcp_dynamic_cast<const Add>(r)->dict_.size();
+        if (not eq(*r, *r1))
+            std::cout << " (differs from the serial result)";
+        std::cout << std::endl;
+        if (n == max_threads)
+            break;
+    }
+
+    return 0;
+}
@@ -41,6 +41,7 @@ int main(int argc, char *argv[])
         f = add(f, s);
     }
     f = neg(f);
+    SymEngine::reset_allocation_stats();
     auto t1 = std::chrono::high_resolution_clock::now();
     e = expand(pow(e, integer(2)));
     e = e->subs({{a0, f}});
@@ -51,6 +52,7 @@ int main(int argc, char *argv[])
                      .count()
               << "ms" << std::endl;
     std::cout << e->__str__() << std::endl;
+    SymEngine::print_allocation_stats(std::cout);
 
     return 0;
 }
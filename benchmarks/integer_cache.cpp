@@ -0,0 +1,109 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/constants.h>
+
+using SymEngine::Basic;
+using SymEngine::RCP;
+using SymEngine::Integer;
+using SymEngine::Number;
+using SymEngine::AllocationStats;
+using SymEngine::symbol;
+using SymEngine::integer;
+using SymEngine::add;
+using SymEngine::mul;
+using SymEngine::pow;
+using SymEngine::sub;
+using SymEngine::expand;
+using SymEngine::one;
+using SymEngine::zero;
+using SymEngine::iaddnum;
+using SymEngine::mulnum;
+using SymEngine::rcp_static_cast;
+
+// Reports the time and the number of Integer and Rational instances that
+// were allocated by the workloads of expand2 and symbench (R2 and R8). Every
+// number in [integer_cache_min, integer_cache_max] as well as small halves
+// and thirds comes from a cache, so comparing the counts with a build
+// without the cache shows the allocations avoided.
+
+void expand2()
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> w = symbol("w");
+    RCP<const Basic> e, f, r;
+
+    e = pow(add(add(add(x, y), z), w), integer(15));
+    f = mul(e, add(e, w));
+    r = expand(f);
+}
+
+RCP<const Basic> hermite(RCP<const Integer> n, RCP<const Basic> y)
+{
+    if (eq(*n, *one))
+        return mul(y, integer(2));
+    if (eq(*n, *zero))
+        return one;
+    return expand(
+        sub(mul(mul(integer(2), y), hermite(n->subint(*one), y)),
+            mul(integer(2),
+                mul(n->subint(*one), hermite(n->subint(*integer(2)), y)))));
+}
+
+void symbench_R2()
+{
+    hermite(integer(15), symbol("y"));
+}
+
+void symbench_R8()
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> f = pow(x, integer(2));
+    RCP<const Number> a = integer(0);
+    RCP<const Number> b = integer(5);
+    int n = 10000;
+    RCP<const Number> Deltax = b->sub(*a)->div(*integer(n));
+    RCP<const Number> c = a;
+    RCP<const Number> est = integer(0);
+    for (int i = 0; i < n; i++) {
+        iaddnum(outArg(c), Deltax);
+        iaddnum(outArg(est), rcp_static_cast<const Number>(f->subs({{x, c}})));
+    }
+    mulnum(est, Deltax);
+}
+
+void run(const char *name, void (*workload)())
+{
+    SymEngine::reset_allocation_stats();
+    auto t1 = std::chrono::high_resolution_clock::now();
+    workload();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::vector<AllocationStats> stats = SymEngine::allocation_stats();
+    std::cout << name << ": "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms, " << stats[SymEngine::INTEGER].allocations
+              << " Integer allocations, "
+              << stats[SymEngine::RATIONAL].allocations
+              << " Rational allocations" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+
+    run("expand2", expand2);
+    run("symbench R2", symbench_R2);
+    run("symbench R8", symbench_R8);
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <chrono>
+#include <functional>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/functions.h>
+#include <symengine/llvm_double.h>
+
+using SymEngine::Basic;
+using SymEngine::RCP;
+using SymEngine::Symbol;
+using SymEngine::rcp_static_cast;
+using SymEngine::symbol;
+using SymEngine::integer;
+using SymEngine::add;
+using SymEngine::mul;
+using SymEngine::pow;
+using SymEngine::div;
+using SymEngine::sin;
+using SymEngine::cos;
+using SymEngine::vec_basic;
+using SymEngine::LLVMDoubleVisitor;
+
+// Time of LLVMDoubleVisitor::init() for the Jacobian of a model with M
+// (10 by default) equations, without the cache, with an empty cache (cold)
+// and once the object code is in the cache (warm).
+void report(const char *name, std::function<void()> f)
+{
+    auto t1 = std::chrono::high_resolution_clock::now();
+    f();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    double t = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    std::cout << name << ": " << t << "ms" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+    unsigned m = 10;
+    if (argc >= 2)
+        m = std::atoi(argv[1]);
+
+    vec_basic x, f, jac;
+    for (unsigned j = 0; j < m; j++)
+        x.push_back(symbol("x" + std::to_string(j)));
+    for (unsigned k = 0; k < m; k++) {
+        RCP<const Basic> e = integer(0);
+        for (unsigned j = 0; j < m; j++) {
+            e = add(e, mul(sin(mul(x[j], x[k])),
+                           div(pow(x[j], integer(2)),
+                               add(integer(1), pow(x[k], integer(2))))));
+        }
+        f.push_back(add(e, cos(x[k])));
+    }
+    for (auto &e : f) {
+        for (auto &s : x)
+            jac.push_back(e->diff(rcp_static_cast<const Symbol>(s)));
+    }
+
+    llvm::SmallString<128> dir;
+    if (llvm::sys::fs::createUniqueDirectory("symengine_llvm_cache", dir)) {
+        std::cerr << "Could not create the cache directory" << std::endl;
+        return 1;
+    }
+
+    report("init without cache", [&]() {
+        LLVMDoubleVisitor v;
+        v.init(x, jac);
+    });
+    report("init, cold cache", [&]() {
+        LLVMDoubleVisitor v;
+        v.set_cache_dir(std::string(dir.str()));
+        v.init(x, jac);
+    });
+    report("init, warm cache", [&]() {
+        LLVMDoubleVisitor v;
+        v.set_cache_dir(std::string(dir.str()));
+        v.init(x, jac);
+    });
+
+    llvm::sys::fs::remove_directories(dir);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <chrono>
+#include <functional>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/functions.h>
+#include <symengine/llvm_double.h>
+
+using SymEngine::Basic;
+using SymEngine::RCP;
+using SymEngine::Symbol;
+using SymEngine::rcp_static_cast;
+using SymEngine::symbol;
+using SymEngine::integer;
+using SymEngine::add;
+using SymEngine::mul;
+using SymEngine::pow;
+using SymEngine::div;
+using SymEngine::sin;
+using SymEngine::cos;
+using SymEngine::vec_basic;
+using SymEngine::LLVMDoubleVisitor;
+using SymEngine::LLVMOptions;
+
+// Compile time of LLVMDoubleVisitor::init() and time per call for the
+// Jacobian of a model with M (10 by default) equations, with different
+// LLVMOptions.
+double seconds(std::function<void()> f)
+{
+    auto t1 = std::chrono::high_resolution_clock::now();
+    f();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(t2 - t1).count();
+}
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+    unsigned m = 10;
+    if (argc >= 2)
+        m = std::atoi(argv[1]);
+    const unsigned n = 10000;
+
+    vec_basic x, f, jac;
+    for (unsigned j = 0; j < m; j++)
+        x.push_back(symbol("x" + std::to_string(j)));
+    for (unsigned k = 0; k < m; k++) {
+        RCP<const Basic> e = integer(0);
+        for (unsigned j = 0; j < m; j++) {
+            e = add(e, mul(sin(mul(x[j], x[k])),
+                           div(pow(x[j], integer(2)),
+                               add(integer(1), pow(x[k], integer(2))))));
+        }
+        f.push_back(add(e, cos(x[k])));
+    }
+    for (auto &e : f) {
+        for (auto &s : x)
+            jac.push_back(e->diff(rcp_static_cast<const Symbol>(s)));
+    }
+    std::vector<double> point(m, 0.5), values(jac.size());
+
+    std::vector<std::pair<std::string, LLVMOptions>> configs;
+    for (unsigned level = 0; level <= 3; level++) {
+        LLVMOptions opts;
+        opts.opt_level = level;
+        configs.push_back({"O" + std::to_string(level), opts});
+    }
+    LLVMOptions opts;
+    opts.fp_contract = true;
+    configs.push_back({"O3, fp-contract", opts});
+    opts.fast_math = true;
+    configs.push_back({"O3, fast-math", opts});
+    opts.intrinsics = false;
+    configs.push_back({"O3, fast-math, libm", opts});
+
+    for (auto &c : configs) {
+        LLVMDoubleVisitor v;
+        v.set_options(c.second);
+        double compile = seconds([&]() { v.init(x, jac); });
+        double call = seconds([&]() {
+            for (unsigned i = 0; i < n; i++) {
+                point[0] = 0.5 + 1e-6 * i;
+                v.call(values.data(), point.data());
+            }
+        });
+        std::cout << c.first << ": compile " << compile * 1e3 << "ms, call "
+                  << call / n * 1e6 << "us" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+#include <symengine/polys/msymenginepoly.h>
+
+using SymEngine::MIntDict;
+using SymEngine::integer_class;
+using SymEngine::vec_uint;
+
+// Multiplication of two sparse polynomials with N terms each (2000 by
+// default) in 5 variables, with 1, 2, 4, ... threads up to the number of
+// hardware threads (or the second argument). Hardly any of the N**2 pairs of
+// terms give the same monomial, so the terms of the product are merged with
+// a heap, which needs memory for the result and one heap entry per term
+// only. SymEngine has to be built with WITH_OPENMP for the threads to be
+// used.
+MIntDict random_poly(unsigned n, uint64_t &seed)
+{
+    MIntDict p(5);
+    while (p.dict_.size() < n) {
+        vec_uint m(5);
+        for (auto &e : m) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            e = (seed >> 33) % 1000;
+        }
+        p.dict_[m] = integer_class(long(seed >> 40) - (1L << 23));
+    }
+    return p;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned N = 2000;
+    unsigned max_threads = std::thread::hardware_concurrency();
+    if (argc >= 2)
+        N = std::atoi(argv[1]);
+    if (argc >= 3)
+        max_threads = std::atoi(argv[2]);
+    if (max_threads == 0)
+        max_threads = 1;
+    SymEngine::print_stack_on_segfault();
+
+    uint64_t seed = 42;
+    MIntDict a = random_poly(N, seed), b = random_poly(N, seed), r1;
+
+    double t_serial = 0;
+    for (unsigned n = 1;; n = std::min(2 * n, max_threads)) {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        MIntDict r = MIntDict::mul(a, b, n);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        double t = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        if (n == 1) {
+            t_serial = t;
+            r1 = r;
+        }
+        std::cout << n << " threads: " << static_cast<long>(t) << "ms"
+                  << ", speedup " << t_serial / t
+                  << ", number of terms: " << r.dict_.size();
+        if (not(r == r1))
+            std::cout << " (differs from the serial result)";
+        std::cout << std::endl;
+        if (n == max_threads)
+            break;
+    }
+
+    return 0;
+}
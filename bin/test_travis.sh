@@ -36,6 +36,12 @@ fi
 if [[ "${WITH_SYMENGINE_THREAD_SAFE}" != "" ]]; then
     cmake_line="$cmake_line -DWITH_SYMENGINE_THREAD_SAFE=${WITH_SYMENGINE_THREAD_SAFE}"
 fi
+if [[ "${WITH_OPENMP}" != "" ]]; then
+    cmake_line="$cmake_line -DWITH_OPENMP=${WITH_OPENMP}"
+fi
+if [[ "${WITH_SYMENGINE_POOL_ALLOCATOR}" != "" ]]; then
+    cmake_line="$cmake_line -DWITH_SYMENGINE_POOL_ALLOCATOR=${WITH_SYMENGINE_POOL_ALLOCATOR}"
+fi
 if [[ "${WITH_ECM}" != "" ]]; then
     cmake_line="$cmake_line -DWITH_ECM=${WITH_ECM}"
 fi
@@ -78,6 +84,9 @@ fi
 if [[ "${WITH_COVERAGE}" != "" ]]; then
     cmake_line="$cmake_line -DWITH_COVERAGE=${WITH_COVERAGE}"
 fi
+if [[ "${WITH_CCODE_DOUBLE}" != "" ]]; then
+    cmake_line="$cmake_line -DWITH_CCODE_DOUBLE=${WITH_CCODE_DOUBLE}"
+fi
 if [[ "${WITH_LLVM}" != "" ]]; then
     cmake_line="$cmake_line -DWITH_LLVM=${WITH_LLVM} -DLLVM_DIR=${LLVM_DIR}"
 fi
@@ -63,6 +63,9 @@ hash_t Add::__hash__() const
 
 bool Add::__eq__(const Basic &o) const
 {
+    // Interned instances are compared by identity first
+    if (this == &o)
+        return true;
     if (is_a<Add>(o) and eq(*coef_, *(static_cast<const Add &>(o).coef_))
         and unified_eq(dict_, static_cast<const Add &>(o).dict_))
         return true;
@@ -112,7 +115,8 @@ RCP<const Basic> Add::from_dict(const RCP<const Number> &coef,
             }
             if (is_a<Mul>(*(p->first))) {
 #if !defined(WITH_SYMENGINE_THREAD_SAFE) and defined(WITH_SYMENGINE_RCP)
-                if (rcp_static_cast<const Mul>(p->first)->use_count() == 1) {
+                if (rcp_static_cast<const Mul>(p->first)->use_count() == 1
+                    and not p->first->is_interned()) {
                     // We can steal the dictionary:
                     // Cast away const'ness, so that we can move 'dict_', since
                     // 'p->first' will be destroyed when 'd' is at the end of
@@ -140,13 +144,14 @@ RCP<const Basic> Add::from_dict(const RCP<const Number> &coef,
             } else {
                 insert(m, p->first, one);
             }
-            return make_rcp<const Mul>(p->second, std::move(m));
+            return intern(make_rcp<const Mul>(p->second, std::move(m)));
         }
         map_basic_basic m;
         if (is_a_Number(*p->second)) {
             if (is_a<Mul>(*(p->first))) {
 #if !defined(WITH_SYMENGINE_THREAD_SAFE) and defined(WITH_SYMENGINE_RCP)
-                if (rcp_static_cast<const Mul>(p->first)->use_count() == 1) {
+                if (rcp_static_cast<const Mul>(p->first)->use_count() == 1
+                    and not p->first->is_interned()) {
                     // We can steal the dictionary:
                     // Cast away const'ness, so that we can move 'dict_', since
                     // 'p->first' will be destroyed when 'd' is at the end of
@@ -173,14 +178,14 @@ RCP<const Basic> Add::from_dict(const RCP<const Number> &coef,
             } else {
                 insert(m, p->first, one);
             }
-            return make_rcp<const Mul>(p->second, std::move(m));
+            return intern(make_rcp<const Mul>(p->second, std::move(m)));
         } else {
             insert(m, p->first, one);
             insert(m, p->second, one);
-            return make_rcp<const Mul>(one, std::move(m));
+            return intern(make_rcp<const Mul>(one, std::move(m)));
         }
     } else {
-        return make_rcp<const Add>(coef, std::move(d));
+        return intern(make_rcp<const Add>(coef, std::move(d)));
     }
 }
 
@@ -0,0 +1,378 @@
+#include <symengine/basic.h>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+#include <mutex>
+#endif
+
+namespace SymEngine
+{
+
+namespace
+{
+
+// Chunks are aligned to their size, so that the header of the chunk a block
+// belongs to is found by masking the address of the block.
+const std::size_t chunk_size = 65536;
+const std::size_t granularity = 16;
+const std::size_t max_block_size = 256;
+const std::size_t n_size_classes = max_block_size / granularity;
+
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+typedef std::atomic<std::size_t> counter_t;
+#else
+typedef std::size_t counter_t;
+#endif
+
+inline void counter_add(counter_t &c, std::size_t n)
+{
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    c.fetch_add(n, std::memory_order_relaxed);
+#else
+    c += n;
+#endif
+}
+
+// The statistics are counted per thread, in its Pool. Only the thread
+// writes its counters, so they are updated without atomic read-modify-write
+// instructions, and `allocation_stats()` sums them up.
+inline void stat_add(counter_t &c, std::size_t n)
+{
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+#else
+    c += n;
+#endif
+}
+
+struct Counters {
+    counter_t allocations;
+    counter_t deallocations;
+    counter_t bytes;
+};
+
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+struct ChunkHeader {
+    // Owning arena, or nullptr for chunks of the pool
+    BasicArena::State *arena;
+    // Next chunk of the same arena
+    ChunkHeader *next;
+};
+
+const std::size_t header_size
+    = (sizeof(ChunkHeader) + granularity - 1) / granularity * granularity;
+
+inline std::size_t size_class(std::size_t size)
+{
+    return (size + granularity - 1) / granularity - 1;
+}
+
+inline ChunkHeader *chunk_of(void *p)
+{
+    return reinterpret_cast<ChunkHeader *>(reinterpret_cast<std::uintptr_t>(p)
+                                           & ~(chunk_size - 1));
+}
+
+ChunkHeader *allocate_chunk(BasicArena::State *arena)
+{
+    void *p;
+#if defined(_WIN32)
+    p = _aligned_malloc(chunk_size, chunk_size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+#else
+    if (posix_memalign(&p, chunk_size, chunk_size) != 0)
+        throw std::bad_alloc();
+#endif
+    ChunkHeader *h = static_cast<ChunkHeader *>(p);
+    h->arena = arena;
+    h->next = nullptr;
+    return h;
+}
+
+void free_chunk(ChunkHeader *h)
+{
+#if defined(_WIN32)
+    _aligned_free(h);
+#else
+    std::free(h);
+#endif
+}
+
+// Bump allocation from the current chunk
+struct BumpRegion {
+    char *ptr = nullptr;
+    char *end = nullptr;
+
+    void *take(std::size_t n, BasicArena::State *arena,
+               ChunkHeader **chunks = nullptr)
+    {
+        if (static_cast<std::size_t>(end - ptr) < n) {
+            // The rest of the current chunk (less than `n` bytes) is wasted
+            ChunkHeader *h = allocate_chunk(arena);
+            if (chunks != nullptr) {
+                h->next = *chunks;
+                *chunks = h;
+            }
+            ptr = reinterpret_cast<char *>(h) + header_size;
+            end = reinterpret_cast<char *>(h) + chunk_size;
+        }
+        void *r = ptr;
+        ptr += n;
+        return r;
+    }
+};
+
+// Value initialized by `new Pool()`, which zeroes the counters
+struct Pool {
+    FreeBlock *free_lists[n_size_classes] = {};
+    BumpRegion region;
+    // The innermost BasicArena of this thread
+    BasicArena::State *arena = nullptr;
+    Counters counters[TypeID_Count];
+};
+
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+// Free blocks of threads that exited. Allocated on the first use and never
+// freed, like the pools themselves.
+// The depot also lists all pools, for `allocation_stats()`.
+struct Depot {
+    FreeBlock *free_lists[n_size_classes] = {};
+    std::vector<Pool *> pools;
+    std::mutex mutex;
+};
+
+Depot &depot()
+{
+    static Depot *d = new Depot();
+    return *d;
+}
+
+// Moves all free blocks of `pool` to the depot
+void retire(Pool &pool)
+{
+    Depot &d = depot();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    for (std::size_t c = 0; c < n_size_classes; c++) {
+        FreeBlock *b = pool.free_lists[c];
+        while (b != nullptr) {
+            FreeBlock *next = b->next;
+            b->next = d.free_lists[c];
+            d.free_lists[c] = b;
+            b = next;
+        }
+        pool.free_lists[c] = nullptr;
+    }
+}
+
+// Takes all free blocks of size class `c` from the depot
+FreeBlock *take_from_depot(std::size_t c)
+{
+    Depot &d = depot();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    FreeBlock *b = d.free_lists[c];
+    d.free_lists[c] = nullptr;
+    return b;
+}
+
+// `thread_pool` is trivially destructible, so it stays usable for instances
+// that are freed after `retirer` was destroyed at thread exit.
+thread_local Pool *thread_pool = nullptr;
+
+struct PoolRetirer {
+    ~PoolRetirer()
+    {
+        if (thread_pool != nullptr)
+            retire(*thread_pool);
+    }
+};
+
+thread_local PoolRetirer retirer;
+
+Pool &local_pool()
+{
+    if (thread_pool == nullptr) {
+        thread_pool = new Pool();
+        Depot &d = depot();
+        std::lock_guard<std::mutex> lock(d.mutex);
+        d.pools.push_back(thread_pool);
+        // Make sure the free blocks are handed over when the thread exits
+        (void)&retirer;
+    }
+    return *thread_pool;
+}
+
+// Calls `f` on the pools of all threads, including the ones that exited
+template <typename F>
+void for_each_pool(F f)
+{
+    Depot &d = depot();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    for (Pool *pool : d.pools)
+        f(*pool);
+}
+#else
+Pool &local_pool()
+{
+    static Pool *pool = new Pool();
+    return *pool;
+}
+
+template <typename F>
+void for_each_pool(F f)
+{
+    f(local_pool());
+}
+#endif
+
+} // anonymous namespace
+
+struct BasicArena::State {
+    BumpRegion region;
+    ChunkHeader *chunks = nullptr;
+    // Number of live instances plus one for the BasicArena itself
+    counter_t refs;
+    State *prev;
+};
+
+namespace
+{
+
+void arena_release(BasicArena::State *s)
+{
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    if (s->refs.fetch_sub(1) != 1)
+        return;
+#else
+    if (--(s->refs) != 0)
+        return;
+#endif
+    ChunkHeader *h = s->chunks;
+    while (h != nullptr) {
+        ChunkHeader *next = h->next;
+        free_chunk(h);
+        h = next;
+    }
+    delete s;
+}
+
+} // anonymous namespace
+
+void *basic_allocate(std::size_t size, unsigned type_code)
+{
+    Pool &pool = local_pool();
+    stat_add(pool.counters[type_code].allocations, 1);
+    stat_add(pool.counters[type_code].bytes, size);
+    if (size > max_block_size)
+        return ::operator new(size);
+    std::size_t c = size_class(size);
+    if (pool.arena != nullptr) {
+        counter_add(pool.arena->refs, 1);
+        return pool.arena->region.take((c + 1) * granularity, pool.arena,
+                                       &pool.arena->chunks);
+    }
+    FreeBlock *b = pool.free_lists[c];
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    if (b == nullptr)
+        b = take_from_depot(c);
+#endif
+    if (b != nullptr) {
+        pool.free_lists[c] = b->next;
+        return b;
+    }
+    return pool.region.take((c + 1) * granularity, nullptr);
+}
+
+void basic_deallocate(void *p, std::size_t size, unsigned type_code)
+{
+    Pool &pool = local_pool();
+    stat_add(pool.counters[type_code].deallocations, 1);
+    if (size > max_block_size) {
+        ::operator delete(p);
+        return;
+    }
+    ChunkHeader *h = chunk_of(p);
+    if (h->arena != nullptr) {
+        arena_release(h->arena);
+        return;
+    }
+    std::size_t c = size_class(size);
+    FreeBlock *b = static_cast<FreeBlock *>(p);
+    b->next = pool.free_lists[c];
+    pool.free_lists[c] = b;
+}
+
+BasicArena::BasicArena()
+{
+    Pool &pool = local_pool();
+    state_ = new State();
+    state_->refs = 1;
+    state_->prev = pool.arena;
+    pool.arena = state_;
+}
+
+BasicArena::~BasicArena()
+{
+    Pool &pool = local_pool();
+    SYMENGINE_ASSERT(pool.arena == state_)
+    pool.arena = state_->prev;
+    arena_release(state_);
+}
+
+std::vector<AllocationStats> allocation_stats()
+{
+    std::vector<AllocationStats> v(TypeID_Count, AllocationStats());
+    for_each_pool([&](const Pool &pool) {
+        for (unsigned i = 0; i < TypeID_Count; i++) {
+            v[i].allocations += pool.counters[i].allocations;
+            v[i].deallocations += pool.counters[i].deallocations;
+            v[i].bytes += pool.counters[i].bytes;
+        }
+    });
+    return v;
+}
+
+void reset_allocation_stats()
+{
+    for_each_pool([](Pool &pool) {
+        for (unsigned i = 0; i < TypeID_Count; i++) {
+            pool.counters[i].allocations = 0;
+            pool.counters[i].deallocations = 0;
+            pool.counters[i].bytes = 0;
+        }
+    });
+}
+
+void print_allocation_stats(std::ostream &out)
+{
+    static const char *names[] = {
+#define SYMENGINE_INCLUDE_ALL
+#define SYMENGINE_ENUM(type, Class) #Class,
+#include "symengine/type_codes.inc"
+#undef SYMENGINE_ENUM
+#undef SYMENGINE_INCLUDE_ALL
+    };
+    std::vector<AllocationStats> v = allocation_stats();
+    std::size_t allocations = 0, bytes = 0;
+    for (unsigned i = 0; i < TypeID_Count; i++) {
+        if (v[i].allocations == 0 and v[i].deallocations == 0)
+            continue;
+        out << names[i] << ": " << v[i].allocations << " allocations, "
+            << v[i].deallocations << " deallocations, " << v[i].bytes
+            << " bytes" << std::endl;
+        allocations += v[i].allocations;
+        bytes += v[i].bytes;
+    }
+    out << "Total: " << allocations << " allocations, " << bytes << " bytes"
+        << std::endl;
+}
+
+} // SymEngine
@@ -0,0 +1,104 @@
+/**
+ *  \file allocator.h
+ *  Pool allocator used for all Basic subclasses
+ *
+ **/
+#ifndef SYMENGINE_ALLOCATOR_H
+#define SYMENGINE_ALLOCATOR_H
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include <symengine/symengine_config.h>
+
+namespace SymEngine
+{
+
+/*! Memory for the instances of all Basic subclasses is requested through
+    `basic_allocate()` and released through `basic_deallocate()` from the
+    class specific `operator new` and `operator delete` that IMPLEMENT_TYPEID
+    defines (if SymEngine is built with WITH_SYMENGINE_POOL_ALLOCATOR). So
+    `make_rcp` and `RCP::~RCP` use them without any change.
+
+    Small instances are carved out of 64KiB chunks and recycled through free
+    lists of fixed size classes. The free lists are thread local with
+    WITH_SYMENGINE_THREAD_SAFE. Larger instances use the global `operator new`.
+    Pool memory is reused, but never returned to the operating system.
+
+    `type_code` is the TypeID of the class and is only used for statistics.
+*/
+void *basic_allocate(std::size_t size, unsigned type_code);
+void basic_deallocate(void *p, std::size_t size, unsigned type_code);
+
+//! Allocation statistics of one type (see `allocation_stats()`)
+struct AllocationStats {
+    //! Number of instances allocated
+    std::size_t allocations;
+    //! Number of instances deallocated
+    std::size_t deallocations;
+    //! Total number of bytes allocated
+    std::size_t bytes;
+};
+
+/*! \return the statistics of all types, indexed by TypeID. They are counted
+    per thread and summed up here, so they are exact once the other threads
+    stopped allocating. */
+std::vector<AllocationStats> allocation_stats();
+//! Sets all the counters returned by `allocation_stats()` to zero
+void reset_allocation_stats();
+//! Prints the non-zero statistics, one type per line
+void print_allocation_stats(std::ostream &out);
+
+/*! Scoped arena for temporaries.
+
+    While a BasicArena is alive, all Basic instances allocated by the current
+    thread are bump allocated from the arena instead of the pool. Destructors
+    still run as usual when the last reference goes away, but the memory is
+    not recycled; it is released wholesale once the arena went out of scope
+    and all its instances were destroyed. Keeping an instance alive after the
+    scope ends is allowed, it just keeps the whole arena allocated.
+
+    Example:
+
+        double r;
+        {
+            BasicArena arena;
+            // All temporaries created here come from the arena
+            r = eval_double(*expand(e)->subs(d));
+        }
+
+    Arenas can be nested, the innermost one is used.
+*/
+class BasicArena
+{
+public:
+    BasicArena();
+    ~BasicArena();
+
+    BasicArena(const BasicArena &) = delete;
+    BasicArena &operator=(const BasicArena &) = delete;
+
+    struct State;
+
+private:
+    State *state_;
+};
+
+} // SymEngine
+
+#if defined(WITH_SYMENGINE_POOL_ALLOCATOR)
+#define SYMENGINE_POOL_ALLOCATOR_METHODS(ID)                                   \
+    static void *operator new(std::size_t n)                                   \
+    {                                                                          \
+        return basic_allocate(n, ID);                                          \
+    }                                                                          \
+    static void operator delete(void *p, std::size_t n)                        \
+    {                                                                          \
+        basic_deallocate(p, n, ID);                                            \
+    }
+#else
+#define SYMENGINE_POOL_ALLOCATOR_METHODS(ID)
+#endif
+
+#endif
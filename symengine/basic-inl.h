@@ -11,6 +11,30 @@ inline hash_t Basic::hash() const
     return hash_;
 }
 
+#ifdef WITH_SYMENGINE_SYMBOL_SIGNATURE
+inline hash_t Basic::symbol_signature() const
+{
+    const hash_t computed = hash_t(1) << 63;
+    if (signature_ == 0)
+        signature_ = compute_symbol_signature(*this) | computed;
+    return signature_ & ~computed;
+}
+#endif
+
+inline hash_t symbol_signature(const Basic &b)
+{
+#ifdef WITH_SYMENGINE_SYMBOL_SIGNATURE
+    return b.symbol_signature();
+#else
+    return ~hash_t(0) >> 1;
+#endif
+}
+
+inline bool may_have_symbol(const Basic &b, const Basic &x)
+{
+    return (symbol_signature(b) & symbol_signature(x)) != 0;
+}
+
 //! \return true if not equal
 inline bool Basic::__neq__(const Basic &o) const
 {
@@ -46,6 +70,14 @@ inline bool is_same_type(const Basic &a, const Basic &b)
     return a.get_type_code() == b.get_type_code();
 }
 
+template <class T>
+inline RCP<const T> intern(const RCP<const T> &b)
+{
+    if (not interning_enabled())
+        return b;
+    return rcp_static_cast<const T>(intern_basic(b));
+}
+
 //! `<<` Operator
 inline std::ostream &operator<<(std::ostream &out, const SymEngine::Basic &p)
 {
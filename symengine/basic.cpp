@@ -1,6 +1,10 @@
 #include <symengine/printer.h>
 #include <symengine/subs.h>
 
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+#include <mutex>
+#endif
+
 namespace SymEngine
 {
 
@@ -35,4 +39,100 @@ RCP<const Basic> Basic::diff(const RCP<const Symbol> &x) const
     return Derivative::create(rcp_from_this(), {x});
 }
 
+namespace
+{
+// The interning table maps hashes to weak pointers of the canonical
+// instances. It is allocated on the first use and never freed, so that
+// instances destroyed during static destruction can still unregister
+// themselves.
+struct InternTable {
+    std::unordered_multimap<hash_t, const Basic *> map;
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    std::mutex mutex;
+#endif
+};
+
+InternTable &intern_table()
+{
+    static InternTable *table = new InternTable();
+    return *table;
+}
+
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+std::atomic<bool> interning_enabled_(false);
+#else
+bool interning_enabled_ = false;
+#endif
+} // anonymous namespace
+
+void set_interning(bool enabled)
+{
+#if defined(WITH_SYMENGINE_RCP)
+    interning_enabled_ = enabled;
+#endif
+}
+
+bool interning_enabled()
+{
+    return interning_enabled_;
+}
+
+size_t interned_count()
+{
+    InternTable &t = intern_table();
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    std::lock_guard<std::mutex> lock(t.mutex);
+#endif
+    return t.map.size();
+}
+
+RCP<const Basic> intern_basic(const RCP<const Basic> &b)
+{
+#if defined(WITH_SYMENGINE_RCP)
+    if (b->interned_)
+        return b;
+    hash_t h = b->hash();
+    // Candidates are kept alive by `refs` while they are compared. `refs` is
+    // declared before the lock, so that any instance whose last reference is
+    // released here is deleted (and unregisters itself) after the lock is
+    // released.
+    vec_basic refs;
+    InternTable &t = intern_table();
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    std::lock_guard<std::mutex> lock(t.mutex);
+#endif
+    auto range = t.map.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Basic *p = it->second;
+        // Skip instances which are being deleted in another thread
+        if (not p->_try_incref())
+            continue;
+        refs.push_back(rcp(p));
+        p->_decref();
+        if (is_same_type(*p, *b) and p->__eq__(*b))
+            return refs.back();
+    }
+    b->interned_ = true;
+    t.map.insert(std::make_pair(h, b.get()));
+#endif
+    return b;
+}
+
+void unintern(const Basic &b)
+{
+    InternTable &t = intern_table();
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    std::lock_guard<std::mutex> lock(t.mutex);
+#endif
+    // The virtual hash() can't be used from a destructor, but the hash was
+    // cached when `b` was interned:
+    auto range = t.map.equal_range(b.hash_);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == &b) {
+            t.map.erase(it);
+            return;
+        }
+    }
+}
+
 } // SymEngine
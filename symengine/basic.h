@@ -30,12 +30,17 @@
 #endif
 
 #include <symengine/dict.h>
+#include <symengine/allocator.h>
 
 namespace SymEngine
 {
 
 class Visitor;
 class Symbol;
+class Basic;
+
+//! Removes `b` from the interning table, called from `Basic::~Basic()`
+void unintern(const Basic &b);
 
 /*!
     Any Basic class can be used in a "dictionary", due to the methods:
@@ -87,6 +92,11 @@ class Basic : public EnableRCPFromThis<Basic>
 {
 private:
 //! Private variables
+// The interned_ flag is true if `this` is the canonical instance registered
+// in the interning table (see intern_basic()). It is declared before hash_,
+// so that it fits into the padding after the reference counter and does not
+// increase the size of Basic.
+    mutable bool interned_;
 // The hash_ is defined as mutable, because its value is initialized to 0
 // in the constructor and then it can be changed in Basic::hash() to the
 // current hash (which is always the same for the given instance). The
@@ -96,16 +106,34 @@ private:
 #else
     mutable hash_t hash_; // This holds the hash value
 #endif // WITH_SYMENGINE_THREAD_SAFE
+#ifdef WITH_SYMENGINE_SYMBOL_SIGNATURE
+// The signature_ is cached like hash_, with the highest bit set once it is
+// computed, since 0 is the signature of an expression without symbols.
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    mutable std::atomic<hash_t> signature_{0};
+#else
+    mutable hash_t signature_ = 0;
+#endif // WITH_SYMENGINE_THREAD_SAFE
+#endif // WITH_SYMENGINE_SYMBOL_SIGNATURE
+
+    friend RCP<const Basic> intern_basic(const RCP<const Basic> &b);
+    friend void unintern(const Basic &b);
+#ifdef WITH_SYMENGINE_SYMBOL_SIGNATURE
+    friend hash_t compute_symbol_signature(const Basic &b);
+#endif
+
 public:
     virtual TypeID get_type_code() const = 0;
     //! Constructor
-    Basic() : hash_{0}
+    Basic() : interned_{false}, hash_{0}
     {
     }
     //! Destructor must be explicitly defined as virtual here to avoid problems
     //! with undefined behavior while deallocating derived classes.
     virtual ~Basic()
     {
+        if (interned_)
+            unintern(*this);
     }
 
     //! Delete the copy constructor and assignment
@@ -129,6 +157,17 @@ public:
     //! This caches the hash:
     hash_t hash() const;
 
+#ifdef WITH_SYMENGINE_SYMBOL_SIGNATURE
+    //! This caches the signature of the symbols, see `symbol_signature()`
+    hash_t symbol_signature() const;
+#endif
+
+    //! true if `this` is the canonical instance in the interning table
+    inline bool is_interned() const
+    {
+        return interned_;
+    }
+
     //! true if `this` is equal to `o`.
     virtual bool __eq__(const Basic &o) const = 0;
 
@@ -179,7 +218,7 @@ struct RCPBasicKeyEq {
     //! Comparison Operator `==`
     bool operator()(const RCP<const Basic> &x, const RCP<const Basic> &y) const
     {
-        return x->__eq__(*y);
+        return x.get() == y.get() or x->__eq__(*y);
     }
 };
 
@@ -222,12 +261,67 @@ bool is_a_sub(const Basic &b);
 //! Returns true if `a` and `b` are exactly the same type `T`.
 bool is_same_type(const Basic &a, const Basic &b);
 
+/*! Hash-consing of Basic instances.
+
+    When interning is enabled, `Add::from_dict()`, `Mul::from_dict()`, `pow()`
+    and `symbol()` return the canonical instance of a structurally equal
+    expression that is still alive, so that shared subexpressions are stored
+    only once and `eq()` returns early on identical pointers. The table only
+    keeps weak pointers: an instance is removed from it once its last RCP goes
+    away. Interning is off by default and is only available with
+    WITH_SYMENGINE_RCP (it is a no-op with Teuchos::RCP).
+*/
+void set_interning(bool enabled);
+//! \return `true` if interning is enabled
+bool interning_enabled();
+//! \return the number of instances currently in the interning table
+size_t interned_count();
+//! \return the canonical instance equal to `b`, registering `b` if needed
+RCP<const Basic> intern_basic(const RCP<const Basic> &b);
+//! Typed version of `intern_basic()`, see above
+template <class T>
+RCP<const T> intern(const RCP<const T> &b);
+
+/*! A Bloom filter of the symbols in `b`: every symbol sets one of 63 bits,
+    picked by its hash, and an expression has the bits of the symbols in its
+    arguments. Classes of unknown structure have all bits set. If the
+    signatures of `b` and `x` have no common bits, `x` is not in `b`.
+
+    The signature is cached in `b` if SymEngine was built with
+    WITH_SYMENGINE_SYMBOL_SIGNATURE, otherwise all bits are always set.
+*/
+hash_t symbol_signature(const Basic &b);
+//! The uncached signature of `b`, from the cached ones of its arguments,
+//! which are computed first if necessary
+hash_t compute_symbol_signature(const Basic &b);
+//! \return false if the symbol `x` is not in `b`, true if it might be
+bool may_have_symbol(const Basic &b, const Basic &x);
+
 //! Expands `self`
 RCP<const Basic> expand(const RCP<const Basic> &self);
+/*! Expands `self` using up to `nthreads` threads. Products of large sums and
+    multinomial expansions are split across the threads, each of which
+    collects its terms in its own dictionary; the dictionaries are merged at
+    the end. The result is the same as the one of `expand(self)`.
+
+    The work is only distributed if SymEngine was built with WITH_OPENMP,
+    otherwise this is the same as `expand(self)`.
+*/
+RCP<const Basic> expand(const RCP<const Basic> &self, unsigned nthreads);
 void as_numer_denom(const RCP<const Basic> &x,
                     const Ptr<RCP<const Basic>> &numer,
                     const Ptr<RCP<const Basic>> &denom);
 
+/*! Common subexpression elimination. Every subexpression that occurs more
+    than once in `exprs` is replaced by a new symbol. The pairs of symbols and
+    the subexpressions they stand for are appended to `replacements`, in an
+    order in which each subexpression only depends on the symbols before it.
+    The expressions with all replacements made are appended to
+    `reduced_exprs`.
+*/
+void cse(vec_pair &replacements, vec_basic &reduced_exprs,
+         const vec_basic &exprs);
+
 /*! This `<<` overloaded function simply calls `p.__str__`, so it allows any
    Basic
     type to be printed.
@@ -275,6 +369,7 @@ struct hash<SymEngine::Basic>;
     {                                                                          \
         return type_code_id;                                                   \
     };                                                                         \
+    SYMENGINE_POOL_ALLOCATOR_METHODS(ID)                                       \
     SYMENGINE_INCLUDE_METHODS(;)
 
 #endif
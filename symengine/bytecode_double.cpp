@@ -0,0 +1,758 @@
+#include <symengine/bytecode_double.h>
+#include <symengine/symengine_exception.h>
+
+#include <cstring>
+
+namespace SymEngine
+{
+
+namespace
+{
+
+typedef BytecodeRealDoubleVisitor::Instruction Instruction;
+
+unsigned Instruction::*const operands[]
+    = {&Instruction::a, &Instruction::b, &Instruction::c};
+
+unsigned arity(BytecodeRealDoubleVisitor::Opcode op)
+{
+    switch (op) {
+        case BytecodeRealDoubleVisitor::MULADD:
+            return 3;
+        case BytecodeRealDoubleVisitor::ADD:
+        case BytecodeRealDoubleVisitor::SUB:
+        case BytecodeRealDoubleVisitor::MUL:
+        case BytecodeRealDoubleVisitor::DIV:
+        case BytecodeRealDoubleVisitor::POW:
+        case BytecodeRealDoubleVisitor::MAX:
+        case BytecodeRealDoubleVisitor::MIN:
+        case BytecodeRealDoubleVisitor::ATAN2:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+//! Computes `x**n` by repeated squaring
+inline double powi(double x, long n)
+{
+    unsigned long m = n < 0 ? -static_cast<unsigned long>(n) : n;
+    double r = 1;
+    while (m != 0) {
+        if (m & 1)
+            r *= x;
+        x *= x;
+        m >>= 1;
+    }
+    return n < 0 ? 1 / r : r;
+}
+
+// Executes the instructions in [i, end) on the register file `r`
+inline void run(const Instruction *i, const Instruction *end, double *r)
+{
+    for (; i != end; ++i) {
+        switch (i->op) {
+            case BytecodeRealDoubleVisitor::ADD:
+                r[i->dst] = r[i->a] + r[i->b];
+                break;
+            case BytecodeRealDoubleVisitor::SUB:
+                r[i->dst] = r[i->a] - r[i->b];
+                break;
+            case BytecodeRealDoubleVisitor::MUL:
+                r[i->dst] = r[i->a] * r[i->b];
+                break;
+            case BytecodeRealDoubleVisitor::DIV:
+                r[i->dst] = r[i->a] / r[i->b];
+                break;
+            case BytecodeRealDoubleVisitor::MULADD:
+                r[i->dst] = r[i->a] * r[i->b] + r[i->c];
+                break;
+            case BytecodeRealDoubleVisitor::NEG:
+                r[i->dst] = -r[i->a];
+                break;
+            case BytecodeRealDoubleVisitor::POW:
+                r[i->dst] = std::pow(r[i->a], r[i->b]);
+                break;
+            case BytecodeRealDoubleVisitor::POWI:
+                r[i->dst] = powi(r[i->a], i->n);
+                break;
+            case BytecodeRealDoubleVisitor::SQRT:
+                r[i->dst] = std::sqrt(r[i->a]);
+                break;
+            case BytecodeRealDoubleVisitor::EXP:
+                r[i->dst] = std::exp(r[i->a]);
+                break;
+            case BytecodeRealDoubleVisitor::LOG:
+                r[i->dst] = std::log(r[i->a]);
+                break;
+            case BytecodeRealDoubleVisitor::SIN:
+                r[i->dst] = std::sin(r[i->a]);
+                break;
+            case BytecodeRealDoubleVisitor::COS:
+                r[i->dst] = std::cos(r[i->a]);
+                break;
+            case BytecodeRealDoubleVisitor::TAN:
+                r[i->dst] = std::tan(r[i->a]);
+                break;
+            case BytecodeRealDoubleVisitor::ABS:
+                r[i->dst] = std::abs(r[i->a]);
+                break;
+            case BytecodeRealDoubleVisitor::MAX:
+                r[i->dst] = std::max(r[i->a], r[i->b]);
+                break;
+            case BytecodeRealDoubleVisitor::MIN:
+                r[i->dst] = std::min(r[i->a], r[i->b]);
+                break;
+            case BytecodeRealDoubleVisitor::ATAN2:
+                r[i->dst] = std::atan2(r[i->a], r[i->b]);
+                break;
+            case BytecodeRealDoubleVisitor::CALL:
+                r[i->dst] = i->f(r[i->a]);
+                break;
+        }
+    }
+}
+
+// Number of points `call_batch()` evaluates at once
+const std::size_t batch_block = 64;
+
+#define SYMENGINE_BATCH_LOOP(expr)                                             \
+    for (std::size_t l = 0; l < len; l++)                                      \
+        d[l] = expr;                                                           \
+    break;
+
+// Like run(), but for `len` points. The value of register `k` at the l-th
+// point is `r[k * batch_block + l]`.
+inline void run_batch(const Instruction *i, const Instruction *end, double *r,
+                      std::size_t len)
+{
+    for (; i != end; ++i) {
+        double *d = r + i->dst * batch_block;
+        const double *a = r + i->a * batch_block, *b = r + i->b * batch_block,
+                     *c = r + i->c * batch_block;
+        switch (i->op) {
+            case BytecodeRealDoubleVisitor::ADD:
+                SYMENGINE_BATCH_LOOP(a[l] + b[l])
+            case BytecodeRealDoubleVisitor::SUB:
+                SYMENGINE_BATCH_LOOP(a[l] - b[l])
+            case BytecodeRealDoubleVisitor::MUL:
+                SYMENGINE_BATCH_LOOP(a[l] * b[l])
+            case BytecodeRealDoubleVisitor::DIV:
+                SYMENGINE_BATCH_LOOP(a[l] / b[l])
+            case BytecodeRealDoubleVisitor::MULADD:
+                SYMENGINE_BATCH_LOOP(a[l] * b[l] + c[l])
+            case BytecodeRealDoubleVisitor::NEG:
+                SYMENGINE_BATCH_LOOP(-a[l])
+            case BytecodeRealDoubleVisitor::POW:
+                SYMENGINE_BATCH_LOOP(std::pow(a[l], b[l]))
+            case BytecodeRealDoubleVisitor::POWI:
+                SYMENGINE_BATCH_LOOP(powi(a[l], i->n))
+            case BytecodeRealDoubleVisitor::SQRT:
+                SYMENGINE_BATCH_LOOP(std::sqrt(a[l]))
+            case BytecodeRealDoubleVisitor::EXP:
+                SYMENGINE_BATCH_LOOP(std::exp(a[l]))
+            case BytecodeRealDoubleVisitor::LOG:
+                SYMENGINE_BATCH_LOOP(std::log(a[l]))
+            case BytecodeRealDoubleVisitor::SIN:
+                SYMENGINE_BATCH_LOOP(std::sin(a[l]))
+            case BytecodeRealDoubleVisitor::COS:
+                SYMENGINE_BATCH_LOOP(std::cos(a[l]))
+            case BytecodeRealDoubleVisitor::TAN:
+                SYMENGINE_BATCH_LOOP(std::tan(a[l]))
+            case BytecodeRealDoubleVisitor::ABS:
+                SYMENGINE_BATCH_LOOP(std::abs(a[l]))
+            case BytecodeRealDoubleVisitor::MAX:
+                SYMENGINE_BATCH_LOOP(std::max(a[l], b[l]))
+            case BytecodeRealDoubleVisitor::MIN:
+                SYMENGINE_BATCH_LOOP(std::min(a[l], b[l]))
+            case BytecodeRealDoubleVisitor::ATAN2:
+                SYMENGINE_BATCH_LOOP(std::atan2(a[l], b[l]))
+            case BytecodeRealDoubleVisitor::CALL:
+                SYMENGINE_BATCH_LOOP(i->f(a[l]))
+        }
+    }
+}
+
+#undef SYMENGINE_BATCH_LOOP
+
+double cot(double x)
+{
+    return 1.0 / std::tan(x);
+}
+
+double csc(double x)
+{
+    return 1.0 / std::sin(x);
+}
+
+double sec(double x)
+{
+    return 1.0 / std::cos(x);
+}
+
+double acot(double x)
+{
+    return std::atan(1.0 / x);
+}
+
+double acsc(double x)
+{
+    return std::asin(1.0 / x);
+}
+
+double asec(double x)
+{
+    return std::acos(1.0 / x);
+}
+
+double coth(double x)
+{
+    return 1.0 / std::tanh(x);
+}
+
+double csch(double x)
+{
+    return 1.0 / std::sinh(x);
+}
+
+double sech(double x)
+{
+    return 1.0 / std::cosh(x);
+}
+
+double acoth(double x)
+{
+    return std::atanh(1.0 / x);
+}
+
+double acsch(double x)
+{
+    return std::asinh(1.0 / x);
+}
+
+double asech(double x)
+{
+    return std::acosh(1.0 / x);
+}
+
+// Needed to pick an overload of the standard library functions
+typedef double (*unary_fn)(double);
+
+} // anonymous namespace
+
+const unsigned BytecodeRealDoubleVisitor::no_constant;
+
+void BytecodeRealDoubleVisitor::init(const vec_basic &x, const Basic &b)
+{
+    init(x, {b.rcp_from_this()});
+}
+
+void BytecodeRealDoubleVisitor::init(const vec_basic &inputs,
+                                     const vec_basic &outputs)
+{
+    symbols_ = inputs;
+    code_.clear();
+    outputs_.clear();
+    cache_.clear();
+    constants_.clear();
+    constant_map_.clear();
+    constant_index_.assign(inputs.size(), no_constant);
+    n_virtual_ = inputs.size();
+    // The first of equal symbols is used, like in LambdaRealDoubleVisitor
+    for (unsigned i = 0; i < inputs.size(); i++)
+        cache_.insert({inputs[i], i});
+
+    for (auto &p : outputs)
+        outputs_.push_back(apply(*p));
+    allocate_registers();
+
+    cache_.clear();
+    constants_.clear();
+    constant_map_.clear();
+    constant_index_.clear();
+}
+
+unsigned BytecodeRealDoubleVisitor::apply(const Basic &b)
+{
+    RCP<const Basic> p = b.rcp_from_this();
+    auto it = cache_.find(p);
+    if (it != cache_.end())
+        return it->second;
+    b.accept(*this);
+    cache_.insert({p, result_});
+    return result_;
+}
+
+double BytecodeRealDoubleVisitor::call(const std::vector<double> &vec)
+{
+    double *r = registers_.data();
+    std::copy(vec.begin(), vec.begin() + symbols_.size(), r + n_constants_);
+    run(code_.data(), code_.data() + code_.size(), r);
+    return r[outputs_[0]];
+}
+
+void BytecodeRealDoubleVisitor::call(double *outs, const double *inps)
+{
+    double *r = registers_.data();
+    std::copy(inps, inps + symbols_.size(), r + n_constants_);
+    run(code_.data(), code_.data() + code_.size(), r);
+    for (unsigned i = 0; i < outputs_.size(); i++)
+        outs[i] = r[outputs_[i]];
+}
+
+void BytecodeRealDoubleVisitor::call_batch(double *outs, const double *inps,
+                                           std::size_t n)
+{
+    std::size_t n_inputs = symbols_.size();
+    if (batch_registers_.empty()) {
+        batch_registers_.resize(registers_.size() * batch_block);
+        for (unsigned k = 0; k < n_constants_; k++)
+            std::fill_n(batch_registers_.begin() + k * batch_block,
+                        batch_block, registers_[k]);
+    }
+    double *r = batch_registers_.data();
+    for (std::size_t i = 0; i < n; i += batch_block) {
+        std::size_t len = std::min(batch_block, n - i);
+        for (std::size_t j = 0; j < n_inputs; j++)
+            std::copy(inps + j * n + i, inps + j * n + i + len,
+                      r + (n_constants_ + j) * batch_block);
+        run_batch(code_.data(), code_.data() + code_.size(), r, len);
+        for (std::size_t k = 0; k < outputs_.size(); k++)
+            std::copy(r + outputs_[k] * batch_block,
+                      r + outputs_[k] * batch_block + len, outs + k * n + i);
+    }
+}
+
+unsigned BytecodeRealDoubleVisitor::constant(double d)
+{
+    // Compare the representations, so that 0.0 and -0.0 (as well as NaNs)
+    // are kept apart
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(d));
+    auto it = constant_map_.find(bits);
+    if (it != constant_map_.end())
+        return it->second;
+    constant_map_.insert({bits, n_virtual_});
+    constant_index_.push_back(constants_.size());
+    constants_.push_back(d);
+    return n_virtual_++;
+}
+
+unsigned BytecodeRealDoubleVisitor::push(Instruction i)
+{
+    unsigned n = arity(i.op);
+    bool folds = true;
+    for (unsigned k = 0; k < n; k++)
+        folds = folds and constant_index_[i.*operands[k]] != no_constant;
+    if (folds) {
+        double r[4];
+        for (unsigned k = 0; k < n; k++) {
+            r[k] = constants_[constant_index_[i.*operands[k]]];
+            i.*operands[k] = k;
+        }
+        i.dst = 3;
+        run(&i, &i + 1, r);
+        return constant(r[3]);
+    }
+    i.dst = n_virtual_++;
+    constant_index_.push_back(no_constant);
+    code_.push_back(i);
+    return i.dst;
+}
+
+unsigned BytecodeRealDoubleVisitor::emit(Opcode op, unsigned a, unsigned b,
+                                         unsigned c)
+{
+    Instruction i;
+    i.op = op;
+    i.a = a;
+    i.b = b;
+    i.c = c;
+    i.n = 0;
+    return push(i);
+}
+
+unsigned BytecodeRealDoubleVisitor::emit_call(double (*f)(double), unsigned a)
+{
+    Instruction i;
+    i.op = CALL;
+    i.a = a;
+    i.b = i.c = 0;
+    i.f = f;
+    return push(i);
+}
+
+unsigned BytecodeRealDoubleVisitor::emit_powi(unsigned a, long n)
+{
+    if (n == 1)
+        return a;
+    if (n == 2)
+        return emit(MUL, a, a);
+    if (n == -1)
+        return emit(DIV, constant(1.0), a);
+    Instruction i;
+    i.op = POWI;
+    i.a = a;
+    i.b = i.c = 0;
+    i.n = n;
+    return push(i);
+}
+
+unsigned BytecodeRealDoubleVisitor::emit_pow(const Basic &base,
+                                             const Basic &exp)
+{
+    if (eq(base, *E))
+        return emit(EXP, apply(exp));
+    if (is_a<Integer>(exp)) {
+        const integer_class &n = static_cast<const Integer &>(exp).i;
+        if (mp_fits_slong_p(n))
+            return emit_powi(apply(base), mp_get_si(n));
+    } else if (is_a<Rational>(exp)) {
+        const rational_class &q = static_cast<const Rational &>(exp).i;
+        if (get_den(q) == 2 and (get_num(q) == 1 or get_num(q) == -1)) {
+            unsigned r = emit(SQRT, apply(base));
+            return get_num(q) == 1 ? r : emit(DIV, constant(1.0), r);
+        }
+    }
+    return emit(POW, apply(base), apply(exp));
+}
+
+void BytecodeRealDoubleVisitor::allocate_registers()
+{
+    // The constants come first, followed by the inputs and the temporaries
+    unsigned n_fixed = constants_.size() + symbols_.size();
+    std::vector<unsigned> phys(n_virtual_);
+    for (unsigned v = 0; v < n_virtual_; v++) {
+        if (constant_index_[v] != no_constant)
+            phys[v] = constant_index_[v];
+        else if (v < symbols_.size())
+            phys[v] = constants_.size() + v;
+    }
+
+    // Index of the last instruction reading each virtual register. Outputs
+    // are read after the last one.
+    std::vector<std::size_t> last_use(n_virtual_, 0);
+    for (std::size_t i = 0; i < code_.size(); i++) {
+        for (unsigned k = 0; k < arity(code_[i].op); k++)
+            last_use[code_[i].*operands[k]] = i;
+    }
+    for (unsigned v : outputs_)
+        last_use[v] = code_.size();
+
+    std::vector<unsigned> free;
+    unsigned size = n_fixed;
+    for (std::size_t i = 0; i < code_.size(); i++) {
+        Instruction &ins = code_[i];
+        unsigned n = arity(ins.op);
+        for (unsigned k = 0; k < n; k++) {
+            unsigned v = ins.*operands[k];
+            ins.*operands[k] = phys[v];
+            // An instruction reads all operands before it writes the result,
+            // so the result can go to the register of an operand
+            if (phys[v] >= n_fixed and last_use[v] == i) {
+                free.push_back(phys[v]);
+                last_use[v] = code_.size() + 1;
+            }
+        }
+        unsigned v = ins.dst;
+        if (free.empty()) {
+            phys[v] = size++;
+        } else {
+            phys[v] = free.back();
+            free.pop_back();
+        }
+        ins.dst = phys[v];
+        if (last_use[v] <= i)
+            free.push_back(phys[v]);
+    }
+
+    for (auto &v : outputs_)
+        v = phys[v];
+    n_constants_ = constants_.size();
+    registers_.assign(size, 0.0);
+    batch_registers_.clear();
+    std::copy(constants_.begin(), constants_.end(), registers_.begin());
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Integer &x)
+{
+    result_ = constant(mp_get_d(x.i));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Rational &x)
+{
+    result_ = constant(mp_get_d(x.i));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const RealDouble &x)
+{
+    result_ = constant(x.i);
+}
+
+#ifdef HAVE_SYMENGINE_MPFR
+void BytecodeRealDoubleVisitor::bvisit(const RealMPFR &x)
+{
+    result_ = constant(mpfr_get_d(x.i.get_mpfr_t(), MPFR_RNDN));
+}
+#endif
+
+void BytecodeRealDoubleVisitor::bvisit(const Constant &x)
+{
+    if (eq(x, *pi)) {
+        result_ = constant(3.1415926535897932);
+    } else if (eq(x, *E)) {
+        result_ = constant(2.7182818284590452);
+    } else if (eq(x, *EulerGamma)) {
+        result_ = constant(0.57721566490153286);
+    } else {
+        throw SymEngineException("Constant " + x.get_name()
+                                 + " is not implemented.");
+    }
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Symbol &x)
+{
+    // All input symbols are in the cache already
+    throw SymEngineException("Symbol not in the symbols vector.");
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Add &x)
+{
+    unsigned r = 0;
+    bool empty = x.coef_->is_zero();
+    if (not empty)
+        r = apply(*x.coef_);
+    for (const auto &p : x.dict_) {
+        unsigned t = apply(*p.first);
+        if (p.second->is_one()) {
+            r = empty ? t : emit(ADD, r, t);
+        } else if (p.second->is_minus_one()) {
+            r = empty ? emit(NEG, t) : emit(SUB, r, t);
+        } else {
+            unsigned c = apply(*p.second);
+            r = empty ? emit(MUL, c, t) : emit(MULADD, c, t, r);
+        }
+        empty = false;
+    }
+    result_ = r;
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Mul &x)
+{
+    // The factors with negative exponents are collected into a denominator,
+    // so that there is a single division
+    unsigned num = 0, den = 0;
+    bool has_num = not x.coef_->is_one(), has_den = false;
+    if (has_num)
+        num = apply(*x.coef_);
+    for (const auto &p : x.dict_) {
+        if (is_a_Number(*p.second)
+            and static_cast<const Number &>(*p.second).is_negative()) {
+            const Number &exp = static_cast<const Number &>(*p.second);
+            unsigned t = emit_pow(*p.first, *exp.mul(*minus_one));
+            den = has_den ? emit(MUL, den, t) : t;
+            has_den = true;
+        } else {
+            unsigned t = emit_pow(*p.first, *p.second);
+            num = has_num ? emit(MUL, num, t) : t;
+            has_num = true;
+        }
+    }
+    if (not has_den) {
+        result_ = num;
+    } else {
+        result_ = emit(DIV, has_num ? num : constant(1.0), den);
+    }
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Pow &x)
+{
+    result_ = emit_pow(*x.get_base(), *x.get_exp());
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Log &x)
+{
+    result_ = emit(LOG, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Abs &x)
+{
+    result_ = emit(ABS, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Sin &x)
+{
+    result_ = emit(SIN, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Cos &x)
+{
+    result_ = emit(COS, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Tan &x)
+{
+    result_ = emit(TAN, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Cot &x)
+{
+    result_ = emit_call(cot, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Csc &x)
+{
+    result_ = emit_call(csc, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Sec &x)
+{
+    result_ = emit_call(sec, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ASin &x)
+{
+    result_ = emit_call(static_cast<unary_fn>(std::asin), apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ACos &x)
+{
+    result_ = emit_call(static_cast<unary_fn>(std::acos), apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ATan &x)
+{
+    result_ = emit_call(static_cast<unary_fn>(std::atan), apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ACot &x)
+{
+    result_ = emit_call(acot, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ACsc &x)
+{
+    result_ = emit_call(acsc, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ASec &x)
+{
+    result_ = emit_call(asec, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Sinh &x)
+{
+    result_ = emit_call(static_cast<unary_fn>(std::sinh), apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Cosh &x)
+{
+    result_ = emit_call(static_cast<unary_fn>(std::cosh), apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Tanh &x)
+{
+    result_ = emit_call(static_cast<unary_fn>(std::tanh), apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Coth &x)
+{
+    result_ = emit_call(coth, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Csch &x)
+{
+    result_ = emit_call(csch, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Sech &x)
+{
+    result_ = emit_call(sech, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ASinh &x)
+{
+    result_
+        = emit_call(static_cast<unary_fn>(std::asinh), apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ACosh &x)
+{
+    result_
+        = emit_call(static_cast<unary_fn>(std::acosh), apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ATanh &x)
+{
+    result_
+        = emit_call(static_cast<unary_fn>(std::atanh), apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ACoth &x)
+{
+    result_ = emit_call(acoth, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ACsch &x)
+{
+    result_ = emit_call(acsch, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ASech &x)
+{
+    result_ = emit_call(asech, apply(*x.get_arg()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const ATan2 &x)
+{
+    result_ = emit(ATAN2, apply(*x.get_num()), apply(*x.get_den()));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Gamma &x)
+{
+    result_ = emit_call(static_cast<unary_fn>(std::tgamma),
+                        apply(*x.get_args()[0]));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const LogGamma &x)
+{
+    result_ = emit_call(static_cast<unary_fn>(std::lgamma),
+                        apply(*x.get_args()[0]));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Erf &x)
+{
+    result_
+        = emit_call(static_cast<unary_fn>(std::erf), apply(*x.get_args()[0]));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Erfc &x)
+{
+    result_
+        = emit_call(static_cast<unary_fn>(std::erfc), apply(*x.get_args()[0]));
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Max &x)
+{
+    vec_basic args = x.get_args();
+    unsigned r = apply(*args[0]);
+    for (unsigned i = 1; i < args.size(); i++)
+        r = emit(MAX, r, apply(*args[i]));
+    result_ = r;
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Min &x)
+{
+    vec_basic args = x.get_args();
+    unsigned r = apply(*args[0]);
+    for (unsigned i = 1; i < args.size(); i++)
+        r = emit(MIN, r, apply(*args[i]));
+    result_ = r;
+}
+
+void BytecodeRealDoubleVisitor::bvisit(const Basic &)
+{
+    throw NotImplementedError("Not Implemented");
+}
+
+} // SymEngine
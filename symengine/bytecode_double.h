@@ -0,0 +1,181 @@
+/**
+ *  \file bytecode_double.h
+ *  Compiles expressions into bytecode for fast repeated evaluation to double
+ *
+ **/
+#ifndef SYMENGINE_BYTECODE_DOUBLE_H
+#define SYMENGINE_BYTECODE_DOUBLE_H
+
+#include <map>
+
+#include <symengine/visitor.h>
+
+namespace SymEngine
+{
+
+/*! An alternative to LambdaRealDoubleVisitor with the same interface.
+ *
+ * Instead of a tree of closures, `init()` compiles the outputs into a flat
+ * list of instructions in topological order that operate on a register file.
+ * A subexpression that occurs several times, also in different outputs, is
+ * compiled only once and its register is reused. Constant subexpressions are
+ * folded, and registers are recycled once their value isn't needed anymore,
+ * so that the register file stays small. `call()` then runs a single loop
+ * over the instructions.
+ *
+ * `call_batch()` evaluates many points at once. Every instruction is then
+ * executed for a block of points in a loop that the compiler can vectorize,
+ * so that the cost of dispatching the instructions is shared by the block.
+ *
+ * `call()` writes to the register file, so an instance must not be used by
+ * several threads at the same time.
+ * */
+class BytecodeRealDoubleVisitor : public BaseVisitor<BytecodeRealDoubleVisitor>
+{
+public:
+    enum Opcode {
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        MULADD,
+        NEG,
+        POW,
+        POWI,
+        SQRT,
+        EXP,
+        LOG,
+        SIN,
+        COS,
+        TAN,
+        ABS,
+        MAX,
+        MIN,
+        ATAN2,
+        // Unary functions without an opcode of their own, called through
+        // the pointer `f`
+        CALL,
+    };
+
+    struct Instruction {
+        Opcode op;
+        unsigned dst, a, b, c;
+        union {
+            //! Exponent of POWI
+            long n;
+            //! Function called by CALL
+            double (*f)(double);
+        };
+    };
+
+protected:
+    typedef std::vector<Instruction> Code;
+
+    vec_basic symbols_;
+    Code code_;
+    std::vector<double> registers_;
+    //! Register file of `call_batch()`, with a block of values per register
+    std::vector<double> batch_registers_;
+    //! The registers holding the results
+    std::vector<unsigned> outputs_;
+    //! The registers of the constants are followed by those of the inputs
+    unsigned n_constants_;
+
+    // State during `init()`. Instructions refer to virtual registers that
+    // are only mapped to the register file once all outputs are compiled.
+    static const unsigned no_constant = -1;
+    umap_basic_uint cache_;
+    std::vector<double> constants_;
+    //! Virtual registers of the constants, by their representation
+    std::map<uint64_t, unsigned> constant_map_;
+    //! Index into `constants_` of each virtual register, or `no_constant`
+    std::vector<unsigned> constant_index_;
+    unsigned n_virtual_;
+    unsigned result_;
+
+    //! \return a virtual register with the value `d`
+    unsigned constant(double d);
+    //! Appends `i` to the code, unless its operands are all constants
+    unsigned push(Instruction i);
+    unsigned emit(Opcode op, unsigned a, unsigned b = 0, unsigned c = 0);
+    unsigned emit_call(double (*f)(double), unsigned a);
+    unsigned emit_powi(unsigned a, long n);
+    unsigned emit_pow(const Basic &base, const Basic &exp);
+    void allocate_registers();
+
+public:
+    //! Compiles `b` with the input symbols `x`
+    void init(const vec_basic &x, const Basic &b);
+    /*! Compiles all `outputs` with the input symbols `inputs`. They are
+     *  evaluated together by `call(outs, inps)`.
+     * */
+    void init(const vec_basic &inputs, const vec_basic &outputs);
+
+    unsigned apply(const Basic &b);
+
+    //! Evaluates the first output at the point `vec`
+    double call(const std::vector<double> &vec);
+    //! Evaluates all outputs at the point `inps` and writes them to `outs`
+    void call(double *outs, const double *inps);
+    /*! Evaluates all outputs at `n` points. The inputs are stored by symbol,
+     *  `inps[j * n + i]` is the value of the j-th symbol at the i-th point,
+     *  and the outputs the same way, `outs[k * n + i]`.
+     * */
+    void call_batch(double *outs, const double *inps, std::size_t n);
+
+    //! \return the number of instructions
+    std::size_t size() const
+    {
+        return code_.size();
+    }
+
+    void bvisit(const Integer &x);
+    void bvisit(const Rational &x);
+    void bvisit(const RealDouble &x);
+#ifdef HAVE_SYMENGINE_MPFR
+    void bvisit(const RealMPFR &x);
+#endif
+    void bvisit(const Constant &x);
+    void bvisit(const Symbol &x);
+    void bvisit(const Add &x);
+    void bvisit(const Mul &x);
+    void bvisit(const Pow &x);
+    void bvisit(const Log &x);
+    void bvisit(const Abs &x);
+    void bvisit(const Sin &x);
+    void bvisit(const Cos &x);
+    void bvisit(const Tan &x);
+    void bvisit(const Cot &x);
+    void bvisit(const Csc &x);
+    void bvisit(const Sec &x);
+    void bvisit(const ASin &x);
+    void bvisit(const ACos &x);
+    void bvisit(const ATan &x);
+    void bvisit(const ACot &x);
+    void bvisit(const ACsc &x);
+    void bvisit(const ASec &x);
+    void bvisit(const Sinh &x);
+    void bvisit(const Cosh &x);
+    void bvisit(const Tanh &x);
+    void bvisit(const Coth &x);
+    void bvisit(const Csch &x);
+    void bvisit(const Sech &x);
+    void bvisit(const ASinh &x);
+    void bvisit(const ACosh &x);
+    void bvisit(const ATanh &x);
+    void bvisit(const ACoth &x);
+    void bvisit(const ACsch &x);
+    void bvisit(const ASech &x);
+    void bvisit(const ATan2 &x);
+    void bvisit(const Gamma &x);
+    void bvisit(const LogGamma &x);
+    void bvisit(const Erf &x);
+    void bvisit(const Erfc &x);
+    void bvisit(const Max &x);
+    void bvisit(const Min &x);
+    void bvisit(const Basic &);
+};
+
+} // SymEngine
+
+#endif
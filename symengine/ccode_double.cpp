@@ -0,0 +1,313 @@
+#include <symengine/ccode_double.h>
+#include <symengine/codegen.h>
+#include <symengine/eval_double.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace SymEngine
+{
+
+namespace
+{
+
+std::string print_double(double d)
+{
+    if (std::isnan(d))
+        return "NAN";
+    if (std::isinf(d))
+        return d > 0 ? "HUGE_VAL" : "(-HUGE_VAL)";
+    std::ostringstream s;
+    s << std::setprecision(17) << d;
+    std::string str = s.str();
+    if (str.find_first_of(".e") == std::string::npos)
+        str += ".0";
+    if (d < 0)
+        str = "(" + str + ")";
+    return str;
+}
+
+/* Prints the input symbols and the symbols of the common subexpressions as
+ * local variables, and all numbers as double literals. */
+class CCodeDoublePrinter : public BaseVisitor<CCodeDoublePrinter, CodePrinter>
+{
+    const std::map<RCP<const Basic>, std::string, RCPBasicKeyLess> &names_;
+
+public:
+    using CodePrinter::bvisit;
+
+    CCodeDoublePrinter(
+        const std::map<RCP<const Basic>, std::string, RCPBasicKeyLess> &names)
+        : names_(names)
+    {
+    }
+
+    void bvisit(const Symbol &x)
+    {
+        auto it = names_.find(x.rcp_from_this());
+        if (it == names_.end())
+            throw SymEngineException("Symbol " + x.get_name()
+                                     + " not in the inputs");
+        str_ = it->second;
+    }
+    void bvisit(const Integer &x)
+    {
+        str_ = print_double(mp_get_d(x.i));
+    }
+    void bvisit(const Rational &x)
+    {
+        str_ = "(" + print_double(mp_get_d(get_num(x.i))) + "/"
+               + print_double(mp_get_d(get_den(x.i))) + ")";
+    }
+    void bvisit(const RealDouble &x)
+    {
+        str_ = print_double(x.i);
+    }
+    void bvisit(const Constant &x)
+    {
+        str_ = print_double(eval_double(x));
+    }
+    void bvisit(const Infty &x)
+    {
+        if (x.is_positive_infinity())
+            str_ = "HUGE_VAL";
+        else if (x.is_negative_infinity())
+            str_ = "(-HUGE_VAL)";
+        else
+            throw SymEngineException("Not supported");
+    }
+};
+
+// Removes the directory `dir` with the files `files` in it
+void remove_files(const std::string &dir, const std::vector<std::string> &files)
+{
+    for (const auto &f : files)
+        std::remove(f.c_str());
+    rmdir(dir.c_str());
+}
+
+// Splits `s` at whitespace. There is no quoting, as no shell is involved.
+std::vector<std::string> split_args(const std::string &s)
+{
+    std::vector<std::string> args;
+    std::istringstream in(s);
+    std::string arg;
+    while (in >> arg)
+        args.push_back(arg);
+    return args;
+}
+
+/* Runs the program `args[0]`, looked up in PATH, with the arguments `args`
+ * and its standard output and error written to `log_file`. The arguments
+ * are passed to the program as they are, without a shell.
+ * \return true if it exited with status 0 */
+bool run(const std::vector<std::string> &args, const std::string &log_file)
+{
+    std::vector<char *> argv;
+    for (const auto &a : args)
+        argv.push_back(const_cast<char *>(a.c_str()));
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    if (posix_spawn_file_actions_init(&actions) != 0)
+        return false;
+    pid_t pid;
+    int r = posix_spawn_file_actions_addopen(
+        &actions, STDOUT_FILENO, log_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+        0600);
+    if (r == 0)
+        r = posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO,
+                                             STDERR_FILENO);
+    if (r == 0)
+        r = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(),
+                         environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (r != 0)
+        return false;
+    int status;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR)
+            return false;
+    }
+    return WIFEXITED(status) and WEXITSTATUS(status) == 0;
+}
+
+} // anonymous namespace
+
+CCodeDoubleVisitor::CCodeDoubleVisitor()
+{
+    const char *cc = std::getenv("CC");
+    if (cc != nullptr and cc[0] != '\0') {
+        compiler_ = cc;
+    } else {
+#ifdef SYMENGINE_C_COMPILER
+        compiler_ = SYMENGINE_C_COMPILER;
+#else
+        compiler_ = "cc";
+#endif
+    }
+    flags_ = "-O3 -fopenmp-simd";
+}
+
+CCodeDoubleVisitor::~CCodeDoubleVisitor()
+{
+    close();
+}
+
+void CCodeDoubleVisitor::close()
+{
+    if (handle_ != nullptr)
+        dlclose(handle_);
+    handle_ = nullptr;
+    func_ = nullptr;
+    func_batch_ = nullptr;
+}
+
+void CCodeDoubleVisitor::set_compiler(const std::string &compiler,
+                                      const std::string &flags)
+{
+    compiler_ = compiler;
+    flags_ = flags;
+}
+
+void CCodeDoubleVisitor::init(const vec_basic &x, const Basic &b, bool cse)
+{
+    init(x, {b.rcp_from_this()}, cse);
+}
+
+void CCodeDoubleVisitor::init(const vec_basic &inputs,
+                              const vec_basic &outputs, bool cse)
+{
+    vec_pair replacements;
+    vec_basic reduced_exprs;
+    if (cse) {
+        SymEngine::cse(replacements, reduced_exprs, outputs);
+    } else {
+        reduced_exprs = outputs;
+    }
+
+    // The symbols of the replacements come first, as in LLVMDoubleVisitor
+    std::map<RCP<const Basic>, std::string, RCPBasicKeyLess> names;
+    for (unsigned i = 0; i < replacements.size(); i++)
+        names.insert({replacements[i].first, "t" + std::to_string(i)});
+    for (unsigned i = 0; i < inputs.size(); i++)
+        names.insert({inputs[i], "i" + std::to_string(i)});
+
+    // The body of both functions, with the inputs in `in(j)` and the
+    // outputs in `out(k)`
+    CCodeDoublePrinter printer(names);
+    std::vector<std::string> temps, outs;
+    for (const auto &p : replacements)
+        temps.push_back(printer.apply(p.second));
+    for (const auto &e : reduced_exprs)
+        outs.push_back(printer.apply(e));
+    auto body = [&](const std::string &indent,
+                    std::function<std::string(unsigned)> in,
+                    std::function<std::string(unsigned)> out) {
+        std::ostringstream s;
+        for (unsigned j = 0; j < inputs.size(); j++)
+            s << indent << "const double i" << j << " = " << in(j) << ";\n";
+        for (unsigned j = 0; j < temps.size(); j++)
+            s << indent << "const double t" << j << " = " << temps[j]
+              << ";\n";
+        for (unsigned k = 0; k < outs.size(); k++)
+            s << indent << out(k) << " = " << outs[k] << ";\n";
+        return s.str();
+    };
+
+    std::ostringstream src;
+    src << "#include <math.h>\n\n";
+    src << "void symengine_func(const double *restrict inps, "
+           "double *restrict outs)\n{\n";
+    src << body("    ",
+                [](unsigned j) { return "inps[" + std::to_string(j) + "]"; },
+                [](unsigned k) { return "outs[" + std::to_string(k) + "]"; });
+    src << "}\n\n";
+    src << "void symengine_func_batch(const double *restrict inps, "
+           "double *restrict outs, long n)\n{\n";
+    src << "    long p;\n";
+    src << "#pragma omp simd\n";
+    src << "    for (p = 0; p < n; p++) {\n";
+    src << body("        ",
+                [](unsigned j) {
+                    return "inps[" + std::to_string(j) + " * n + p]";
+                },
+                [](unsigned k) {
+                    return "outs[" + std::to_string(k) + " * n + p]";
+                });
+    src << "    }\n}\n";
+    source_ = src.str();
+
+    const char *tmp = std::getenv("TMPDIR");
+    std::string dir = std::string(tmp != nullptr and tmp[0] != '\0' ? tmp
+                                                                     : "/tmp")
+                      + "/symengine_XXXXXX";
+    if (mkdtemp(&dir[0]) == nullptr)
+        throw SymEngineException("Cannot create a directory in " + dir);
+    std::string c_file = dir + "/func.c";
+    std::string so_file = dir + "/func.so";
+    std::string log_file = dir + "/func.log";
+    std::vector<std::string> files = {c_file, so_file, log_file};
+
+    {
+        std::ofstream f(c_file);
+        f << source_;
+        if (not f) {
+            remove_files(dir, files);
+            throw SymEngineException("Cannot write " + c_file);
+        }
+    }
+    std::vector<std::string> args = split_args(compiler_);
+    if (args.empty()) {
+        remove_files(dir, files);
+        throw SymEngineException("No C compiler is set");
+    }
+    for (const auto &a : split_args(flags_))
+        args.push_back(a);
+    for (const char *a : {"-shared", "-fPIC", "-o"})
+        args.push_back(a);
+    args.push_back(so_file);
+    args.push_back(c_file);
+    args.push_back("-lm");
+    if (not run(args, log_file)) {
+        std::string command;
+        for (const auto &a : args)
+            command += (command.empty() ? "" : " ") + a;
+        std::ifstream f(log_file);
+        std::string log((std::istreambuf_iterator<char>(f)),
+                        std::istreambuf_iterator<char>());
+        remove_files(dir, files);
+        throw SymEngineException("Compiling the generated code failed: "
+                                 + command + "\n" + log);
+    }
+
+    close();
+    // The library stays loaded after its file is removed
+    handle_ = dlopen(so_file.c_str(), RTLD_NOW | RTLD_LOCAL);
+    remove_files(dir, files);
+    if (handle_ == nullptr)
+        throw SymEngineException(std::string("dlopen failed: ") + dlerror());
+    func_ = reinterpret_cast<void (*)(const double *, double *)>(
+        dlsym(handle_, "symengine_func"));
+    func_batch_ = reinterpret_cast<void (*)(const double *, double *, long)>(
+        dlsym(handle_, "symengine_func_batch"));
+    if (func_ == nullptr or func_batch_ == nullptr) {
+        close();
+        throw SymEngineException("The generated functions were not found");
+    }
+}
+
+} // SymEngine
@@ -0,0 +1,97 @@
+/**
+ *  \file ccode_double.h
+ *  Evaluates expressions to double with C code compiled at runtime
+ *
+ **/
+#ifndef SYMENGINE_CCODE_DOUBLE_H
+#define SYMENGINE_CCODE_DOUBLE_H
+
+#include <symengine/basic.h>
+
+#ifdef HAVE_SYMENGINE_CCODE_DOUBLE
+
+namespace SymEngine
+{
+
+/*! An alternative to LLVMDoubleVisitor with the same interface, for hosts
+ *  without LLVM.
+ *
+ * `init()` generates a self-contained C source with the functions
+ * `void symengine_func(const double *inps, double *outs)` and
+ * `void symengine_func_batch(const double *inps, double *outs, long n)`.
+ * The common subexpressions of the outputs are computed once into
+ * temporaries, the pointers are `restrict` and the loop of the batch
+ * function over the points is marked with `#pragma omp simd`. The source
+ * is compiled into a shared library by the C compiler, which is loaded
+ * with `dlopen()`.
+ *
+ * The compiler is `cc`, or SYMENGINE_C_COMPILER if it was configured, unless
+ * the environment variable `CC` is set or `set_compiler()` is called. It is started with
+ * `posix_spawnp()`, not through a shell.
+ * */
+class CCodeDoubleVisitor
+{
+    void *handle_ = nullptr;
+    void (*func_)(const double *, double *) = nullptr;
+    void (*func_batch_)(const double *, double *, long) = nullptr;
+    std::string compiler_;
+    std::string flags_;
+    std::string source_;
+
+    void close();
+
+public:
+    CCodeDoubleVisitor();
+    ~CCodeDoubleVisitor();
+    CCodeDoubleVisitor(const CCodeDoubleVisitor &) = delete;
+    CCodeDoubleVisitor &operator=(const CCodeDoubleVisitor &) = delete;
+
+    /*! Sets the command of the C compiler and its options. The options
+     *  `-shared -fPIC -o <library>` are always added. Both are split at
+     *  whitespace and run without a shell, so there is no quoting.
+     * */
+    void set_compiler(const std::string &compiler,
+                      const std::string &flags = "-O3 -fopenmp-simd");
+
+    //! Compiles `b` with the input symbols `x`
+    void init(const vec_basic &x, const Basic &b, bool cse = true);
+    /*! Compiles all `outputs` with the input symbols `inputs`. With `cse`,
+     *  their common subexpressions are computed once.
+     * */
+    void init(const vec_basic &inputs, const vec_basic &outputs,
+              bool cse = true);
+
+    //! \return the C source of the last call of `init()`
+    const std::string &get_source() const
+    {
+        return source_;
+    }
+
+    //! Evaluates the first output at the point `vec`
+    double call(const std::vector<double> &vec)
+    {
+        double ret;
+        func_(vec.data(), &ret);
+        return ret;
+    }
+
+    //! Evaluates all outputs at the point `inps` and writes them to `outs`
+    void call(double *outs, const double *inps)
+    {
+        func_(inps, outs);
+    }
+
+    /*! Evaluates all outputs at `n` points. The inputs are stored by symbol,
+     *  `inps[j * n + i]` is the value of the j-th symbol at the i-th point,
+     *  and the outputs the same way, `outs[k * n + i]`.
+     * */
+    void call_batch(double *outs, const double *inps, std::size_t n)
+    {
+        func_batch_(inps, outs, n);
+    }
+};
+
+} // SymEngine
+
+#endif
+#endif
@@ -82,12 +82,114 @@ public:
     }
     void bvisit(const Rational &x)
     {
+        // Both are printed as doubles, so that it isn't an integer division
         std::ostringstream o;
-        double n = mp_get_d(get_num(x.i));
-        double d = mp_get_d(get_den(x.i));
-        o << n << "/" << d;
+        o << get_num(x.i) << ".0/" << get_den(x.i) << ".0";
         str_ = o.str();
     }
+    void bvisit(const BooleanAtom &x)
+    {
+        str_ = x.get_val() ? "1" : "0";
+    }
+    void bvisit(const And &x)
+    {
+        print_logical(x.get_args(), " && ");
+    }
+    void bvisit(const Or &x)
+    {
+        print_logical(x.get_args(), " || ");
+    }
+    void bvisit(const Not &x)
+    {
+        str_ = "!(" + apply(x.get_arg()) + ")";
+    }
+    void print_logical(const vec_basic &args, const char *op)
+    {
+        std::ostringstream s;
+        for (size_t i = 0; i < args.size(); i++) {
+            if (i != 0)
+                s << op;
+            s << "(" << apply(args[i]) << ")";
+        }
+        str_ = s.str();
+    }
+    // The functions that are not in math.h or named differently there
+    void bvisit(const Abs &x)
+    {
+        str_ = "fabs(" + apply(x.get_arg()) + ")";
+    }
+    void bvisit(const Gamma &x)
+    {
+        str_ = "tgamma(" + apply(x.get_arg()) + ")";
+    }
+    void bvisit(const LogGamma &x)
+    {
+        str_ = "lgamma(" + apply(x.get_arg()) + ")";
+    }
+    void bvisit(const Max &x)
+    {
+        print_nested(x.get_args(), "fmax");
+    }
+    void bvisit(const Min &x)
+    {
+        print_nested(x.get_args(), "fmin");
+    }
+    void print_nested(const vec_basic &args, const char *f)
+    {
+        std::string s = apply(args.back());
+        for (size_t i = args.size() - 1; i-- > 0;) {
+            s = std::string(f) + "(" + apply(args[i]) + ", " + s + ")";
+        }
+        str_ = s;
+    }
+    void bvisit(const Cot &x)
+    {
+        str_ = "(1.0/tan(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const Sec &x)
+    {
+        str_ = "(1.0/cos(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const Csc &x)
+    {
+        str_ = "(1.0/sin(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const Coth &x)
+    {
+        str_ = "(1.0/tanh(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const Sech &x)
+    {
+        str_ = "(1.0/cosh(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const Csch &x)
+    {
+        str_ = "(1.0/sinh(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const ACot &x)
+    {
+        str_ = "atan(1.0/(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const ASec &x)
+    {
+        str_ = "acos(1.0/(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const ACsc &x)
+    {
+        str_ = "asin(1.0/(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const ACoth &x)
+    {
+        str_ = "atanh(1.0/(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const ASech &x)
+    {
+        str_ = "acosh(1.0/(" + apply(x.get_arg()) + "))";
+    }
+    void bvisit(const ACsch &x)
+    {
+        str_ = "asinh(1.0/(" + apply(x.get_arg()) + "))";
+    }
     void bvisit(const EmptySet &x)
     {
         throw SymEngineException("Not supported");
@@ -152,7 +254,7 @@ public:
     }
 };
 
-std::string ccode(const Basic &x)
+inline std::string ccode(const Basic &x)
 {
     CodePrinter c;
     return c.apply(x);
@@ -0,0 +1,185 @@
+#include <symengine/visitor.h>
+#include <symengine/subs.h>
+#include <unordered_set>
+
+namespace SymEngine
+{
+
+namespace
+{
+
+bool is_cse_atom(const Basic &b)
+{
+    return is_a<Symbol>(b) or is_a_Number(b) or is_a<Constant>(b);
+}
+
+/* The arguments of `b` that SubsVisitor replaces: the terms of an Add
+ * without their coefficients and the factors of a Mul as powers. */
+vec_basic cse_args(const Basic &b)
+{
+    vec_basic args;
+    if (is_a<Add>(b)) {
+        for (const auto &p : static_cast<const Add &>(b).dict_)
+            args.push_back(p.first);
+    } else if (is_a<Mul>(b)) {
+        for (const auto &p : static_cast<const Mul &>(b).dict_) {
+            if (eq(*p.second, *one)) {
+                args.push_back(p.first);
+            } else {
+                args.push_back(make_rcp<const Pow>(p.first, p.second));
+            }
+        }
+    } else if (not is_a<Piecewise>(b)) {
+        // SubsVisitor doesn't replace inside of a Piecewise
+        args = b.get_args();
+    }
+    return args;
+}
+
+/* Counts how often each subexpression of `e` is referenced and appends the
+ * subexpressions to `order` after their own subexpressions. Only the first
+ * visit of a node descends into its arguments, so that an argument of a
+ * repeated subexpression doesn't count as repeated. The nodes are visited
+ * with an explicit stack, so that deep expressions don't overflow the
+ * stack. */
+void count_subexpressions(const RCP<const Basic> &e, umap_basic_uint &count,
+                          vec_basic &order)
+{
+    // The nodes to visit, and the ones whose arguments were visited
+    std::vector<std::pair<RCP<const Basic>, bool>> stack;
+    stack.push_back({e, false});
+    while (not stack.empty()) {
+        RCP<const Basic> b = stack.back().first;
+        bool visited = stack.back().second;
+        stack.pop_back();
+        if (visited) {
+            order.push_back(b);
+            continue;
+        }
+        if (is_cse_atom(*b))
+            continue;
+        auto it = count.find(b);
+        if (it != count.end()) {
+            it->second++;
+            continue;
+        }
+        count.insert({b, 1});
+        stack.push_back({b, true});
+        // Pushed in reverse, so that the arguments are visited in order
+        vec_basic args = cse_args(*b);
+        for (auto a = args.rbegin(); a != args.rend(); ++a)
+            stack.push_back({*a, false});
+    }
+}
+
+/* Adds the symbols in `e` to `symbols`. Unlike `free_symbols()`, the
+ * nodes are visited once each, with an explicit stack, and the variables
+ * of a Subs or Derivative are included. */
+void collect_symbols(const RCP<const Basic> &e, set_basic &symbols)
+{
+    std::unordered_set<RCP<const Basic>, RCPBasicHash, RCPBasicKeyEq> visited;
+    vec_basic stack = {e};
+    while (not stack.empty()) {
+        RCP<const Basic> b = stack.back();
+        stack.pop_back();
+        if (is_a<Symbol>(*b)) {
+            symbols.insert(b);
+            continue;
+        }
+        if (symbol_signature(*b) == 0)
+            continue;
+        for (const auto &a : b->get_args()) {
+            if (visited.insert(a).second)
+                stack.push_back(a);
+        }
+    }
+}
+
+/* Orders `replacements` so that each one only uses the symbols of the ones
+ * before it. They are in this order already, unless a key was replaced as
+ * a term of an Add with a coefficient, which `cse_args` doesn't return. */
+void sort_replacements(vec_pair &replacements)
+{
+    umap_basic_uint index;
+    for (unsigned i = 0; i < replacements.size(); i++)
+        index.insert({replacements[i].first, i});
+    std::vector<std::vector<unsigned>> uses(replacements.size());
+    bool sorted = true;
+    for (unsigned i = 0; i < replacements.size(); i++) {
+        set_basic symbols;
+        collect_symbols(replacements[i].second, symbols);
+        for (const auto &s : symbols) {
+            auto it = index.find(s);
+            if (it != index.end()) {
+                uses[i].push_back(it->second);
+                sorted = sorted and it->second < i;
+            }
+        }
+    }
+    if (sorted)
+        return;
+
+    // Each replacement follows the ones it uses, depth first
+    vec_pair result;
+    std::vector<bool> done(replacements.size(), false);
+    std::vector<std::pair<unsigned, bool>> stack;
+    for (unsigned i = 0; i < replacements.size(); i++) {
+        stack.push_back({i, false});
+        while (not stack.empty()) {
+            auto top = stack.back();
+            stack.pop_back();
+            if (done[top.first])
+                continue;
+            if (top.second) {
+                done[top.first] = true;
+                result.push_back(replacements[top.first]);
+            } else {
+                stack.push_back({top.first, true});
+                for (unsigned j : uses[top.first])
+                    stack.push_back({j, false});
+            }
+        }
+    }
+    replacements.swap(result);
+}
+
+} // anonymous namespace
+
+void cse(vec_pair &replacements, vec_basic &reduced_exprs,
+         const vec_basic &exprs)
+{
+    umap_basic_uint count;
+    vec_basic order;
+    set_basic used;
+    for (const auto &e : exprs) {
+        count_subexpressions(e, count, order);
+        collect_symbols(e, used);
+    }
+
+    // The new symbols are x0, x1, ..., skipping the ones in `exprs`
+    map_basic_basic subs_dict;
+    vec_basic keys;
+    unsigned n = 0;
+    for (const auto &b : order) {
+        if (count[b] < 2)
+            continue;
+        RCP<const Basic> s;
+        do {
+            s = symbol("x" + std::to_string(n++));
+        } while (used.find(s) != used.end());
+        insert(subs_dict, b, s);
+        keys.push_back(b);
+    }
+
+    // A single visitor substitutes all replacements and expressions, so
+    // that the shared subexpressions are substituted once
+    SubsVisitor v(subs_dict);
+    for (const auto &b : keys)
+        replacements.push_back({subs_dict.find(b)->second, v.apply_args(*b)});
+    sort_replacements(replacements);
+
+    for (const auto &e : exprs)
+        reduced_exprs.push_back(v.apply(e));
+}
+
+} // SymEngine
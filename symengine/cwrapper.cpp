@@ -1169,6 +1169,25 @@ CWRAPPER_OUTPUT_TYPE basic_free_symbols(const basic self, CSetBasic *symbols)
     CWRAPPER_END
 }
 
+CWRAPPER_OUTPUT_TYPE basic_cse(CVecBasic *replacement_syms,
+                               CVecBasic *replacement_exprs,
+                               CVecBasic *reduced_exprs,
+                               const CVecBasic *exprs)
+{
+    CWRAPPER_BEGIN
+    SymEngine::vec_pair replacements;
+    SymEngine::vec_basic reduced;
+    SymEngine::cse(replacements, reduced, exprs->m);
+    replacement_syms->m.clear();
+    replacement_exprs->m.clear();
+    for (auto &p : replacements) {
+        replacement_syms->m.push_back(p.first);
+        replacement_exprs->m.push_back(p.second);
+    }
+    reduced_exprs->m = reduced;
+    CWRAPPER_END
+}
+
 size_t basic_hash(const basic self)
 {
     return self->m->hash();
@@ -536,6 +536,13 @@ size_t mapbasicbasic_size(CMapBasicBasic *self);
 CWRAPPER_OUTPUT_TYPE basic_get_args(const basic self, CVecBasic *args);
 //! Returns a CSetBasic of set_basic given by free_symbols
 CWRAPPER_OUTPUT_TYPE basic_free_symbols(const basic self, CSetBasic *symbols);
+//! Common subexpression elimination of `exprs`. The i-th replacement symbol
+//! stands for the i-th replacement expression, which may refer to the
+//! replacement symbols before it.
+CWRAPPER_OUTPUT_TYPE basic_cse(CVecBasic *replacement_syms,
+                               CVecBasic *replacement_exprs,
+                               CVecBasic *reduced_exprs,
+                               const CVecBasic *exprs);
 //! returns the hash of the Basic object
 size_t basic_hash(const basic self);
 //! substitutes all the keys with their mapped values
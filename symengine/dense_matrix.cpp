@@ -1,9 +1,16 @@
 #include <symengine/matrix.h>
 #include <symengine/add.h>
+#include <symengine/derivative.h>
 #include <symengine/pow.h>
 #include <symengine/subs.h>
 #include <symengine/symengine_exception.h>
 
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace SymEngine
 {
 
@@ -185,52 +192,203 @@ void DenseMatrix::FFLDU(MatrixBase &L, MatrixBase &D, MatrixBase &U) const
 
 // ---------------------------- Jacobian -------------------------------------//
 
-void jacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result)
+namespace
 {
-    SYMENGINE_ASSERT(A.col_ == 1);
-    SYMENGINE_ASSERT(x.col_ == 1);
-    SYMENGINE_ASSERT(A.row_ == result.nrows() and x.row_ == result.ncols());
-    bool error = false;
-#pragma omp parallel for
-    for (unsigned i = 0; i < result.row_; i++) {
-        for (unsigned j = 0; j < result.col_; j++) {
-            if (is_a<Symbol>(*(x.m_[j]))) {
-                const RCP<const Symbol> x_
-                    = rcp_static_cast<const Symbol>(x.m_[j]);
-                result.m_[i * result.col_ + j] = A.m_[i]->diff(x_);
-            } else {
-                error = true;
-                break;
+
+#ifdef _OPENMP
+// The number of threads of a parallel region for `nthreads`, where 0 stands
+// for the default of OpenMP
+int num_threads(unsigned nthreads)
+{
+    return nthreads == 0 ? omp_get_max_threads() : nthreads;
+}
+#endif
+
+void check_symbols(const DenseMatrix &x, const std::string &hint)
+{
+    for (unsigned j = 0; j < x.nrows(); j++) {
+        if (not is_a<Symbol>(*x.get(j, 0)))
+            throw SymEngineException("'x' must contain Symbols only" + hint);
+    }
+}
+
+typedef std::vector<std::pair<unsigned, RCP<const Basic>>> sparse_row;
+
+/* Differentiates `exprs[i]` w.r.t. the symbols `x[j]`, for `j >= i` if
+ * `upper` is set and for all `j` otherwise, and stores the nonzero
+ * derivatives in `rows[i]` sorted by `j`. The derivative w.r.t. a symbol
+ * that doesn't occur in an expression is zero without differentiating it.
+ *
+ * The rows are distributed over the threads, which share nothing but the
+ * expressions; their reference counts and hashes are atomic since OpenMP
+ * requires WITH_SYMENGINE_THREAD_SAFE. An exception must not leave the
+ * parallel region, so the first one is rethrown after it. */
+void jacobian_rows(const vec_basic &exprs, const DenseMatrix &x, bool upper,
+                   unsigned nthreads, std::vector<sparse_row> &rows)
+{
+    rows.assign(exprs.size(), sparse_row());
+    std::exception_ptr error;
+#pragma omp parallel num_threads(num_threads(nthreads))
+    {
+        // The rows share their subexpressions, so each thread differentiates
+        // them once for all of its entries
+        DiffCache cache;
+#pragma omp for schedule(dynamic)
+        for (unsigned i = 0; i < exprs.size(); i++) {
+            try {
+                set_basic symbols = free_symbols(*exprs[i]);
+                for (unsigned j = upper ? i : 0; j < x.nrows(); j++) {
+                    RCP<const Basic> x_ = x.get(j, 0);
+                    if (symbols.find(x_) == symbols.end())
+                        continue;
+                    RCP<const Basic> d = SymEngine::diff(
+                        exprs[i], rcp_static_cast<const Symbol>(x_), cache);
+                    if (neq(*d, *zero))
+                        rows[i].push_back({j, d});
+                }
+            } catch (...) {
+#pragma omp critical
+                if (not error)
+                    error = std::current_exception();
             }
         }
     }
-    if (error) {
-        throw SymEngineException(
-            "'x' must contain Symbols only. "
-            "Use sjacobian for SymPy style differentiation");
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// The gradient of `f` w.r.t. `x` as a vector, in a single reverse pass
+vec_basic gradient_vector(const RCP<const Basic> &f, const DenseMatrix &x)
+{
+    vec_basic symbols;
+    for (unsigned j = 0; j < x.nrows(); j++)
+        symbols.push_back(x.get(j, 0));
+    return gradient(f, symbols);
+}
+
+// Copies the upper triangle in `rows` to the lower triangle
+std::vector<sparse_row> symmetric_rows(const std::vector<sparse_row> &rows)
+{
+    // Row `j` gets the entries of the rows `i < j` in the order of `i`,
+    // before its own ones
+    std::vector<sparse_row> full(rows.size());
+    for (unsigned i = 0; i < rows.size(); i++) {
+        for (const auto &p : rows[i]) {
+            full[i].push_back(p);
+            if (p.first != i)
+                full[p.first].push_back({i, p.second});
+        }
+    }
+    return full;
+}
+
+void dense_from_rows(const std::vector<sparse_row> &rows, DenseMatrix &result)
+{
+    for (unsigned i = 0; i < result.nrows(); i++) {
+        for (unsigned j = 0; j < result.ncols(); j++)
+            result.set(i, j, zero);
+        for (const auto &p : rows[i])
+            result.set(i, p.first, p.second);
+    }
+}
+
+void csr_from_rows(unsigned ncols, const std::vector<sparse_row> &rows,
+                   CSRMatrix &result)
+{
+    std::vector<unsigned> p = {0}, j;
+    vec_basic x;
+    for (const auto &row : rows) {
+        for (const auto &e : row) {
+            j.push_back(e.first);
+            x.push_back(e.second);
+        }
+        p.push_back(j.size());
     }
+    result = CSRMatrix(rows.size(), ncols, std::move(p), std::move(j),
+                       std::move(x));
 }
 
-void sjacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result)
+} // anonymous namespace
+
+void jacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result,
+              unsigned nthreads)
 {
     SYMENGINE_ASSERT(A.col_ == 1);
     SYMENGINE_ASSERT(x.col_ == 1);
     SYMENGINE_ASSERT(A.row_ == result.nrows() and x.row_ == result.ncols());
-#pragma omp parallel for
+    check_symbols(x, ". Use sjacobian for SymPy style differentiation");
+    std::vector<sparse_row> rows;
+    jacobian_rows(A.m_, x, false, nthreads, rows);
+    dense_from_rows(rows, result);
+}
+
+void jacobian(const DenseMatrix &A, const DenseMatrix &x, CSRMatrix &result,
+              unsigned nthreads)
+{
+    SYMENGINE_ASSERT(A.col_ == 1);
+    SYMENGINE_ASSERT(x.col_ == 1);
+    check_symbols(x, ". Use sjacobian for SymPy style differentiation");
+    std::vector<sparse_row> rows;
+    jacobian_rows(A.m_, x, false, nthreads, rows);
+    csr_from_rows(x.row_, rows, result);
+}
+
+void sjacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result,
+               unsigned nthreads)
+{
+    SYMENGINE_ASSERT(A.col_ == 1);
+    SYMENGINE_ASSERT(x.col_ == 1);
+    SYMENGINE_ASSERT(A.row_ == result.nrows() and x.row_ == result.ncols());
+    std::exception_ptr error;
+#pragma omp parallel for num_threads(num_threads(nthreads)) schedule(dynamic)
     for (unsigned i = 0; i < result.row_; i++) {
-        for (unsigned j = 0; j < result.col_; j++) {
-            if (is_a<Symbol>(*(x.m_[j]))) {
-                const RCP<const Symbol> x_
-                    = rcp_static_cast<const Symbol>(x.m_[j]);
-                result.m_[i * result.col_ + j] = A.m_[i]->diff(x_);
-            } else {
-                // TODO: Use a dummy symbol
-                const RCP<const Symbol> x_ = symbol("x_");
-                result.m_[i * result.col_ + j] = ssubs(
-                    ssubs(A.m_[i], {{x.m_[j], x_}})->diff(x_), {{x_, x.m_[j]}});
+        try {
+            for (unsigned j = 0; j < result.col_; j++) {
+                if (is_a<Symbol>(*(x.m_[j]))) {
+                    const RCP<const Symbol> x_
+                        = rcp_static_cast<const Symbol>(x.m_[j]);
+                    result.m_[i * result.col_ + j] = A.m_[i]->diff(x_);
+                } else {
+                    // TODO: Use a dummy symbol
+                    const RCP<const Symbol> x_ = symbol("x_");
+                    result.m_[i * result.col_ + j]
+                        = ssubs(ssubs(A.m_[i], {{x.m_[j], x_}})->diff(x_),
+                                {{x_, x.m_[j]}});
+                }
             }
+        } catch (...) {
+#pragma omp critical
+            if (not error)
+                error = std::current_exception();
         }
     }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// ---------------------------- Hessian -------------------------------------//
+
+void hessian(const RCP<const Basic> &f, const DenseMatrix &x,
+             DenseMatrix &result, unsigned nthreads)
+{
+    SYMENGINE_ASSERT(x.ncols() == 1);
+    SYMENGINE_ASSERT(x.nrows() == result.nrows()
+                     and x.nrows() == result.ncols());
+    check_symbols(x, "");
+    // Only the upper triangle is differentiated
+    std::vector<sparse_row> rows;
+    jacobian_rows(gradient_vector(f, x), x, true, nthreads, rows);
+    dense_from_rows(symmetric_rows(rows), result);
+}
+
+void hessian(const RCP<const Basic> &f, const DenseMatrix &x,
+             CSRMatrix &result, unsigned nthreads)
+{
+    SYMENGINE_ASSERT(x.ncols() == 1);
+    check_symbols(x, "");
+    std::vector<sparse_row> rows;
+    jacobian_rows(gradient_vector(f, x), x, true, nthreads, rows);
+    csr_from_rows(x.nrows(), symmetric_rows(rows), result);
 }
 
 // ---------------------------- Diff -------------------------------------//
@@ -238,33 +396,57 @@ void sjacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result)
 void diff(const DenseMatrix &A, const RCP<const Symbol> &x, DenseMatrix &result)
 {
     SYMENGINE_ASSERT(A.row_ == result.nrows() and A.col_ == result.ncols());
-#pragma omp parallel for
-    for (unsigned i = 0; i < result.row_; i++) {
-        for (unsigned j = 0; j < result.col_; j++) {
-            result.m_[i * result.col_ + j] = A.m_[i * result.col_ + j]->diff(x);
+    std::exception_ptr error;
+#pragma omp parallel
+    {
+        DiffCache cache;
+#pragma omp for
+        for (unsigned i = 0; i < result.row_; i++) {
+            try {
+                for (unsigned j = 0; j < result.col_; j++) {
+                    result.m_[i * result.col_ + j] = SymEngine::diff(
+                        A.m_[i * result.col_ + j], x, cache);
+                }
+            } catch (...) {
+#pragma omp critical
+                if (not error)
+                    error = std::current_exception();
+            }
         }
     }
+    if (error)
+        std::rethrow_exception(error);
 }
 
 void sdiff(const DenseMatrix &A, const RCP<const Basic> &x, DenseMatrix &result)
 {
     SYMENGINE_ASSERT(A.row_ == result.nrows() and A.col_ == result.ncols());
+    std::exception_ptr error;
 #pragma omp parallel for
     for (unsigned i = 0; i < result.row_; i++) {
-        for (unsigned j = 0; j < result.col_; j++) {
-            if (is_a<Symbol>(*x)) {
-                const RCP<const Symbol> x_ = rcp_static_cast<const Symbol>(x);
-                result.m_[i * result.col_ + j]
-                    = A.m_[i * result.col_ + j]->diff(x_);
-            } else {
-                // TODO: Use a dummy symbol
-                const RCP<const Symbol> x_ = symbol("_x");
-                result.m_[i * result.col_ + j] = ssubs(
-                    ssubs(A.m_[i * result.col_ + j], {{x, x_}})->diff(x_),
-                    {{x_, x}});
+        try {
+            for (unsigned j = 0; j < result.col_; j++) {
+                if (is_a<Symbol>(*x)) {
+                    const RCP<const Symbol> x_
+                        = rcp_static_cast<const Symbol>(x);
+                    result.m_[i * result.col_ + j]
+                        = A.m_[i * result.col_ + j]->diff(x_);
+                } else {
+                    // TODO: Use a dummy symbol
+                    const RCP<const Symbol> x_ = symbol("_x");
+                    result.m_[i * result.col_ + j] = ssubs(
+                        ssubs(A.m_[i * result.col_ + j], {{x, x_}})->diff(x_),
+                        {{x_, x}});
+                }
             }
+        } catch (...) {
+#pragma omp critical
+            if (not error)
+                error = std::current_exception();
         }
     }
+    if (error)
+        std::rethrow_exception(error);
 }
 
 // ----------------------------- Matrix Transpose ----------------------------//
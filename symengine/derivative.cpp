@@ -1,14 +1,61 @@
 #include <symengine/visitor.h>
 #include <symengine/subs.h>
 
+#include <functional>
+
 namespace SymEngine
 {
 
 extern RCP<const Basic> i2;
 
+namespace
+{
+// The cache of the innermost call of `diff` with a cache in this thread
+thread_local DiffCache *active_diff_cache = nullptr;
+
+// Makes `cache` the active cache while it is in scope
+class DiffCacheGuard
+{
+    DiffCache *previous_;
+
+public:
+    DiffCacheGuard(DiffCache *cache) : previous_{active_diff_cache}
+    {
+        active_diff_cache = cache;
+    }
+    ~DiffCacheGuard()
+    {
+        active_diff_cache = previous_;
+    }
+};
+} // anonymous namespace
+
 class DiffImplementation
 {
 public:
+    // Looks up the derivative of `self` in the active cache, if there is
+    // one. Symbols and numbers are cheaper to differentiate than to hash.
+    template <typename T>
+    static RCP<const Basic> cached_diff(const T &self,
+                                        const RCP<const Symbol> &x)
+    {
+        if (not may_have_symbol(self, *x))
+            return zero;
+        DiffCache *cache = active_diff_cache;
+        if (cache == nullptr or is_a<Symbol>(self) or is_a_Number(self))
+            return diff(self, x);
+        DiffCache::key_type key = {self.rcp_from_this(), x};
+        auto it = cache->cache_.find(key);
+        if (it != cache->cache_.end())
+            return it->second;
+        RCP<const Basic> result = diff(self, x);
+        if (cache->max_size_ != 0
+            and cache->cache_.size() >= cache->max_size_)
+            cache->cache_.clear();
+        cache->cache_.insert({std::move(key), result});
+        return result;
+    }
+
 // Uncomment the following define in order to debug the methods:
 #define debug_methods
 #ifndef debug_methods
@@ -674,18 +721,200 @@ public:
 #define IMPLEMENT_DIFF(CLASS)                                                  \
     RCP<const Basic> CLASS::diff(const RCP<const Symbol> &x) const             \
     {                                                                          \
-        return DiffImplementation::diff(*this, x);                             \
+        return DiffImplementation::cached_diff(*this, x);                      \
     };
 
 #define SYMENGINE_ENUM(TypeID, Class) IMPLEMENT_DIFF(Class)
 #include "symengine/type_codes.inc"
 #undef SYMENGINE_ENUM
 
-RCP<const Basic> diff(const RCP<const Basic> &arg, const RCP<const Symbol> &x)
+RCP<const Basic> diff(const RCP<const Basic> &arg, const RCP<const Symbol> &x,
+                      bool cache)
 {
+    if (not cache)
+        return arg->diff(x);
+    DiffCache c;
+    return diff(arg, x, c);
+}
+
+RCP<const Basic> diff(const RCP<const Basic> &arg, const RCP<const Symbol> &x,
+                      DiffCache &cache)
+{
+    DiffCacheGuard guard(&cache);
     return arg->diff(x);
 }
 
+namespace
+{
+
+/* Calls `f` for the arguments of `b` that `gradient` differentiates
+ * through: the terms of an Add, the bases and exponents of the factors of a
+ * Mul, the base and exponent of a Pow and the argument of a one argument
+ * function. Other nodes are differentiated as a whole. */
+template <typename F>
+void for_each_gradient_arg(const Basic &b, F &&f)
+{
+    if (is_a<Add>(b)) {
+        for (const auto &p : static_cast<const Add &>(b).get_dict())
+            f(p.first);
+    } else if (is_a<Mul>(b)) {
+        for (const auto &p : static_cast<const Mul &>(b).get_dict()) {
+            f(p.first);
+            f(p.second);
+        }
+    } else if (is_a<Pow>(b)) {
+        f(static_cast<const Pow &>(b).get_base());
+        f(static_cast<const Pow &>(b).get_exp());
+    } else if (is_a_sub<OneArgFunction>(b)) {
+        f(static_cast<const OneArgFunction &>(b).get_arg());
+    }
+}
+
+bool is_gradient_node(const Basic &b)
+{
+    return is_a<Add>(b) or is_a<Mul>(b) or is_a<Pow>(b)
+           or is_a_sub<OneArgFunction>(b);
+}
+
+/* Appends the nodes of `b` to `order` after their arguments and numbers
+ * them in `index`. Iterative, so that deep expressions don't overflow the
+ * stack. */
+void gradient_order(const RCP<const Basic> &b, umap_basic_uint &index,
+                    vec_basic &order)
+{
+    // The nodes and whether their arguments were pushed already
+    std::vector<std::pair<RCP<const Basic>, bool>> stack = {{b, false}};
+    while (not stack.empty()) {
+        RCP<const Basic> node = stack.back().first;
+        if (index.find(node) != index.end()) {
+            // A shared node that was added in the meantime
+            stack.pop_back();
+        } else if (not stack.back().second) {
+            stack.back().second = true;
+            for_each_gradient_arg(*node, [&](const RCP<const Basic> &a) {
+                if (index.find(a) == index.end())
+                    stack.push_back({a, false});
+            });
+        } else {
+            stack.pop_back();
+            index.insert({node, order.size()});
+            order.push_back(node);
+        }
+    }
+}
+
+} // anonymous namespace
+
+vec_basic gradient(const RCP<const Basic> &f, const vec_basic &symbols)
+{
+    umap_basic_uint targets;
+    for (size_t i = 0; i < symbols.size(); i++) {
+        if (not is_a<Symbol>(*symbols[i]))
+            throw SymEngineException("'symbols' must contain Symbols only");
+        targets.insert({symbols[i], i});
+    }
+
+    umap_basic_uint index;
+    vec_basic order;
+    gradient_order(f, index, order);
+
+    // Whether a node depends on the symbols, and for the nodes that are
+    // differentiated as a whole, the symbols they depend on
+    std::vector<bool> depends(order.size(), false);
+    std::map<size_t, vec_basic> whole;
+    for (size_t i = 0; i < order.size(); i++) {
+        const Basic &b = *order[i];
+        if (is_a<Symbol>(b)) {
+            depends[i] = targets.find(order[i]) != targets.end();
+        } else if (is_gradient_node(b)) {
+            for_each_gradient_arg(b, [&](const RCP<const Basic> &a) {
+                depends[i] = depends[i] or depends[index[a]];
+            });
+        } else if (not is_a_Number(b) and not is_a<Constant>(b)) {
+            for (const auto &s : free_symbols(b)) {
+                if (targets.find(s) != targets.end())
+                    whole[i].push_back(s);
+            }
+            depends[i] = whole.find(i) != whole.end();
+        }
+    }
+
+    // The adjoint of a node is the derivative of `f` w.r.t. the node. The
+    // nodes are processed after all nodes that use them, so their adjoint
+    // is complete when they are reached. It is shared by the adjoints of
+    // the arguments of the node.
+    std::vector<vec_basic> terms(order.size());
+    // The symbols may occur both as nodes and in nodes differentiated as a
+    // whole, so their terms are collected separately
+    std::vector<vec_basic> symbol_terms(symbols.size());
+    terms.back().push_back(one);
+    RCP<const Symbol> d = DiffImplementation::get_dummy(*f, "x");
+    DiffCache cache;
+    auto propagate = [&](const RCP<const Basic> &arg,
+                         const RCP<const Basic> &adjoint,
+                         const std::function<RCP<const Basic>()> &partial) {
+        size_t j = index[arg];
+        if (depends[j])
+            terms[j].push_back(mul(adjoint, partial()));
+    };
+    for (size_t i = order.size(); i-- > 0;) {
+        if (not depends[i] or terms[i].empty())
+            continue;
+        const RCP<const Basic> &b = order[i];
+        RCP<const Basic> adjoint = add(terms[i]);
+        terms[i].clear();
+        if (is_a<Symbol>(*b)) {
+            symbol_terms[targets[b]].push_back(adjoint);
+        } else if (is_a<Add>(*b)) {
+            for (const auto &p : static_cast<const Add &>(*b).get_dict())
+                propagate(p.first, adjoint, [&]() { return p.second; });
+        } else if (is_a<Mul>(*b)) {
+            for (const auto &p : static_cast<const Mul &>(*b).get_dict()) {
+                propagate(p.first, adjoint, [&]() {
+                    return mul(p.second, div(b, p.first));
+                });
+                propagate(p.second, adjoint,
+                          [&]() { return mul(b, log(p.first)); });
+            }
+        } else if (is_a<Pow>(*b)) {
+            const Pow &x = static_cast<const Pow &>(*b);
+            propagate(x.get_base(), adjoint, [&]() {
+                return mul(x.get_exp(),
+                           pow(x.get_base(), sub(x.get_exp(), one)));
+            });
+            propagate(x.get_exp(), adjoint,
+                      [&]() { return mul(b, log(x.get_base())); });
+        } else if (is_a_sub<OneArgFunction>(*b)) {
+            const OneArgFunction &x = static_cast<const OneArgFunction &>(*b);
+            propagate(x.get_arg(), adjoint, [&]() {
+                return x.create(d)->diff(d)->subs({{d, x.get_arg()}});
+            });
+        } else {
+            for (const auto &s : whole[i]) {
+                symbol_terms[targets[s]].push_back(mul(
+                    adjoint,
+                    diff(b, rcp_static_cast<const Symbol>(s), cache)));
+            }
+        }
+    }
+
+    vec_basic result;
+    for (const auto &s : symbols)
+        result.push_back(add(symbol_terms[targets[s]]));
+    return result;
+}
+
+vec_basic gradient_outputs(const RCP<const Basic> &f, const vec_basic &symbols,
+                           bool with_value)
+{
+    vec_basic outputs;
+    if (with_value)
+        outputs.push_back(f);
+    for (auto &d : gradient(f, symbols))
+        outputs.push_back(d);
+    return outputs;
+}
+
 //! SymPy style differentiation for non-symbol variables
 // Since SymPy's differentiation makes no sense mathematically, it is
 // defined separately here for compatibility
@@ -8,12 +8,85 @@
 #define SYMENGINE_DERIVATIVE_H
 
 #include <symengine/basic.h>
+#include <symengine/symbol.h>
 
 namespace SymEngine
 {
 
-//! Differentiation w.r.t symbols
-RCP<const Basic> diff(const RCP<const Basic> &arg, const RCP<const Symbol> &x);
+/*! Derivatives of subexpressions, keyed on the subexpression and the symbol.
+ *
+ * While a cache is passed to `diff`, every subexpression is differentiated
+ * only once, even if it occurs many times in a DAG. The same cache can be
+ * passed to many calls, for example for all entries of a Jacobian. It holds
+ * references to the subexpressions and their derivatives; with a
+ * `max_size`, it is cleared whenever it grows beyond it.
+ *
+ * A cache must not be used by several threads at the same time.
+ * */
+class DiffCache
+{
+public:
+    explicit DiffCache(size_t max_size = 0) : max_size_{max_size}
+    {
+    }
+    size_t size() const
+    {
+        return cache_.size();
+    }
+    void clear()
+    {
+        cache_.clear();
+    }
+
+private:
+    typedef std::pair<RCP<const Basic>, RCP<const Symbol>> key_type;
+    struct KeyHash {
+        size_t operator()(const key_type &k) const
+        {
+            hash_t seed = k.first->hash();
+            hash_combine<Basic>(seed, *k.second);
+            return seed;
+        }
+    };
+    struct KeyEq {
+        bool operator()(const key_type &a, const key_type &b) const
+        {
+            return (a.first.get() == b.first.get() or eq(*a.first, *b.first))
+                   and eq(*a.second, *b.second);
+        }
+    };
+    std::unordered_map<key_type, RCP<const Basic>, KeyHash, KeyEq> cache_;
+    size_t max_size_;
+
+    friend class DiffImplementation;
+};
+
+/*! Differentiation w.r.t symbols. With `cache`, the subexpressions shared in
+ *  the DAG of `arg` are differentiated only once.
+ * */
+RCP<const Basic> diff(const RCP<const Basic> &arg, const RCP<const Symbol> &x,
+                      bool cache = false);
+
+//! Differentiation w.r.t symbols, with the derivatives cached in `cache`
+RCP<const Basic> diff(const RCP<const Basic> &arg, const RCP<const Symbol> &x,
+                      DiffCache &cache);
+
+/*! Gradient of `f` w.r.t. `symbols` by reverse mode differentiation.
+ *
+ * All partial derivatives are built in one sweep over the DAG of `f`, from
+ * `f` to the symbols, instead of one call of `diff` per symbol. The
+ * derivative of `f` w.r.t. every node is built once and shared by the
+ * derivatives w.r.t. the arguments of the node, so the results have many
+ * common subexpressions; they are meant to be compiled with `cse`, for
+ * example by `LambdaRealDoubleVisitor::init_gradient`.
+ * */
+vec_basic gradient(const RCP<const Basic> &f, const vec_basic &symbols);
+
+/*! The outputs compiled by the `init_gradient` methods of the visitors:
+ *  `gradient(f, symbols)`, preceded by `f` if `with_value` is set.
+ * */
+vec_basic gradient_outputs(const RCP<const Basic> &f, const vec_basic &symbols,
+                           bool with_value);
 
 //! SymPy style differentiation w.r.t non-symbols and symbols
 RCP<const Basic> sdiff(const RCP<const Basic> &arg, const RCP<const Basic> &x);
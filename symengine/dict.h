@@ -7,6 +7,7 @@
 #ifndef SYMENGINE_DICT_H
 #define SYMENGINE_DICT_H
 #include <symengine/mp_class.h>
+#include <symengine/flat_containers.h>
 #include <algorithm>
 #include <cstdint>
 
@@ -25,24 +26,25 @@ struct RCPIntegerKeyLess;
 
 bool eq(const Basic &, const Basic &);
 typedef uint64_t hash_t;
-typedef std::unordered_map<RCP<const Basic>, RCP<const Number>, RCPBasicHash,
-                           RCPBasicKeyEq> umap_basic_num;
+typedef flat_hash_map<RCP<const Basic>, RCP<const Number>, RCPBasicHash,
+                      RCPBasicKeyEq> umap_basic_num;
 typedef std::unordered_map<short, RCP<const Basic>> umap_short_basic;
 typedef std::unordered_map<int, RCP<const Basic>> umap_int_basic;
-typedef std::unordered_map<RCP<const Basic>, RCP<const Basic>, RCPBasicHash,
-                           RCPBasicKeyEq> umap_basic_basic;
+typedef flat_hash_map<RCP<const Basic>, RCP<const Basic>, RCPBasicHash,
+                      RCPBasicKeyEq> umap_basic_basic;
 
 typedef std::vector<int> vec_int;
 typedef std::vector<RCP<const Basic>> vec_basic;
 typedef std::vector<RCP<const Integer>> vec_integer;
 typedef std::vector<RCP<const Symbol>> vec_sym;
-typedef std::set<RCP<const Basic>, RCPBasicKeyLess> set_basic;
-typedef std::multiset<RCP<const Basic>, RCPBasicKeyLess> multiset_basic;
+typedef std::vector<std::pair<RCP<const Basic>, RCP<const Basic>>> vec_pair;
+typedef flat_set<RCP<const Basic>, RCPBasicKeyLess> set_basic;
+typedef flat_multiset<RCP<const Basic>, RCPBasicKeyLess> multiset_basic;
 typedef std::map<vec_int, long long int> map_vec_int;
 typedef std::map<vec_int, integer_class> map_vec_mpz;
 typedef std::map<RCP<const Basic>, RCP<const Number>, RCPBasicKeyLess>
     map_basic_num;
-typedef std::map<RCP<const Basic>, RCP<const Basic>, RCPBasicKeyLess>
+typedef flat_map<RCP<const Basic>, RCP<const Basic>, RCPBasicKeyLess>
     map_basic_basic;
 typedef std::map<RCP<const Integer>, unsigned, RCPIntegerKeyLess>
     map_integer_uint;
@@ -122,6 +124,20 @@ inline bool unified_eq(const std::map<K, V, C> &a, const std::map<K, V, C> &b)
     return ordered_eq(a, b);
 }
 
+template <typename K, typename C, bool M, unsigned N>
+inline bool unified_eq(const flat_set<K, C, M, N> &a,
+                       const flat_set<K, C, M, N> &b)
+{
+    return ordered_eq(a, b);
+}
+
+template <typename K, typename V, typename C, unsigned N>
+inline bool unified_eq(const flat_map<K, V, C, N> &a,
+                       const flat_map<K, V, C, N> &b)
+{
+    return ordered_eq(a, b);
+}
+
 template <typename K, typename V, typename H, typename E>
 inline bool unified_eq(const std::unordered_map<K, V, H, E> &a,
                        const std::unordered_map<K, V, H, E> &b)
@@ -129,6 +145,13 @@ inline bool unified_eq(const std::unordered_map<K, V, H, E> &a,
     return unordered_eq(a, b);
 }
 
+template <typename K, typename V, typename H, typename E>
+inline bool unified_eq(const flat_hash_map<K, V, H, E> &a,
+                       const flat_hash_map<K, V, H, E> &b)
+{
+    return unordered_eq(a, b);
+}
+
 template <typename T, typename U,
           typename = enable_if_t<std::is_base_of<Basic, T>::value
                                  and std::is_base_of<Basic, U>::value>>
@@ -246,6 +269,20 @@ inline int unified_compare(const std::map<K, V, C> &a,
     return ordered_compare(a, b);
 }
 
+template <typename K, typename C, bool M, unsigned N>
+inline int unified_compare(const flat_set<K, C, M, N> &a,
+                           const flat_set<K, C, M, N> &b)
+{
+    return ordered_compare(a, b);
+}
+
+template <typename K, typename V, typename C, unsigned N>
+inline int unified_compare(const flat_map<K, V, C, N> &a,
+                           const flat_map<K, V, C, N> &b)
+{
+    return ordered_compare(a, b);
+}
+
 template <typename K, typename V, typename H, typename E>
 inline int unified_compare(const std::unordered_map<K, V, H, E> &a,
                            const std::unordered_map<K, V, H, E> &b)
@@ -253,6 +290,13 @@ inline int unified_compare(const std::unordered_map<K, V, H, E> &a,
     return unordered_compare(a, b);
 }
 
+template <typename K, typename V, typename H, typename E>
+inline int unified_compare(const flat_hash_map<K, V, H, E> &a,
+                           const flat_hash_map<K, V, H, E> &b)
+{
+    return unordered_compare(a, b);
+}
+
 template <class T>
 inline int ordered_compare(const T &A, const T &B)
 {
@@ -2,6 +2,10 @@
 #include <symengine/eval_double.h>
 #include <symengine/symengine_exception.h>
 
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
 namespace SymEngine
 {
 
@@ -632,6 +636,321 @@ std::vector<fn> init_eval_double()
 
 const static std::vector<fn> table_eval_double = init_eval_double();
 
+namespace
+{
+
+typedef std::unordered_map<const Basic *, double> node_values;
+
+/* The nodes that eval_double_iterative() evaluates from the values of their
+ * arguments. All other nodes are leaves for it, which are evaluated by
+ * EvalRealDoubleVisitorFinal. */
+bool is_iterative_node(const Basic &b)
+{
+    switch (b.get_type_code()) {
+        case ADD:
+        case MUL:
+        case POW:
+        case SIN:
+        case COS:
+        case TAN:
+        case LOG:
+        case COT:
+        case CSC:
+        case SEC:
+        case ASIN:
+        case ACOS:
+        case ASEC:
+        case ACSC:
+        case ATAN:
+        case ACOT:
+        case SINH:
+        case CSCH:
+        case COSH:
+        case SECH:
+        case TANH:
+        case COTH:
+        case ASINH:
+        case ACSCH:
+        case ACOSH:
+        case ATANH:
+        case ACOTH:
+        case ASECH:
+        case ABS:
+        case GAMMA:
+        case LOGGAMMA:
+        case ERF:
+        case ERFC:
+        case ATAN2:
+        case MAX:
+        case MIN:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The same operations as in EvalRealDoubleVisitor, so that the results are
+// identical
+double eval_one_arg_function(TypeID id, double x)
+{
+    switch (id) {
+        case SIN:
+            return std::sin(x);
+        case COS:
+            return std::cos(x);
+        case TAN:
+            return std::tan(x);
+        case LOG:
+            return std::log(x);
+        case COT:
+            return 1.0 / std::tan(x);
+        case CSC:
+            return 1.0 / std::sin(x);
+        case SEC:
+            return 1.0 / std::cos(x);
+        case ASIN:
+            return std::asin(x);
+        case ACOS:
+            return std::acos(x);
+        case ASEC:
+            return std::acos(1.0 / x);
+        case ACSC:
+            return std::asin(1.0 / x);
+        case ATAN:
+            return std::atan(x);
+        case ACOT:
+            return std::atan(1.0 / x);
+        case SINH:
+            return std::sinh(x);
+        case CSCH:
+            return 1.0 / std::sinh(x);
+        case COSH:
+            return std::cosh(x);
+        case SECH:
+            return 1.0 / std::cosh(x);
+        case TANH:
+            return std::tanh(x);
+        case COTH:
+            return 1.0 / std::tanh(x);
+        case ASINH:
+            return std::asinh(x);
+        case ACSCH:
+            return std::asinh(1.0 / x);
+        case ACOSH:
+            return std::acosh(x);
+        case ATANH:
+            return std::atanh(x);
+        case ACOTH:
+            return std::atanh(1.0 / x);
+        case ASECH:
+            return std::acosh(1.0 / x);
+        case ABS:
+            return std::abs(x);
+        case GAMMA:
+            return std::tgamma(x);
+        case LOGGAMMA:
+            return std::lgamma(x);
+        case ERF:
+            return std::erf(x);
+        default:
+            SYMENGINE_ASSERT(id == ERFC);
+            return std::erfc(x);
+    }
+}
+
+// The value of `base**exp` the way Mul::get_args() creates it
+double factor_value(const Basic &base, const Basic &exp,
+                    const node_values &values)
+{
+    if (eq(exp, *one))
+        return values.find(&base)->second;
+    double e = values.find(&exp)->second;
+    if (eq(base, *E))
+        return std::exp(e);
+    return std::pow(values.find(&base)->second, e);
+}
+
+/* Calls `f` for each node whose value eval_node() reads to evaluate `b`. The
+ * terms of Add and the factors of Mul are read from their dictionaries
+ * instead of `get_args()`, which creates new nodes. */
+template <typename F>
+void for_each_arg(const Basic &b, F &&f)
+{
+    if (not is_iterative_node(b))
+        return;
+    switch (b.get_type_code()) {
+        case ADD: {
+            const Add &x = static_cast<const Add &>(b);
+            f(*x.get_coef());
+            for (const auto &p : x.get_dict()) {
+                if (not p.second->is_one())
+                    f(*p.second);
+                // coef*Mul is evaluated from the factors of the Mul
+                if (is_a<Mul>(*p.first) and not p.second->is_one()) {
+                    for (const auto &q :
+                         static_cast<const Mul &>(*p.first).get_dict()) {
+                        f(*q.first);
+                        f(*q.second);
+                    }
+                } else {
+                    f(*p.first);
+                }
+            }
+            break;
+        }
+        case MUL: {
+            const Mul &x = static_cast<const Mul &>(b);
+            f(*x.get_coef());
+            for (const auto &p : x.get_dict()) {
+                f(*p.first);
+                f(*p.second);
+            }
+            break;
+        }
+        case POW:
+            f(*static_cast<const Pow &>(b).get_base());
+            f(*static_cast<const Pow &>(b).get_exp());
+            break;
+        case ATAN2:
+            f(*static_cast<const ATan2 &>(b).get_num());
+            f(*static_cast<const ATan2 &>(b).get_den());
+            break;
+        case MAX:
+        case MIN:
+            for (const auto &a :
+                 static_cast<const MultiArgFunction &>(b).get_vec())
+                f(*a);
+            break;
+        default:
+            f(*static_cast<const OneArgFunction &>(b).get_arg());
+    }
+}
+
+/* Appends the nodes of the DAG `b` to `nodes` in post-order, each node once,
+ * using an explicit stack instead of recursion. */
+void topological_order(const Basic &b, std::vector<const Basic *> &nodes)
+{
+    std::unordered_set<const Basic *> visited;
+    // The nodes and whether their arguments were pushed already
+    std::vector<std::pair<const Basic *, bool>> stack = {{&b, false}};
+    while (not stack.empty()) {
+        const Basic *node = stack.back().first;
+        if (visited.find(node) != visited.end()) {
+            // A shared node that was added in the meantime
+            stack.pop_back();
+        } else if (not stack.back().second) {
+            stack.back().second = true;
+            for_each_arg(*node, [&](const Basic &a) {
+                if (visited.find(&a) == visited.end())
+                    stack.push_back({&a, false});
+            });
+        } else {
+            stack.pop_back();
+            visited.insert(node);
+            nodes.push_back(node);
+        }
+    }
+}
+
+/* Evaluates `b` from the `values` of its arguments, in the same order of
+ * operations as EvalRealDoubleVisitor with `get_args()`. The nodes that are
+ * not iterative are evaluated by EvalRealDoubleVisitorFinal. */
+double eval_node(const Basic &b, const node_values &values)
+{
+    auto value = [&](const Basic &a) { return values.find(&a)->second; };
+    switch (b.get_type_code()) {
+        case ADD: {
+            const Add &x = static_cast<const Add &>(b);
+            double tmp = 0;
+            if (not x.get_coef()->is_exact_zero())
+                tmp += value(*x.get_coef());
+            for (const auto &p : x.get_dict()) {
+                if (p.second->is_one()) {
+                    tmp += value(*p.first);
+                } else if (is_a<Mul>(*p.first)) {
+                    double term = 1;
+                    term *= value(*p.second);
+                    for (const auto &q :
+                         static_cast<const Mul &>(*p.first).get_dict())
+                        term *= factor_value(*q.first, *q.second, values);
+                    tmp += term;
+                } else {
+                    double term = 1;
+                    term *= value(*p.second);
+                    term *= value(*p.first);
+                    tmp += term;
+                }
+            }
+            return tmp;
+        }
+        case MUL: {
+            const Mul &x = static_cast<const Mul &>(b);
+            double tmp = 1;
+            if (not x.get_coef()->is_one())
+                tmp *= value(*x.get_coef());
+            for (const auto &p : x.get_dict())
+                tmp *= factor_value(*p.first, *p.second, values);
+            return tmp;
+        }
+        case POW: {
+            const Pow &x = static_cast<const Pow &>(b);
+            double exp_ = value(*x.get_exp());
+            if (eq(*x.get_base(), *E))
+                return std::exp(exp_);
+            return std::pow(value(*x.get_base()), exp_);
+        }
+        case ATAN2: {
+            const ATan2 &x = static_cast<const ATan2 &>(b);
+            return std::atan2(value(*x.get_num()), value(*x.get_den()));
+        }
+        case MAX:
+        case MIN: {
+            const vec_basic &v
+                = static_cast<const MultiArgFunction &>(b).get_vec();
+            double result = value(*v[0]);
+            for (size_t i = 1; i < v.size(); i++) {
+                double tmp = value(*v[i]);
+                if (b.get_type_code() == MAX)
+                    result = std::max(result, tmp);
+                else
+                    result = std::min(result, tmp);
+            }
+            return result;
+        }
+        default:
+            if (is_iterative_node(b)) {
+                return eval_one_arg_function(
+                    b.get_type_code(),
+                    value(*static_cast<const OneArgFunction &>(b).get_arg()));
+            }
+            EvalRealDoubleVisitorFinal v;
+            return v.apply(b);
+    }
+}
+
+// Evaluates `b` with the `values` of `symbols`
+double eval_double_iterative(const Basic &b, const umap_basic_uint &symbols,
+                             const std::vector<double> &values)
+{
+    std::vector<const Basic *> nodes;
+    topological_order(b, nodes);
+    node_values vals;
+    vals.reserve(nodes.size());
+    for (const Basic *node : nodes) {
+        if (is_a<Symbol>(*node)) {
+            auto it = symbols.find(node->rcp_from_this());
+            if (it == symbols.end())
+                throw SymEngineException("Symbol cannot be evaluated.");
+            vals.insert({node, values[it->second]});
+        } else {
+            vals.insert({node, eval_node(*node, vals)});
+        }
+    }
+    return vals.find(&b)->second;
+}
+
+} // anonymous namespace
+
 double eval_double(const Basic &b)
 {
     EvalRealDoubleVisitorFinal v;
@@ -655,6 +974,89 @@ double eval_double_visitor_pattern(const Basic &b)
     return v.apply(b);
 }
 
+double eval_double_iterative(const Basic &b)
+{
+    return eval_double_iterative(b, {}, {});
+}
+
+double eval_double(const Basic &b, const vec_basic &symbols,
+                   const std::vector<double> &values)
+{
+    SYMENGINE_ASSERT(symbols.size() == values.size());
+    umap_basic_uint indices;
+    for (unsigned i = 0; i < symbols.size(); i++)
+        indices.insert({symbols[i], i});
+    return eval_double_iterative(b, indices, values);
+}
+
+EvalPlan::EvalPlan(const Basic &b, const vec_basic &symbols)
+    : expr_(b.rcp_from_this()), symbols_(symbols),
+      dependents_(symbols.size())
+{
+    umap_basic_uint indices;
+    for (unsigned i = 0; i < symbols.size(); i++)
+        indices.insert({symbols[i], i});
+
+    // The indices of the symbols each node depends on, in increasing order
+    std::unordered_map<const Basic *, std::vector<unsigned>> deps;
+    std::vector<const Basic *> nodes;
+    topological_order(b, nodes);
+    values_.reserve(nodes.size());
+    for (const Basic *node : nodes) {
+        std::vector<unsigned> &d = deps[node];
+        if (is_a<Symbol>(*node)) {
+            auto it = indices.find(node->rcp_from_this());
+            if (it == indices.end())
+                throw SymEngineException(
+                    "Symbol " + static_cast<const Symbol &>(*node).get_name()
+                    + " is not in the symbols.");
+            d.push_back(it->second);
+            symbol_nodes_.push_back({node, it->second});
+            values_.insert({node, 0.0});
+            continue;
+        }
+        for_each_arg(*node, [&](const Basic &a) {
+            const std::vector<unsigned> &d2 = deps[&a];
+            std::vector<unsigned> u;
+            std::set_union(d.begin(), d.end(), d2.begin(), d2.end(),
+                           std::back_inserter(u));
+            d.swap(u);
+        });
+        if (d.empty()) {
+            // Folded into a constant
+            values_.insert({node, eval_node(*node, values_)});
+        } else {
+            values_.insert({node, 0.0});
+            for (unsigned i : d)
+                dependents_[i].push_back(nodes_.size());
+            nodes_.push_back(node);
+        }
+    }
+    dirty_.resize(nodes_.size());
+}
+
+double EvalPlan::call(const std::vector<double> &values)
+{
+    SYMENGINE_ASSERT(values.size() == symbols_.size());
+    for (unsigned i = 0; i < symbols_.size(); i++) {
+        if (evaluated_ and values[i] == last_values_[i])
+            continue;
+        for (unsigned j : dependents_[i])
+            dirty_[j] = true;
+    }
+    for (const auto &p : symbol_nodes_)
+        values_.find(p.first)->second = values[p.second];
+    for (unsigned j = 0; j < nodes_.size(); j++) {
+        if (not dirty_[j])
+            continue;
+        dirty_[j] = false;
+        values_.find(nodes_[j])->second = eval_node(*nodes_[j], values_);
+    }
+    last_values_ = values;
+    evaluated_ = true;
+    return values_.find(expr_.get())->second;
+}
+
 #define ACCEPT(CLASS)                                                          \
     void CLASS::accept(EvalRealDoubleVisitorFinal &v) const                    \
     {                                                                          \
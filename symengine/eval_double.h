@@ -21,6 +21,50 @@ double eval_double_single_dispatch(const Basic &b);
 
 double eval_double_visitor_pattern(const Basic &b);
 
+/*! Gives the same results as `eval_double`, but evaluates the expression
+ *  with an explicit stack instead of recursion, so that it works for deeply
+ *  nested expressions, and evaluates subexpressions shared in the DAG only
+ *  once.
+ * */
+double eval_double_iterative(const Basic &b);
+
+/*! Evaluates `b` with the `values` of `symbols`, without substituting them
+ *  into `b` first. The results are the same as those of `eval_double` for
+ *  `b` with the values substituted.
+ * */
+double eval_double(const Basic &b, const vec_basic &symbols,
+                   const std::vector<double> &values);
+
+/*! Evaluates `b` repeatedly for different values of `symbols`.
+ *
+ *  The nodes of `b` are ordered once, so that each comes after its
+ *  arguments, and the subexpressions that don't depend on any symbol are
+ *  evaluated once in the constructor. `call()` evaluates only the nodes that
+ *  depend on the symbols whose values changed since the previous call.
+ * */
+class EvalPlan
+{
+    RCP<const Basic> expr_;
+    vec_basic symbols_;
+    //! The nodes that depend on the symbols, in the order of evaluation
+    std::vector<const Basic *> nodes_;
+    //! The current values of all nodes
+    std::unordered_map<const Basic *, double> values_;
+    //! The indices in `nodes_` of the nodes that depend on each symbol
+    std::vector<std::vector<unsigned>> dependents_;
+    //! The symbol nodes in `b` and their indices in `symbols_`
+    std::vector<std::pair<const Basic *, unsigned>> symbol_nodes_;
+    std::vector<bool> dirty_;
+    std::vector<double> last_values_;
+    bool evaluated_ = false;
+
+public:
+    //! Throws SymEngineException if `b` has a symbol not in `symbols`
+    EvalPlan(const Basic &b, const vec_basic &symbols);
+    //! \return the value of `b` for the `values` of the symbols
+    double call(const std::vector<double> &values);
+};
+
 std::complex<double> eval_complex_double(const Basic &b);
 
 } // SymEngine
@@ -1,4 +1,7 @@
 #include <symengine/visitor.h>
+#include <symengine/polys/basic_conversions.h>
+
+#include <exception>
 
 namespace SymEngine
 {
@@ -19,17 +22,164 @@ inline void _imulnum(const Ptr<RCP<const Number>> &self,
     *self = _mulnum(*self, other);
 }
 
+/* Number of terms to reserve for the product of two sums with `m` and `n`
+ * terms. There are at most m*n distinct terms, but for large sums most of the
+ * products coincide (e.g. only 6272 out of 816*817 for the product of two
+ * dense polynomials of degree 15 in 4 variables), and reserving all of them
+ * spreads the few terms over a table that no longer fits into the cache. */
+inline std::size_t product_size_hint(std::size_t m, std::size_t n)
+{
+    return std::min(m * n, 4 * (m + n));
+}
+
+/* Checks if an expression is a polynomial with integer coefficients in its
+ * Symbols, built from Add, Mul and Pow with positive integer exponents only,
+ * and if it contains a product or power of a sum, so that expanding it does
+ * anything. Such expressions are expanded with MIntPoly arithmetic on
+ * exponent vectors and integer coefficients, which avoids creating all the
+ * intermediate products as Basic instances.
+ *
+ * The exponent vectors are dense, so for polynomials in many variables that
+ * are sparse (like the square of a sum of 100 symbols in expand6) the
+ * generic expansion is faster; they are left to ExpandVisitor. So are small
+ * expansions, whose result has less than `polynomial_expand_min_terms`
+ * terms at most, for which the conversions cost more than they save. */
+const std::size_t polynomial_expand_max_gens = 16;
+const double polynomial_expand_min_terms = 256;
+
+class PolynomialExpandVisitor : public BaseVisitor<PolynomialExpandVisitor>
+{
+private:
+    set_basic gens_;
+    bool is_poly_ = true;
+    bool has_product_ = false;
+    // Upper bound of the number of terms of the expanded node just visited
+    double terms_ = 1;
+
+    static bool is_positive_exp(const Basic &exp)
+    {
+        return is_a<Integer>(exp)
+               and static_cast<const Integer &>(exp).is_positive()
+               and mp_fits_slong_p(static_cast<const Integer &>(exp).i)
+               and mp_get_si(static_cast<const Integer &>(exp).i) <= INT_MAX;
+    }
+
+    static long exp_value(const Basic &exp)
+    {
+        return mp_get_si(static_cast<const Integer &>(exp).i);
+    }
+
+public:
+    /*! \return the expanded `b`, or a null RCP if `b` does not qualify for
+     *  the polynomial expansion */
+    RCP<const Basic> apply(const RCP<const Basic> &b)
+    {
+        b->accept(*this);
+        if (not is_poly_ or not has_product_
+            or gens_.size() > polynomial_expand_max_gens
+            or terms_ < polynomial_expand_min_terms)
+            return RCP<const Basic>();
+        return MIntPoly::from_container(gens_,
+                                        _basic_to_mpoly<MIntPoly>(b, gens_))
+            ->as_symbolic();
+    }
+
+    void bvisit(const Symbol &x)
+    {
+        gens_.insert(x.rcp_from_this());
+        terms_ = 1;
+    }
+
+    void bvisit(const Integer &x)
+    {
+        terms_ = 1;
+    }
+
+    void bvisit(const Add &x)
+    {
+        if (not is_a<Integer>(*x.coef_)) {
+            is_poly_ = false;
+            return;
+        }
+        double terms = x.coef_->is_zero() ? 0 : 1;
+        for (const auto &p : x.dict_) {
+            if (not is_a<Integer>(*p.second)) {
+                is_poly_ = false;
+                return;
+            }
+            p.first->accept(*this);
+            if (not is_poly_)
+                return;
+            terms += terms_;
+        }
+        terms_ = terms;
+    }
+
+    void bvisit(const Mul &x)
+    {
+        if (not is_a<Integer>(*x.coef_)) {
+            is_poly_ = false;
+            return;
+        }
+        double terms = 1;
+        for (const auto &p : x.dict_) {
+            if (not is_positive_exp(*p.second)) {
+                is_poly_ = false;
+                return;
+            }
+            if (is_a<Add>(*p.first))
+                has_product_ = true;
+            p.first->accept(*this);
+            if (not is_poly_)
+                return;
+            terms *= std::pow(terms_, exp_value(*p.second));
+        }
+        terms_ = terms;
+    }
+
+    void bvisit(const Pow &x)
+    {
+        if (not is_positive_exp(*x.get_exp())) {
+            is_poly_ = false;
+            return;
+        }
+        if (is_a<Add>(*x.get_base()))
+            has_product_ = true;
+        x.get_base()->accept(*this);
+        terms_ = std::pow(terms_, exp_value(*x.get_exp()));
+    }
+
+    void bvisit(const Basic &x)
+    {
+        is_poly_ = false;
+    }
+};
+
+/* Products of sums with fewer terms than this are always expanded on one
+ * thread, splitting them up costs more than it gains. */
+const std::size_t parallel_expand_threshold = 4096;
+
 class ExpandVisitor : public BaseVisitor<ExpandVisitor>
 {
 private:
     umap_basic_num d_;
     RCP<const Number> coeff = zero;
     RCP<const Number> multiply = one;
+    unsigned nthreads_;
 
 public:
+    ExpandVisitor(unsigned nthreads = 1) : nthreads_(nthreads)
+    {
+    }
+
     RCP<const Basic> apply(const Basic &b)
     {
         b.accept(*this);
+#if defined(HAVE_SYMENGINE_RESERVE)
+        // The reserve hints below are upper bounds, don't keep the unused
+        // slots in the resulting Add
+        d_.rehash(0);
+#endif
         return Add::from_dict(coeff, std::move(d_));
     }
 
@@ -61,8 +211,8 @@ public:
             if (!is_a<Symbol>(*p.first)) {
                 RCP<const Basic> a, b;
                 self.as_two_terms(outArg(a), outArg(b));
-                a = expand(a);
-                b = expand(b);
+                a = expand(a, nthreads_);
+                b = expand(b, nthreads_);
                 mul_expand_two(a, b);
                 return;
             }
@@ -74,55 +224,64 @@ public:
     {
         // Both a and b are assumed to be expanded
         if (is_a<Add>(*a) && is_a<Add>(*b)) {
+            const Add &a_add = static_cast<const Add &>(*a);
+            const Add &b_add = static_cast<const Add &>(*b);
             iaddnum(outArg(coeff),
-                    _mulnum(multiply,
-                            _mulnum(rcp_static_cast<const Add>(a)->coef_,
-                                    rcp_static_cast<const Add>(b)->coef_)));
+                    _mulnum(multiply, _mulnum(a_add.coef_, b_add.coef_)));
 // Improves (x+1)**3*(x+2)**3*...(x+350)**3 expansion from 0.97s to 0.93s:
 #if defined(HAVE_SYMENGINE_RESERVE)
-            d_.reserve(d_.size()
-                       + (rcp_static_cast<const Add>(a))->dict_.size()
-                             * (rcp_static_cast<const Add>(b))->dict_.size());
+            d_.reserve(d_.size() + product_size_hint(a_add.dict_.size(),
+                                                     b_add.dict_.size()));
 #endif
             // Expand dicts first:
-            for (auto &p : (rcp_static_cast<const Add>(a))->dict_) {
-                RCP<const Number> temp = _mulnum(p.second, multiply);
-                for (auto &q : (rcp_static_cast<const Add>(b))->dict_) {
-                    // The main bottleneck here is the mul(p.first, q.first)
-                    // command
-                    RCP<const Basic> term = mul(p.first, q.first);
-                    if (is_a_Number(*term)) {
-                        iaddnum(outArg(coeff),
-                                _mulnum(_mulnum(temp, q.second),
-                                        rcp_static_cast<const Number>(term)));
-                    } else {
-                        if (is_a<Mul>(*term)
-                            && !(rcp_static_cast<const Mul>(term)
-                                     ->coef_->is_one())) {
-                            // Tidy up things like {2x: 3} -> {x: 6}
-                            RCP<const Number> coef2
-                                = rcp_static_cast<const Mul>(term)->coef_;
-                            // We make a copy of the dict_:
-                            map_basic_basic d2
-                                = rcp_static_cast<const Mul>(term)->dict_;
-                            term = Mul::from_dict(one, std::move(d2));
-                            Add::dict_add_term(
-                                d_, _mulnum(_mulnum(temp, q.second), coef2),
-                                term);
-                        } else {
-                            Add::dict_add_term(d_, _mulnum(temp, q.second),
-                                               term);
+            if (nthreads_ > 1
+                and a_add.dict_.size() * b_add.dict_.size()
+                        >= parallel_expand_threshold) {
+                std::vector<const umap_basic_num::value_type *> terms;
+                terms.reserve(a_add.dict_.size());
+                for (auto &p : a_add.dict_)
+                    terms.push_back(&p);
+                long n = terms.size();
+                // An exception must not leave the parallel region, the
+                // first one is rethrown after it
+                std::exception_ptr error;
+#pragma omp parallel num_threads(nthreads_)
+                {
+                    // Each thread accumulates its share of the terms in its
+                    // own dictionary, they are merged at the end
+                    ExpandVisitor local;
+#pragma omp for schedule(dynamic)
+                    for (long i = 0; i < n; i++) {
+                        try {
+                            local.mul_expand_term(
+                                terms[i]->first,
+                                _mulnum(terms[i]->second, multiply), b_add);
+                        } catch (...) {
+#pragma omp critical
+                            if (not error)
+                                error = std::current_exception();
+                        }
+                    }
+#pragma omp critical
+                    {
+                        try {
+                            merge(local);
+                        } catch (...) {
+                            if (not error)
+                                error = std::current_exception();
                         }
                     }
                 }
-                Add::dict_add_term(
-                    d_, _mulnum(rcp_static_cast<const Add>(b)->coef_, temp),
-                    p.first);
+                if (error)
+                    std::rethrow_exception(error);
+            } else {
+                for (auto &p : a_add.dict_)
+                    mul_expand_term(p.first, _mulnum(p.second, multiply),
+                                    b_add);
             }
             // Handle the coefficient of "a":
-            RCP<const Number> temp
-                = _mulnum(rcp_static_cast<const Add>(a)->coef_, multiply);
-            for (auto &q : (rcp_static_cast<const Add>(b))->dict_) {
+            RCP<const Number> temp = _mulnum(a_add.coef_, multiply);
+            for (auto &q : b_add.dict_) {
                 Add::dict_add_term(d_, _mulnum(temp, q.second), q.first);
             }
             return;
@@ -178,6 +337,48 @@ public:
         _coef_dict_add_term(multiply, mul(a, b));
     }
 
+    // Adds the product of `temp*t` and `b`, where `t` is a term of an Add
+    void mul_expand_term(const RCP<const Basic> &t,
+                         const RCP<const Number> &temp, const Add &b)
+    {
+        for (auto &q : b.dict_) {
+            // The main bottleneck here is the mul(t, q.first) command
+            RCP<const Basic> term = mul(t, q.first);
+            if (is_a_Number(*term)) {
+                iaddnum(outArg(coeff),
+                        _mulnum(_mulnum(temp, q.second),
+                                rcp_static_cast<const Number>(term)));
+            } else {
+                if (is_a<Mul>(*term)
+                    && !(rcp_static_cast<const Mul>(term)->coef_->is_one())) {
+                    // Tidy up things like {2x: 3} -> {x: 6}
+                    RCP<const Number> coef2
+                        = rcp_static_cast<const Mul>(term)->coef_;
+                    // We make a copy of the dict_:
+                    map_basic_basic d2
+                        = rcp_static_cast<const Mul>(term)->dict_;
+                    term = Mul::from_dict(one, std::move(d2));
+                    Add::dict_add_term(
+                        d_, _mulnum(_mulnum(temp, q.second), coef2), term);
+                } else {
+                    Add::dict_add_term(d_, _mulnum(temp, q.second), term);
+                }
+            }
+        }
+        Add::dict_add_term(d_, _mulnum(b.coef_, temp), t);
+    }
+
+    // Adds the terms and the coefficient collected by `other`
+    void merge(const ExpandVisitor &other)
+    {
+#if defined(HAVE_SYMENGINE_RESERVE)
+        d_.reserve(d_.size() + other.d_.size());
+#endif
+        for (auto &p : other.d_)
+            Add::dict_add_term(d_, p.second, p.first);
+        iaddnum(outArg(coeff), other.coeff);
+    }
+
     void square_expand(umap_basic_num &base_dict)
     {
         long m = base_dict.size();
@@ -212,75 +413,117 @@ public:
 #if defined(HAVE_SYMENGINE_RESERVE)
         d_.reserve(d_.size() + 2 * r.size());
 #endif
-        for (auto &p : r) {
-            auto power = p.first.begin();
-            auto i2 = base_dict.begin();
-            map_basic_basic d;
-            RCP<const Number> overall_coeff = one;
-            for (; power != p.first.end(); ++power, ++i2) {
-                if (*power > 0) {
-                    RCP<const Integer> exp = integer(std::move(*power));
-                    RCP<const Basic> base = i2->first;
-                    if (is_a<Integer>(*base)) {
-                        _imulnum(outArg(overall_coeff),
-                                 rcp_static_cast<const Number>(
-                                     rcp_static_cast<const Integer>(base)
-                                         ->powint(*exp)));
-                    } else if (is_a<Symbol>(*base)) {
-                        Mul::dict_add_term(d, exp, base);
-                    } else {
-                        RCP<const Basic> exp2, t, tmp;
-                        tmp = pow(base, exp);
-                        if (is_a<Mul>(*tmp)) {
-                            for (auto &p :
-                                 (rcp_static_cast<const Mul>(tmp))->dict_) {
-                                Mul::dict_add_term_new(outArg(overall_coeff), d,
-                                                       p.second, p.first);
-                            }
-                            _imulnum(outArg(overall_coeff),
-                                     (rcp_static_cast<const Mul>(tmp))->coef_);
-                        } else if (is_a_Number(*tmp)) {
-                            _imulnum(outArg(overall_coeff),
-                                     rcp_static_cast<const Number>(tmp));
-                        } else {
-                            Mul::as_base_exp(tmp, outArg(exp2), outArg(t));
+        if (nthreads_ > 1 and r.size() * m >= parallel_expand_threshold) {
+            std::vector<const map_vec_mpz::value_type *> terms;
+            terms.reserve(r.size());
+            for (auto &p : r)
+                terms.push_back(&p);
+            long n = terms.size();
+            std::exception_ptr error;
+#pragma omp parallel num_threads(nthreads_)
+            {
+                ExpandVisitor local;
+                local.multiply = multiply;
+#pragma omp for schedule(dynamic)
+                for (long i = 0; i < n; i++) {
+                    try {
+                        local.pow_expand_term(base_dict, terms[i]->first,
+                                              terms[i]->second);
+                    } catch (...) {
+#pragma omp critical
+                        if (not error)
+                            error = std::current_exception();
+                    }
+                }
+#pragma omp critical
+                {
+                    try {
+                        merge(local);
+                    } catch (...) {
+                        if (not error)
+                            error = std::current_exception();
+                    }
+                }
+            }
+            if (error)
+                std::rethrow_exception(error);
+        } else {
+            for (auto &p : r)
+                pow_expand_term(base_dict, p.first, p.second);
+        }
+    }
+
+    // Adds the term of the multinomial expansion with the exponents `powers`
+    // (of the terms of `base_dict`) and the multinomial coefficient `c`
+    void pow_expand_term(const umap_basic_num &base_dict, const vec_int &powers,
+                         const integer_class &c)
+    {
+        auto power = powers.begin();
+        auto i2 = base_dict.begin();
+        map_basic_basic d;
+        RCP<const Number> overall_coeff = one;
+        for (; power != powers.end(); ++power, ++i2) {
+            if (*power > 0) {
+                RCP<const Integer> exp = integer(*power);
+                RCP<const Basic> base = i2->first;
+                if (is_a<Integer>(*base)) {
+                    _imulnum(outArg(overall_coeff),
+                             rcp_static_cast<const Number>(
+                                 rcp_static_cast<const Integer>(base)
+                                     ->powint(*exp)));
+                } else if (is_a<Symbol>(*base)) {
+                    Mul::dict_add_term(d, exp, base);
+                } else {
+                    RCP<const Basic> exp2, t, tmp;
+                    tmp = pow(base, exp);
+                    if (is_a<Mul>(*tmp)) {
+                        for (auto &p :
+                             (rcp_static_cast<const Mul>(tmp))->dict_) {
                             Mul::dict_add_term_new(outArg(overall_coeff), d,
-                                                   exp2, t);
+                                                   p.second, p.first);
                         }
-                    }
-                    if (!(i2->second->is_one())) {
                         _imulnum(outArg(overall_coeff),
-                                 pownum(i2->second,
-                                        rcp_static_cast<const Number>(exp)));
+                                 (rcp_static_cast<const Mul>(tmp))->coef_);
+                    } else if (is_a_Number(*tmp)) {
+                        _imulnum(outArg(overall_coeff),
+                                 rcp_static_cast<const Number>(tmp));
+                    } else {
+                        Mul::as_base_exp(tmp, outArg(exp2), outArg(t));
+                        Mul::dict_add_term_new(outArg(overall_coeff), d, exp2,
+                                               t);
                     }
                 }
-            }
-            RCP<const Basic> term = Mul::from_dict(overall_coeff, std::move(d));
-            RCP<const Number> coef2 = integer(p.second);
-            if (is_a_Number(*term)) {
-                iaddnum(outArg(coeff),
-                        _mulnum(_mulnum(multiply,
-                                        rcp_static_cast<const Number>(term)),
-                                coef2));
-            } else {
-                if (is_a<Mul>(*term)
-                    && !(rcp_static_cast<const Mul>(term)->coef_->is_one())) {
-                    // Tidy up things like {2x: 3} -> {x: 6}
-                    _imulnum(outArg(coef2),
-                             rcp_static_cast<const Mul>(term)->coef_);
-                    // We make a copy of the dict_:
-                    map_basic_basic d2
-                        = rcp_static_cast<const Mul>(term)->dict_;
-                    term = Mul::from_dict(one, std::move(d2));
+                if (!(i2->second->is_one())) {
+                    _imulnum(
+                        outArg(overall_coeff),
+                        pownum(i2->second, rcp_static_cast<const Number>(exp)));
                 }
-                Add::dict_add_term(d_, _mulnum(multiply, coef2), term);
             }
         }
+        RCP<const Basic> term = Mul::from_dict(overall_coeff, std::move(d));
+        RCP<const Number> coef2 = integer(c);
+        if (is_a_Number(*term)) {
+            iaddnum(outArg(coeff),
+                    _mulnum(
+                        _mulnum(multiply, rcp_static_cast<const Number>(term)),
+                        coef2));
+        } else {
+            if (is_a<Mul>(*term)
+                && !(rcp_static_cast<const Mul>(term)->coef_->is_one())) {
+                // Tidy up things like {2x: 3} -> {x: 6}
+                _imulnum(outArg(coef2),
+                         rcp_static_cast<const Mul>(term)->coef_);
+                // We make a copy of the dict_:
+                map_basic_basic d2 = rcp_static_cast<const Mul>(term)->dict_;
+                term = Mul::from_dict(one, std::move(d2));
+            }
+            Add::dict_add_term(d_, _mulnum(multiply, coef2), term);
+        }
     }
 
     void bvisit(const Pow &self)
     {
-        RCP<const Basic> _base = expand(self.get_base());
+        RCP<const Basic> _base = expand(self.get_base(), nthreads_);
         // TODO add all types of polys
         if (is_a<Integer>(*self.get_exp()) && is_a<UExprPoly>(*_base)) {
             unsigned long q
@@ -312,7 +555,8 @@ public:
                               ->as_integer_class();
         if (n < 0)
             return _coef_dict_add_term(
-                multiply, div(one, expand(pow(_base, integer(-n)))));
+                multiply,
+                div(one, expand(pow(_base, integer(-n)), nthreads_)));
         RCP<const Add> base = rcp_static_cast<const Add>(_base);
         umap_basic_num base_dict = base->dict_;
         if (!(base->coef_->is_zero())) {
@@ -349,8 +593,19 @@ public:
 //! Expands `self`
 RCP<const Basic> expand(const RCP<const Basic> &self)
 {
+    RCP<const Basic> r = PolynomialExpandVisitor().apply(self);
+    if (not r.is_null())
+        return r;
     ExpandVisitor v;
     return v.apply(*self);
 }
 
+RCP<const Basic> expand(const RCP<const Basic> &self, unsigned nthreads)
+{
+    if (nthreads <= 1)
+        return expand(self);
+    ExpandVisitor v(nthreads);
+    return v.apply(*self);
+}
+
 } // SymEngine
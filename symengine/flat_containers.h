@@ -0,0 +1,1124 @@
+/**
+ *  \file flat_containers.h
+ *  Small vector, the sorted flat containers built on top of it and an open
+ *  addressing hash map
+ *
+ **/
+
+#ifndef SYMENGINE_FLAT_CONTAINERS_H
+#define SYMENGINE_FLAT_CONTAINERS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <symengine/symengine_config.h>
+
+namespace SymEngine
+{
+
+/*! Vector that keeps up to `N` elements inline (without any heap
+    allocation) and only moves them to the heap once it grows larger.
+
+    Only the subset of the `std::vector` interface that the flat containers
+    need is implemented. As for `std::vector`, any insertion or removal
+    invalidates iterators (moving an inline small_vector does too).
+*/
+template <typename T, unsigned N>
+class small_vector
+{
+    static_assert(N > 0, "small_vector needs an inline capacity");
+
+public:
+    typedef T value_type;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef T *iterator;
+    typedef const T *const_iterator;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    small_vector() : begin_(inline_ptr()), size_(0), capacity_(N)
+    {
+    }
+    small_vector(const small_vector &other) : small_vector()
+    {
+        reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), begin_);
+        size_ = other.size_;
+    }
+    small_vector(small_vector &&other) SYMENGINE_NOEXCEPT : small_vector()
+    {
+        steal(other);
+    }
+    ~small_vector()
+    {
+        clear();
+        if (not is_inline())
+            ::operator delete(begin_);
+    }
+    small_vector &operator=(const small_vector &other)
+    {
+        if (this != &other) {
+            clear();
+            reserve(other.size_);
+            std::uninitialized_copy(other.begin(), other.end(), begin_);
+            size_ = other.size_;
+        }
+        return *this;
+    }
+    small_vector &operator=(small_vector &&other) SYMENGINE_NOEXCEPT
+    {
+        if (this != &other) {
+            clear();
+            if (not is_inline()) {
+                ::operator delete(begin_);
+                begin_ = inline_ptr();
+                capacity_ = N;
+            }
+            steal(other);
+        }
+        return *this;
+    }
+
+    iterator begin()
+    {
+        return begin_;
+    }
+    iterator end()
+    {
+        return begin_ + size_;
+    }
+    const_iterator begin() const
+    {
+        return begin_;
+    }
+    const_iterator end() const
+    {
+        return begin_ + size_;
+    }
+    size_type size() const
+    {
+        return size_;
+    }
+    size_type capacity() const
+    {
+        return capacity_;
+    }
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+    T &operator[](size_type i)
+    {
+        return begin_[i];
+    }
+    const T &operator[](size_type i) const
+    {
+        return begin_[i];
+    }
+    T &back()
+    {
+        return begin_[size_ - 1];
+    }
+    const T &back() const
+    {
+        return begin_[size_ - 1];
+    }
+
+    void reserve(size_type n)
+    {
+        if (n > capacity_)
+            reallocate(n);
+    }
+    void clear()
+    {
+        destroy(begin_, begin_ + size_);
+        size_ = 0;
+    }
+    template <typename... Args>
+    void emplace_back(Args &&... args)
+    {
+        if (size_ == capacity_) {
+            // `args` may refer to an element, so construct it first
+            T tmp(std::forward<Args>(args)...);
+            reallocate(2 * capacity_);
+            new (begin_ + size_) T(std::move(tmp));
+        } else {
+            new (begin_ + size_) T(std::forward<Args>(args)...);
+        }
+        size_++;
+    }
+    void push_back(const T &x)
+    {
+        emplace_back(x);
+    }
+    void push_back(T &&x)
+    {
+        emplace_back(std::move(x));
+    }
+    void pop_back()
+    {
+        size_--;
+        begin_[size_].~T();
+    }
+    //! Inserts `x` before `pos`, \return iterator to the new element
+    template <typename U>
+    iterator insert(const_iterator pos, U &&x)
+    {
+        size_type i = pos - begin_;
+        if (i == size_) {
+            emplace_back(std::forward<U>(x));
+            return begin_ + i;
+        }
+        T tmp(std::forward<U>(x));
+        emplace_back(std::move(back()));
+        std::move_backward(begin_ + i, begin_ + size_ - 2, begin_ + size_ - 1);
+        begin_[i] = std::move(tmp);
+        return begin_ + i;
+    }
+    //! \return iterator to the element following the erased one
+    iterator erase(const_iterator pos)
+    {
+        return erase(pos, pos + 1);
+    }
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        iterator f = begin_ + (first - begin_);
+        iterator l = begin_ + (last - begin_);
+        if (f != l) {
+            iterator new_end = std::move(l, end(), f);
+            destroy(new_end, end());
+            size_ -= l - f;
+        }
+        return f;
+    }
+    void swap(small_vector &other)
+    {
+        small_vector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+private:
+    T *inline_ptr()
+    {
+        return reinterpret_cast<T *>(&inline_);
+    }
+    const T *inline_ptr() const
+    {
+        return reinterpret_cast<const T *>(&inline_);
+    }
+    bool is_inline() const
+    {
+        return begin_ == inline_ptr();
+    }
+    static void destroy(T *first, T *last)
+    {
+        for (; first != last; ++first)
+            first->~T();
+    }
+    // Moves the elements to a heap buffer of `n` elements
+    void reallocate(size_type n)
+    {
+        T *p = static_cast<T *>(::operator new(n * sizeof(T)));
+        for (size_type i = 0; i < size_; i++) {
+            new (p + i) T(std::move(begin_[i]));
+            begin_[i].~T();
+        }
+        if (not is_inline())
+            ::operator delete(begin_);
+        begin_ = p;
+        capacity_ = n;
+    }
+    // Takes over the elements of `other`. `*this` must be empty and inline.
+    void steal(small_vector &other)
+    {
+        if (other.is_inline()) {
+            for (size_type i = 0; i < other.size_; i++)
+                new (begin_ + i) T(std::move(other.begin_[i]));
+            size_ = other.size_;
+            other.clear();
+        } else {
+            begin_ = other.begin_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.begin_ = other.inline_ptr();
+            other.size_ = 0;
+            other.capacity_ = N;
+        }
+    }
+
+    typename std::aligned_storage<N * sizeof(T), alignof(T)>::type inline_;
+    T *begin_;
+    size_type size_;
+    size_type capacity_;
+};
+
+/*! Associative container with the interface of `std::map`, which keeps its
+    elements sorted by key in a `small_vector`. Lookups are binary searches
+    over contiguous memory and small maps need no heap allocation at all,
+    at the price of O(n) insertion and removal. Unlike `std::map`, any
+    insertion or removal invalidates iterators and references.
+*/
+template <typename K, typename V, typename Compare, unsigned N = 4>
+class flat_map
+{
+public:
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef std::pair<K, V> value_type;
+    typedef Compare key_compare;
+    typedef small_vector<value_type, N> container_type;
+    typedef typename container_type::iterator iterator;
+    typedef typename container_type::const_iterator const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef std::size_t size_type;
+
+    // Restricts the insert() templates to arguments a value can be built from
+    template <typename U>
+    using enable_if_value_t = typename std::enable_if<
+        std::is_constructible<value_type, U>::value>::type;
+
+    flat_map()
+    {
+    }
+    flat_map(std::initializer_list<value_type> l)
+    {
+        insert(l.begin(), l.end());
+    }
+    template <typename It>
+    flat_map(It first, It last)
+    {
+        insert(first, last);
+    }
+
+    iterator begin()
+    {
+        return v_.begin();
+    }
+    iterator end()
+    {
+        return v_.end();
+    }
+    const_iterator begin() const
+    {
+        return v_.begin();
+    }
+    const_iterator end() const
+    {
+        return v_.end();
+    }
+    reverse_iterator rbegin()
+    {
+        return reverse_iterator(end());
+    }
+    reverse_iterator rend()
+    {
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rbegin() const
+    {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
+    }
+    size_type size() const
+    {
+        return v_.size();
+    }
+    bool empty() const
+    {
+        return v_.empty();
+    }
+    void clear()
+    {
+        v_.clear();
+    }
+    void reserve(size_type n)
+    {
+        v_.reserve(n);
+    }
+    void swap(flat_map &other)
+    {
+        v_.swap(other.v_);
+    }
+
+    iterator lower_bound(const K &k)
+    {
+        return std::lower_bound(v_.begin(), v_.end(), k, KeyLess());
+    }
+    const_iterator lower_bound(const K &k) const
+    {
+        return std::lower_bound(v_.begin(), v_.end(), k, KeyLess());
+    }
+    iterator find(const K &k)
+    {
+        iterator it = lower_bound(k);
+        if (it != end() and not Compare()(k, it->first))
+            return it;
+        return end();
+    }
+    const_iterator find(const K &k) const
+    {
+        const_iterator it = lower_bound(k);
+        if (it != end() and not Compare()(k, it->first))
+            return it;
+        return end();
+    }
+    size_type count(const K &k) const
+    {
+        return find(k) == end() ? 0 : 1;
+    }
+    V &at(const K &k)
+    {
+        iterator it = find(k);
+        if (it == end())
+            throw std::out_of_range("flat_map::at");
+        return it->second;
+    }
+    const V &at(const K &k) const
+    {
+        const_iterator it = find(k);
+        if (it == end())
+            throw std::out_of_range("flat_map::at");
+        return it->second;
+    }
+    V &operator[](const K &k)
+    {
+        iterator it = lower_bound(k);
+        if (it == end() or Compare()(k, it->first))
+            it = v_.insert(it, value_type(k, V()));
+        return it->second;
+    }
+
+    //! Inserts `x` unless its key is already present (like `std::map`)
+    template <typename P, typename = enable_if_value_t<P>>
+    std::pair<iterator, bool> insert(P &&x)
+    {
+        value_type p(std::forward<P>(x));
+        iterator it = lower_bound(p.first);
+        if (it != end() and not Compare()(p.first, it->first))
+            return std::make_pair(it, false);
+        return std::make_pair(v_.insert(it, std::move(p)), true);
+    }
+    std::pair<iterator, bool> insert(const value_type &x)
+    {
+        return insert<const value_type &>(x);
+    }
+    std::pair<iterator, bool> insert(value_type &&x)
+    {
+        return insert<value_type>(std::move(x));
+    }
+    //! The hint is ignored, it exists for `std::inserter`
+    template <typename P, typename = enable_if_value_t<P>>
+    iterator insert(const_iterator, P &&x)
+    {
+        return insert(std::forward<P>(x)).first;
+    }
+    template <typename It>
+    void insert(It first, It last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args &&... args)
+    {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return v_.erase(pos);
+    }
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        return v_.erase(first, last);
+    }
+    size_type erase(const K &k)
+    {
+        iterator it = find(k);
+        if (it == end())
+            return 0;
+        v_.erase(it);
+        return 1;
+    }
+
+private:
+    struct KeyLess {
+        bool operator()(const value_type &x, const K &k) const
+        {
+            return Compare()(x.first, k);
+        }
+    };
+
+    container_type v_;
+};
+
+/*! Sorted flat container with the interface of `std::set` (or
+    `std::multiset` if `Multi` is true), see `flat_map`. Elements can not be
+    modified through iterators.
+*/
+template <typename K, typename Compare, bool Multi = false, unsigned N = 4>
+class flat_set
+{
+public:
+    typedef K key_type;
+    typedef K value_type;
+    typedef Compare key_compare;
+    typedef Compare value_compare;
+    typedef small_vector<K, N> container_type;
+    typedef typename container_type::const_iterator iterator;
+    typedef typename container_type::const_iterator const_iterator;
+    typedef std::reverse_iterator<const_iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef std::size_t size_type;
+
+    // Restricts the insert() templates to arguments a value can be built from
+    template <typename U>
+    using enable_if_value_t = typename std::enable_if<
+        std::is_constructible<value_type, U>::value>::type;
+
+    flat_set()
+    {
+    }
+    flat_set(std::initializer_list<K> l)
+    {
+        insert(l.begin(), l.end());
+    }
+    template <typename It>
+    flat_set(It first, It last)
+    {
+        insert(first, last);
+    }
+
+    const_iterator begin() const
+    {
+        return v_.begin();
+    }
+    const_iterator end() const
+    {
+        return v_.end();
+    }
+    const_reverse_iterator rbegin() const
+    {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
+    }
+    size_type size() const
+    {
+        return v_.size();
+    }
+    bool empty() const
+    {
+        return v_.empty();
+    }
+    void clear()
+    {
+        v_.clear();
+    }
+    void reserve(size_type n)
+    {
+        v_.reserve(n);
+    }
+    void swap(flat_set &other)
+    {
+        v_.swap(other.v_);
+    }
+
+    const_iterator lower_bound(const K &k) const
+    {
+        return std::lower_bound(v_.begin(), v_.end(), k, Compare());
+    }
+    const_iterator upper_bound(const K &k) const
+    {
+        return std::upper_bound(v_.begin(), v_.end(), k, Compare());
+    }
+    std::pair<const_iterator, const_iterator> equal_range(const K &k) const
+    {
+        return std::equal_range(v_.begin(), v_.end(), k, Compare());
+    }
+    const_iterator find(const K &k) const
+    {
+        const_iterator it = lower_bound(k);
+        if (it != end() and not Compare()(k, *it))
+            return it;
+        return end();
+    }
+    size_type count(const K &k) const
+    {
+        std::pair<const_iterator, const_iterator> r = equal_range(k);
+        return r.second - r.first;
+    }
+
+    //! Inserts `x`; unless `Multi`, only if it is not present yet
+    template <typename U, typename = enable_if_value_t<U>>
+    std::pair<iterator, bool> insert(U &&x)
+    {
+        if (Multi) {
+            const_iterator it = upper_bound(x);
+            return std::make_pair(v_.insert(it, std::forward<U>(x)), true);
+        }
+        const_iterator it = lower_bound(x);
+        if (it != end() and not Compare()(x, *it))
+            return std::make_pair(it, false);
+        return std::make_pair(v_.insert(it, std::forward<U>(x)), true);
+    }
+    std::pair<iterator, bool> insert(const K &x)
+    {
+        return insert<const K &>(x);
+    }
+    std::pair<iterator, bool> insert(K &&x)
+    {
+        return insert<K>(std::move(x));
+    }
+    //! The hint is ignored, it exists for `std::inserter`
+    template <typename U, typename = enable_if_value_t<U>>
+    iterator insert(const_iterator, U &&x)
+    {
+        return insert(std::forward<U>(x)).first;
+    }
+    template <typename It>
+    void insert(It first, It last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args &&... args)
+    {
+        return insert(K(std::forward<Args>(args)...));
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return v_.erase(pos);
+    }
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        return v_.erase(first, last);
+    }
+    //! Removes all elements equal to `k`, \return their number
+    size_type erase(const K &k)
+    {
+        std::pair<const_iterator, const_iterator> r = equal_range(k);
+        v_.erase(r.first, r.second);
+        return r.second - r.first;
+    }
+
+private:
+    container_type v_;
+};
+
+template <typename K, typename Compare, unsigned N = 4>
+using flat_multiset = flat_set<K, Compare, true, N>;
+
+/*! Hash map with the interface of `std::unordered_map`, implemented as an
+    open addressing table with linear probing.
+
+    Keys and values are stored inline in one array of slots, together with
+    the (mixed) hash of the key, so that neither an insertion nor a lookup
+    allocates a node or has to dereference a key unless the full hashes
+    match. A separate array of one control byte per slot marks it as empty,
+    deleted, or holds the lowest 7 bits of the hash of its key, which is
+    all that is touched while probing. The table grows once it is 7/8 full.
+
+    Unlike `std::unordered_map`, an insertion that grows the table
+    invalidates references to the elements, not just iterators. Erasing
+    does not move any other element.
+*/
+template <typename K, typename V, typename Hash, typename KeyEqual>
+class flat_hash_map
+{
+public:
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef std::pair<K, V> value_type;
+    typedef Hash hasher;
+    typedef KeyEqual key_equal;
+    typedef std::size_t size_type;
+
+private:
+    typedef signed char ctrl_t;
+    // An enum rather than static constants, which would need a definition
+    // outside of the class when they are bound to a reference (std::fill)
+    enum : ctrl_t {
+        ctrl_empty = -128,
+        ctrl_deleted = -2,
+        // Stops iterations at the end of the control bytes
+        ctrl_sentinel = -1
+    };
+
+    struct Slot {
+        std::size_t hash;
+        value_type value;
+    };
+
+    template <bool Const>
+    class iterator_base
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef flat_hash_map::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<Const, const value_type *,
+                                          value_type *>::type pointer;
+        typedef typename std::conditional<Const, const value_type &,
+                                          value_type &>::type reference;
+
+        iterator_base() : ctrl_(nullptr), slot_(nullptr)
+        {
+        }
+        iterator_base(const iterator_base &) = default;
+        iterator_base &operator=(const iterator_base &) = default;
+        //! Conversion of an iterator to a const_iterator
+        template <bool C, typename = typename std::enable_if<Const
+                                                             and not C>::type>
+        iterator_base(const iterator_base<C> &other)
+            : ctrl_(other.ctrl_), slot_(other.slot_)
+        {
+        }
+        reference operator*() const
+        {
+            return slot_->value;
+        }
+        pointer operator->() const
+        {
+            return &slot_->value;
+        }
+        iterator_base &operator++()
+        {
+            ++ctrl_;
+            ++slot_;
+            skip_free();
+            return *this;
+        }
+        iterator_base operator++(int)
+        {
+            iterator_base tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        bool operator==(const iterator_base &other) const
+        {
+            return ctrl_ == other.ctrl_;
+        }
+        bool operator!=(const iterator_base &other) const
+        {
+            return ctrl_ != other.ctrl_;
+        }
+
+    private:
+        iterator_base(ctrl_t *ctrl, Slot *slot) : ctrl_(ctrl), slot_(slot)
+        {
+        }
+        void skip_free()
+        {
+            while (*ctrl_ == ctrl_empty or *ctrl_ == ctrl_deleted) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+
+        ctrl_t *ctrl_;
+        Slot *slot_;
+
+        friend class flat_hash_map;
+        friend class iterator_base<not Const>;
+    };
+
+public:
+    typedef iterator_base<false> iterator;
+    typedef iterator_base<true> const_iterator;
+
+    flat_hash_map()
+        : ctrl_(empty_ctrl()), slots_(nullptr), capacity_(0), size_(0),
+          growth_left_(0)
+    {
+    }
+    flat_hash_map(std::initializer_list<value_type> l) : flat_hash_map()
+    {
+        reserve(l.size());
+        insert(l.begin(), l.end());
+    }
+    template <typename It>
+    flat_hash_map(It first, It last)
+        : flat_hash_map()
+    {
+        insert(first, last);
+    }
+    flat_hash_map(const flat_hash_map &other) : flat_hash_map()
+    {
+        copy_from(other);
+    }
+    flat_hash_map(flat_hash_map &&other) SYMENGINE_NOEXCEPT : flat_hash_map()
+    {
+        swap(other);
+    }
+    ~flat_hash_map()
+    {
+        destroy_all();
+        deallocate();
+    }
+    flat_hash_map &operator=(const flat_hash_map &other)
+    {
+        if (this != &other) {
+            clear();
+            copy_from(other);
+        }
+        return *this;
+    }
+    flat_hash_map &operator=(flat_hash_map &&other) SYMENGINE_NOEXCEPT
+    {
+        swap(other);
+        return *this;
+    }
+    void swap(flat_hash_map &other)
+    {
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(slots_, other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+    }
+
+    iterator begin()
+    {
+        iterator it(ctrl_, slots_);
+        it.skip_free();
+        return it;
+    }
+    iterator end()
+    {
+        return iterator(ctrl_ + capacity_, slots_ + capacity_);
+    }
+    const_iterator begin() const
+    {
+        return const_cast<flat_hash_map *>(this)->begin();
+    }
+    const_iterator end() const
+    {
+        return const_cast<flat_hash_map *>(this)->end();
+    }
+    size_type size() const
+    {
+        return size_;
+    }
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+    size_type bucket_count() const
+    {
+        return capacity_;
+    }
+
+    void clear()
+    {
+        destroy_all();
+        if (capacity_ > 0)
+            std::fill(ctrl_, ctrl_ + capacity_, ctrl_empty);
+        size_ = 0;
+        growth_left_ = max_load(capacity_);
+    }
+    //! Makes room for `n` elements without growing the table again
+    void reserve(size_type n)
+    {
+        // Like std::unordered_map::reserve, this never shrinks the table
+        if (n <= size_)
+            return;
+        if (n > max_load(capacity_) or n - size_ > growth_left_)
+            resize(capacity_for(n));
+    }
+    //! Resizes the table to fit at least max(n, size()) elements; this also
+    //! shrinks it (e.g. `rehash(0)`)
+    void rehash(size_type n)
+    {
+        size_type c = capacity_for(std::max(n, size_));
+        if (c != capacity_ or growth_left_ + size_ < max_load(capacity_))
+            resize(c);
+    }
+
+    iterator find(const K &k)
+    {
+        if (size_ == 0)
+            return end();
+        return find(k, hash_of(k));
+    }
+    const_iterator find(const K &k) const
+    {
+        return const_cast<flat_hash_map *>(this)->find(k);
+    }
+    size_type count(const K &k) const
+    {
+        return find(k) == end() ? 0 : 1;
+    }
+    V &at(const K &k)
+    {
+        iterator it = find(k);
+        if (it == end())
+            throw std::out_of_range("flat_hash_map::at");
+        return it->second;
+    }
+    const V &at(const K &k) const
+    {
+        return const_cast<flat_hash_map *>(this)->at(k);
+    }
+    V &operator[](const K &k)
+    {
+        std::size_t h = hash_of(k);
+        iterator it = find(k, h);
+        if (it == end())
+            it = insert_new(h, value_type(k, V()));
+        return it->second;
+    }
+
+    //! Inserts `x` unless its key is already present
+    template <typename P, typename = typename std::enable_if<
+                  std::is_constructible<value_type, P>::value>::type>
+    std::pair<iterator, bool> insert(P &&x)
+    {
+        value_type p(std::forward<P>(x));
+        std::size_t h = hash_of(p.first);
+        iterator it = find(p.first, h);
+        if (it != end())
+            return std::make_pair(it, false);
+        return std::make_pair(insert_new(h, std::move(p)), true);
+    }
+    std::pair<iterator, bool> insert(const value_type &x)
+    {
+        return insert<const value_type &>(x);
+    }
+    std::pair<iterator, bool> insert(value_type &&x)
+    {
+        return insert<value_type>(std::move(x));
+    }
+    template <typename It>
+    void insert(It first, It last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args &&... args)
+    {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    //! \return iterator to the next element
+    iterator erase(const_iterator pos)
+    {
+        size_type i = pos.ctrl_ - ctrl_;
+        slots_[i].value.~value_type();
+        size_--;
+        // With linear probing a slot followed by an empty one is not part of
+        // any probe sequence that goes on, so it can become empty again
+        if (ctrl_[(i + 1) & (capacity_ - 1)] == ctrl_empty) {
+            ctrl_[i] = ctrl_empty;
+            growth_left_++;
+        } else {
+            ctrl_[i] = ctrl_deleted;
+        }
+        iterator it(ctrl_ + i, slots_ + i);
+        it.skip_free();
+        return it;
+    }
+    size_type erase(const K &k)
+    {
+        iterator it = find(k);
+        if (it == end())
+            return 0;
+        erase(it);
+        return 1;
+    }
+
+private:
+    static ctrl_t *empty_ctrl()
+    {
+        // Only ever read: a table without any slot is never written to
+        static ctrl_t sentinel = ctrl_sentinel;
+        return &sentinel;
+    }
+    static size_type max_load(size_type capacity)
+    {
+        return capacity - capacity / 8;
+    }
+    static size_type capacity_for(size_type n)
+    {
+        if (n == 0)
+            return 0;
+        size_type c = 8;
+        while (max_load(c) < n)
+            c *= 2;
+        return c;
+    }
+    static std::size_t hash_of(const K &k)
+    {
+        // The hashes of small integers are the integers themselves, mix them
+        // so that both the position and the control byte use all the bits
+        // The mixing is done in 64 bits, also where std::size_t is smaller
+        uint64_t h = static_cast<uint64_t>(Hash()(k));
+        h ^= h >> 32;
+        h *= 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 29;
+        return static_cast<std::size_t>(h);
+    }
+
+    iterator find(const K &k, std::size_t h)
+    {
+        if (capacity_ == 0)
+            return end();
+        size_type mask = capacity_ - 1;
+        for (size_type i = (h >> 7) & mask;; i = (i + 1) & mask) {
+            ctrl_t c = ctrl_[i];
+            if (c == ctrl_empty)
+                return end();
+            if (c == static_cast<ctrl_t>(h & 0x7F) and slots_[i].hash == h
+                and KeyEqual()(slots_[i].value.first, k))
+                return iterator(ctrl_ + i, slots_ + i);
+        }
+    }
+    // Index of the first empty or deleted slot of the probe sequence of `h`
+    size_type find_free(std::size_t h) const
+    {
+        size_type mask = capacity_ - 1;
+        size_type i = (h >> 7) & mask;
+        while (ctrl_[i] != ctrl_empty and ctrl_[i] != ctrl_deleted)
+            i = (i + 1) & mask;
+        return i;
+    }
+    // Inserts a value whose key is known not to be present
+    iterator insert_new(std::size_t h, value_type &&x)
+    {
+        size_type i = (capacity_ == 0) ? 0 : find_free(h);
+        if (capacity_ == 0 or (ctrl_[i] == ctrl_empty and growth_left_ == 0)) {
+            // Drop the tombstones if they take up much of the table,
+            // otherwise grow it
+            resize(size_ < max_load(capacity_) / 2
+                       ? capacity_for(size_ + 1)
+                       : capacity_for(2 * size_ + 1));
+            i = find_free(h);
+        }
+        if (ctrl_[i] == ctrl_empty)
+            growth_left_--;
+        new (&slots_[i].value) value_type(std::move(x));
+        slots_[i].hash = h;
+        ctrl_[i] = static_cast<ctrl_t>(h & 0x7F);
+        size_++;
+        return iterator(ctrl_ + i, slots_ + i);
+    }
+    void allocate(size_type capacity)
+    {
+        capacity_ = capacity;
+        growth_left_ = max_load(capacity);
+        if (capacity == 0) {
+            ctrl_ = empty_ctrl();
+            slots_ = nullptr;
+            return;
+        }
+        ctrl_ = static_cast<ctrl_t *>(::operator new(capacity + 1));
+        std::fill(ctrl_, ctrl_ + capacity, ctrl_empty);
+        ctrl_[capacity] = ctrl_sentinel;
+        slots_ = static_cast<Slot *>(::operator new(capacity * sizeof(Slot)));
+    }
+    void deallocate()
+    {
+        if (capacity_ > 0) {
+            ::operator delete(ctrl_);
+            ::operator delete(slots_);
+        }
+    }
+    void destroy_all()
+    {
+        for (size_type i = 0; i < capacity_; i++) {
+            if (ctrl_[i] >= 0)
+                slots_[i].value.~value_type();
+        }
+    }
+    void resize(size_type capacity)
+    {
+        ctrl_t *old_ctrl = ctrl_;
+        Slot *old_slots = slots_;
+        size_type old_capacity = capacity_;
+        allocate(capacity);
+        for (size_type i = 0; i < old_capacity; i++) {
+            if (old_ctrl[i] >= 0) {
+                size_type j = find_free(old_slots[i].hash);
+                new (&slots_[j].value)
+                    value_type(std::move(old_slots[i].value));
+                slots_[j].hash = old_slots[i].hash;
+                ctrl_[j] = old_ctrl[i];
+                old_slots[i].value.~value_type();
+            }
+        }
+        growth_left_ -= size_;
+        if (old_capacity > 0) {
+            ::operator delete(old_ctrl);
+            ::operator delete(old_slots);
+        }
+    }
+    void copy_from(const flat_hash_map &other)
+    {
+        reserve(other.size_);
+        for (const_iterator it = other.begin(); it != other.end(); ++it) {
+            size_type j = find_free(it.slot_->hash);
+            new (&slots_[j].value) value_type(it.slot_->value);
+            slots_[j].hash = it.slot_->hash;
+            ctrl_[j] = *it.ctrl_;
+            growth_left_--;
+            size_++;
+        }
+    }
+
+    ctrl_t *ctrl_;
+    Slot *slots_;
+    size_type capacity_;
+    size_type size_;
+    size_type growth_left_;
+};
+
+template <typename K, typename V, typename C, unsigned N>
+inline bool operator==(const flat_map<K, V, C, N> &a,
+                       const flat_map<K, V, C, N> &b)
+{
+    return a.size() == b.size() and std::equal(a.begin(), a.end(), b.begin());
+}
+
+template <typename K, typename V, typename C, unsigned N>
+inline bool operator!=(const flat_map<K, V, C, N> &a,
+                       const flat_map<K, V, C, N> &b)
+{
+    return not(a == b);
+}
+
+template <typename K, typename C, bool M, unsigned N>
+inline bool operator==(const flat_set<K, C, M, N> &a,
+                       const flat_set<K, C, M, N> &b)
+{
+    return a.size() == b.size() and std::equal(a.begin(), a.end(), b.begin());
+}
+
+template <typename K, typename C, bool M, unsigned N>
+inline bool operator!=(const flat_set<K, C, M, N> &a,
+                       const flat_set<K, C, M, N> &b)
+{
+    return not(a == b);
+}
+
+} // SymEngine
+
+#endif
@@ -5,6 +5,22 @@
 namespace SymEngine
 {
 
+const RCP<const Integer> *integer_cache()
+{
+    // Created on first use, since `integer()` is already called during the
+    // static initialization of other translation units (e.g. constants.cpp)
+    static const RCP<const Integer> *cache = []() {
+        RCP<const Integer> *c
+            = new RCP<const Integer>[integer_cache_max - integer_cache_min + 1];
+        for (long i = integer_cache_min; i <= integer_cache_max; i++) {
+            c[i - integer_cache_min]
+                = make_rcp<const Integer>(integer_class(i));
+        }
+        return c;
+    }();
+    return cache;
+}
+
 hash_t Integer::__hash__() const
 {
     // only the least significant bits that fit into "long long int" are
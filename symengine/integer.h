@@ -7,12 +7,98 @@
 #ifndef SYMENGINE_INTEGER_H
 #define SYMENGINE_INTEGER_H
 
+#include <climits>
+
 #include <symengine/number.h>
 #include <symengine/symengine_exception.h>
 
+#if defined(__clang__)
+#if __has_builtin(__builtin_add_overflow)
+#define SYMENGINE_BUILTIN_OVERFLOW
+#endif
+#elif defined(__GNUC__) && __GNUC__ >= 5
+#define SYMENGINE_BUILTIN_OVERFLOW
+#endif
+
 namespace SymEngine
 {
 
+/* Overflow checked machine word arithmetic. Integer uses it to return the
+ * results in the `integer_cache()` range without any `integer_class`
+ * arithmetic, Rational for small numerators and denominators. Each function
+ * stores the result in `r` and returns false if it overflowed (`r` is
+ * unspecified then).
+ */
+inline bool checked_add(long a, long b, long &r)
+{
+#if defined(SYMENGINE_BUILTIN_OVERFLOW)
+    return not __builtin_add_overflow(a, b, &r);
+#else
+    if ((b > 0 and a > LONG_MAX - b) or (b < 0 and a < LONG_MIN - b))
+        return false;
+    r = a + b;
+    return true;
+#endif
+}
+
+inline bool checked_sub(long a, long b, long &r)
+{
+#if defined(SYMENGINE_BUILTIN_OVERFLOW)
+    return not __builtin_sub_overflow(a, b, &r);
+#else
+    if ((b < 0 and a > LONG_MAX + b) or (b > 0 and a < LONG_MIN + b))
+        return false;
+    r = a - b;
+    return true;
+#endif
+}
+
+inline bool checked_mul(long a, long b, long &r)
+{
+#if defined(SYMENGINE_BUILTIN_OVERFLOW)
+    return not __builtin_mul_overflow(a, b, &r);
+#else
+    if (a > 0) {
+        if ((b > 0 and a > LONG_MAX / b) or (b < 0 and b < LONG_MIN / a))
+            return false;
+    } else if (a < 0) {
+        if ((b > 0 and a < LONG_MIN / b) or (b < 0 and a < LONG_MAX / b))
+            return false;
+    }
+    r = a * b;
+    return true;
+#endif
+}
+
+//! Computes `r = a**n` by repeated squaring
+inline bool checked_pow(long a, unsigned long n, long &r)
+{
+    long b = a;
+    r = 1;
+    while (true) {
+        if (n & 1) {
+            if (not checked_mul(r, b, r))
+                return false;
+        }
+        n >>= 1;
+        if (n == 0)
+            return true;
+        if (not checked_mul(b, b, b))
+            return false;
+    }
+}
+
+class Integer;
+
+//! Integers in [integer_cache_min, integer_cache_max] are cached
+const long integer_cache_min = -1024;
+const long integer_cache_max = 1024;
+/*! \return the preallocated instances of all integers in
+ *  [integer_cache_min, integer_cache_max], indexed by `i - integer_cache_min`.
+ *  They are created on the first call and never freed.
+ * */
+const RCP<const Integer> *integer_cache();
+
 //! Integer Class
 class Integer : public Number
 {
@@ -72,20 +158,61 @@ public:
         return this->i < 0u;
     }
 
+    //! \return `true` if the Integer with the value `i` is cached
+    static inline bool is_cached(long i)
+    {
+        return i >= integer_cache_min and i <= integer_cache_max;
+    }
+
+    /*! \return Integer with the value `i`. Small values are taken from
+     * `integer_cache()` instead of being allocated.
+     * */
+    static inline RCP<const Integer> from_long(long i)
+    {
+        if (is_cached(i))
+            return integer_cache()[i - integer_cache_min];
+        return make_rcp<const Integer>(integer_class(i));
+    }
+
+    /*! \return `true` and sets `r` to the value if it fits into a `long`.
+     * The methods below use it to compute small results on machine words
+     * and return them from `integer_cache()`. All other results are
+     * computed and stored as `integer_class`, as before.
+     * */
+    inline bool get_si(long &r) const
+    {
+        if (not mp_fits_slong_p(this->i))
+            return false;
+        r = mp_get_si(this->i);
+        return true;
+    }
+
     /* These are very fast methods for add/sub/mul/div/pow on Integers only */
     //! Fast Integer Addition
     inline RCP<const Integer> addint(const Integer &other) const
     {
+        long a, b, r;
+        if (get_si(a) and other.get_si(b) and checked_add(a, b, r)
+            and is_cached(r))
+            return from_long(r);
         return make_rcp<const Integer>(this->i + other.i);
     }
     //! Fast Integer Subtraction
     inline RCP<const Integer> subint(const Integer &other) const
     {
+        long a, b, r;
+        if (get_si(a) and other.get_si(b) and checked_sub(a, b, r)
+            and is_cached(r))
+            return from_long(r);
         return make_rcp<const Integer>(this->i - other.i);
     }
     //! Fast Integer Multiplication
     inline RCP<const Integer> mulint(const Integer &other) const
     {
+        long a, b, r;
+        if (get_si(a) and other.get_si(b) and checked_mul(a, b, r)
+            and is_cached(r))
+            return from_long(r);
         return make_rcp<const Integer>(this->i * other.i);
     }
     //!  Integer Division
@@ -102,13 +229,20 @@ public:
             else
                 return pow_negint(other);
         }
+        unsigned long n = mp_get_ui(other.i);
+        long a, r;
+        if (get_si(a) and checked_pow(a, n, r) and is_cached(r))
+            return from_long(r);
         integer_class tmp;
-        mp_pow_ui(tmp, i, mp_get_ui(other.i));
+        mp_pow_ui(tmp, i, n);
         return make_rcp<const Integer>(std::move(tmp));
     }
     //! \return negative of self.
     inline RCP<const Integer> neg() const
     {
+        long a;
+        if (get_si(a) and is_cached(a))
+            return from_long(-a);
         return make_rcp<const Integer>(-i);
     }
 
@@ -184,18 +318,38 @@ struct RCPIntegerKeyLess {
         return a->as_integer_class() < b->as_integer_class();
     }
 };
-//! \return RCP<const Integer> from integral values
+//! \return RCP<const Integer> from signed integral values
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value
+                                   and std::is_signed<T>::value,
+                               RCP<const Integer>>::type
+integer(T i)
+{
+    if (i >= integer_cache_min and i <= integer_cache_max)
+        return integer_cache()[static_cast<long>(i) - integer_cache_min];
+    return make_rcp<const Integer>(integer_class(i));
+}
+
+//! \return RCP<const Integer> from unsigned integral values
 template <typename T>
-inline typename std::enable_if<std::is_integral<T>::value,
+inline typename std::enable_if<std::is_integral<T>::value
+                                   and std::is_unsigned<T>::value,
                                RCP<const Integer>>::type
 integer(T i)
 {
+    if (i <= static_cast<unsigned long>(integer_cache_max))
+        return integer_cache()[static_cast<long>(i) - integer_cache_min];
     return make_rcp<const Integer>(integer_class(i));
 }
 
 //! \return RCP<const Integer> from integer_class
 inline RCP<const Integer> integer(integer_class i)
 {
+    if (mp_fits_slong_p(i)) {
+        long j = mp_get_si(i);
+        if (j >= integer_cache_min and j <= integer_cache_max)
+            return integer_cache()[j - integer_cache_min];
+    }
     return make_rcp<const Integer>(std::move(i));
 }
 
@@ -3,6 +3,7 @@
 
 #include <symengine/visitor.h>
 #include <symengine/eval_double.h>
+#include <symengine/derivative.h>
 #include <symengine/symengine_exception.h>
 
 namespace SymEngine
@@ -24,21 +25,65 @@ protected:
     std::vector<fn> results;
     fn result_;
     vec_basic symbols;
+    // The common subexpressions found by `cse()` are evaluated first, into
+    // the slots following the inputs of the buffer passed to the functions.
+    // Their symbols follow the input symbols in `symbols`.
+    std::vector<fn> cse_intermediate_fns;
+    std::size_t n_inputs = 0;
+    // The buffer of the calls with intermediates, sized by init()
+    std::vector<T> buffer;
+
+    void call_intermediates(T *x)
+    {
+        for (unsigned i = 0; i < cse_intermediate_fns.size(); ++i) {
+            x[n_inputs + i] = cse_intermediate_fns[i](x);
+        }
+    }
 
 public:
-    void init(const vec_basic &x, const Basic &b)
+    void init(const vec_basic &x, const Basic &b, bool cse = true)
     {
-        symbols = x;
-        apply(b);
+        init(x, {b.rcp_from_this()}, cse);
     }
 
-    void init(const vec_basic &inputs, const vec_basic &outputs)
+    /*! Compiles `outputs`. With `cse`, their common subexpressions are
+     *  evaluated once per call and shared.
+     * */
+    void init(const vec_basic &inputs, const vec_basic &outputs,
+              bool cse = true)
     {
         symbols = inputs;
-        for (auto &p : outputs) {
-            apply(*p);
-            results.push_back(result_);
+        n_inputs = inputs.size();
+        results.clear();
+        cse_intermediate_fns.clear();
+        if (cse) {
+            vec_pair replacements;
+            vec_basic reduced_exprs;
+            SymEngine::cse(replacements, reduced_exprs, outputs);
+            for (auto &r : replacements) {
+                cse_intermediate_fns.push_back(apply(*r.second));
+                symbols.push_back(r.first);
+            }
+            for (auto &p : reduced_exprs) {
+                results.push_back(apply(*p));
+            }
+        } else {
+            for (auto &p : outputs) {
+                results.push_back(apply(*p));
+            }
         }
+        buffer.assign(symbols.size(), T());
+    }
+
+    /*! Compiles the gradient of `f` w.r.t. `inputs`, built by `gradient()`.
+     *  The outputs are the partial derivatives in the order of `inputs`,
+     *  preceded by the value of `f` if `with_value` is set.
+     * */
+    void init_gradient(const vec_basic &inputs, const Basic &f,
+                       bool with_value = false, bool cse = true)
+    {
+        init(inputs, gradient_outputs(f.rcp_from_this(), inputs, with_value),
+             cse);
     }
 
     fn apply(const Basic &b)
@@ -49,13 +94,42 @@ public:
 
     T call(const std::vector<T> &vec)
     {
-        return result_(vec.data());
+        if (cse_intermediate_fns.empty())
+            return result_(vec.data());
+        std::copy(vec.begin(), vec.begin() + n_inputs, buffer.begin());
+        call_intermediates(buffer.data());
+        return result_(buffer.data());
     }
 
     void call(T *outs, const T *inps)
     {
+        if (cse_intermediate_fns.empty()) {
+            for (unsigned i = 0; i < results.size(); ++i) {
+                outs[i] = results[i](inps);
+            }
+            return;
+        }
+        std::copy(inps, inps + n_inputs, buffer.begin());
+        call_intermediates(buffer.data());
         for (unsigned i = 0; i < results.size(); ++i) {
-            outs[i] = results[i](inps);
+            outs[i] = results[i](buffer.data());
+        }
+    }
+
+    /*! Evaluates all outputs at `n` points. The inputs are stored by symbol,
+     *  `inps[j * n + i]` is the value of the j-th symbol at the i-th point,
+     *  and the outputs the same way, `outs[k * n + i]`.
+     * */
+    void call_batch(T *outs, const T *inps, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < n_inputs; ++j) {
+                buffer[j] = inps[j * n + i];
+            }
+            call_intermediates(buffer.data());
+            for (std::size_t k = 0; k < results.size(); ++k) {
+                outs[k * n + i] = results[k](buffer.data());
+            }
         }
     }
 
@@ -142,7 +216,16 @@ public:
 
     void bvisit(const Symbol &x)
     {
-        for (unsigned i = 0; i < symbols.size(); ++i) {
+        // The symbols of the replacements come first, as an input that
+        // isn't used by the outputs may have the same name
+        for (std::size_t j = 0; j + n_inputs < symbols.size(); ++j) {
+            if (eq(x, *symbols[j + n_inputs])) {
+                const std::size_t k = j + n_inputs;
+                result_ = [=](const T *x) { return x[k]; };
+                return;
+            }
+        }
+        for (unsigned i = 0; i < n_inputs; ++i) {
             if (eq(x, *symbols[i])) {
                 result_ = [=](const T *x) { return x[i]; };
                 return;
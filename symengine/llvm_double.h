@@ -3,6 +3,9 @@
 
 #include <symengine/basic.h>
 #include <symengine/visitor.h>
+#include <symengine/eval_double.h>
+#include <symengine/derivative.h>
+#include <symengine/printer.h>
 
 #ifdef HAVE_SYMENGINE_LLVM
 // byte_swap is a macro defined in flint and it conflicts with LLVM's definition
@@ -13,6 +16,7 @@
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/IR/Argument.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Constants.h"
@@ -25,10 +29,17 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
+#include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Transforms/Vectorize.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/IR/Verifier.h"
@@ -37,26 +48,201 @@
 #include "llvm/Transforms/Scalar.h"
 #include <algorithm>
 #include <cassert>
+#include <complex>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 #include <memory>
+#include <typeinfo>
 #include <vector>
 
-#if LLVM_VERSION_MAJOR == 3 && LLVM_VERSION_MINOR >= 9
+#if LLVM_VERSION_MAJOR > 3 || LLVM_VERSION_MINOR >= 9
 #include <llvm/Transforms/Scalar/GVN.h>
 #endif
+#if LLVM_VERSION_MAJOR >= 4
+#include <llvm/Transforms/InstCombine/InstCombine.h>
+#endif
 
 namespace SymEngine
 {
 
-class LLVMDoubleVisitor : public BaseVisitor<LLVMDoubleVisitor>
+/*! Prints the expressions of the key of an LLVMObjectCache. The doubles are
+ *  printed with all their digits, so that different ones never share code.
+ * */
+class LLVMCacheKeyPrinter : public BaseVisitor<LLVMCacheKeyPrinter, StrPrinter>
+{
+public:
+    using StrPrinter::bvisit;
+
+    void bvisit(const RealDouble &x)
+    {
+        std::ostringstream s;
+        s << std::setprecision(std::numeric_limits<double>::max_digits10)
+          << x.i;
+        str_ = s.str();
+    }
+
+    void bvisit(const ComplexDouble &x)
+    {
+        std::ostringstream s;
+        s << std::setprecision(std::numeric_limits<double>::max_digits10)
+          << "(" << x.i.real() << " + " << x.i.imag() << "*I)";
+        str_ = s.str();
+    }
+};
+
+/*! Stores the object code compiled by the JIT in the directory `dir`, and
+ *  hands it back to the JIT instead of compiling the module when it was
+ *  stored before for the same `key`.
+ *
+ *  The files are named after the MD5 hash of `key`, the object code in
+ *  `<hash>.o` and the key itself in `<hash>.key`. The key is compared before
+ *  the object is used, so that a collision of the hashes is only a miss.
+ * */
+class LLVMObjectCache : public llvm::ObjectCache
+{
+    std::string key_;
+    std::string path_;
+    std::unique_ptr<llvm::MemoryBuffer> object_;
+
+public:
+    LLVMObjectCache(const std::string &dir, const std::string &key) : key_(key)
+    {
+        llvm::MD5 md5;
+        md5.update(key);
+        llvm::MD5::MD5Result result;
+        md5.final(result);
+        llvm::SmallString<32> hash;
+        llvm::MD5::stringifyResult(result, hash);
+        path_ = dir + "/" + std::string(hash.str());
+    }
+
+    /*! Reads the object code for the key, which `getObject()` then hands
+     *  to the JIT. \return false if it is not in the cache or is not an
+     *  object file
+     * */
+    bool load()
+    {
+        object_.reset();
+        auto key = llvm::MemoryBuffer::getFile(path_ + ".key");
+        if (not key or (*key)->getBuffer() != key_)
+            return false;
+        auto buffer = llvm::MemoryBuffer::getFile(path_ + ".o");
+        if (not buffer)
+            return false;
+        // The JIT aborts on a file it cannot read
+        auto object = llvm::object::ObjectFile::createObjectFile(
+            (*buffer)->getMemBufferRef());
+        if (not object) {
+            llvm::consumeError(object.takeError());
+            return false;
+        }
+        object_ = std::move(*buffer);
+        return true;
+    }
+
+    void notifyObjectCompiled(const llvm::Module *M,
+                              llvm::MemoryBufferRef obj) override
+    {
+        // The key is written last, an object is never used before its key
+        // is complete
+        if (write_file(path_ + ".o", obj.getBuffer())) {
+            write_file(path_ + ".key", key_);
+        }
+    }
+
+    //! \return the object code read by `load()`, nullptr if there is none
+    std::unique_ptr<llvm::MemoryBuffer>
+    getObject(const llvm::Module *M) override
+    {
+        return std::move(object_);
+    }
+
+private:
+    //! Writes `data` to `path` atomically. \return false on failure
+    static bool write_file(const std::string &path, llvm::StringRef data)
+    {
+        // Write to a temporary file first, so that a process that runs
+        // at the same time never reads an incomplete file
+        int fd;
+        llvm::SmallString<128> tmp;
+        if (llvm::sys::fs::createUniqueFile(path + "-%%%%%%.tmp", fd, tmp))
+            return false;
+        {
+            llvm::raw_fd_ostream os(fd, true);
+            os << data;
+        }
+        if (llvm::sys::fs::rename(tmp, path)) {
+            llvm::sys::fs::remove(tmp);
+            return false;
+        }
+        return true;
+    }
+};
+
+//! Options of the code generated by the LLVM visitors
+struct LLVMOptions {
+    //! Optimization level from 0 to 3 of the IR passes and the code generator
+    unsigned opt_level = 3;
+    /*! Enables all fast-math flags: reassociation, reciprocals and the
+     *  assumption that there are no NaNs, infinities or signed zeros.
+     * */
+    bool fast_math = false;
+    //! Allows contracting `a * b + c` into a fused multiply-add
+    bool fp_contract = false;
+    //! The CPU to generate code for, the host CPU if empty
+    std::string cpu;
+    //! Target features to enable or disable, like "+avx2" or "-fma"
+    std::vector<std::string> features;
+    /*! Calls the elementary functions through LLVM intrinsics, which the
+     *  optimizer knows about, instead of calling the functions of libm.
+     * */
+    bool intrinsics = true;
+};
+
+/*! Base of the visitors that compile expressions with LLVM.
+ *
+ * `init()` generates two functions, `void f(const T *inps, T *outs)` that
+ * evaluates the outputs at a point and the batch function
+ * `void f(const T *inps, T *outs, size_t n)` that evaluates them at `n`
+ * points, where `T` is `get_float_type()`. The derived classes generate the
+ * code of the nodes and cast the functions to the types of their `call()`
+ * methods.
+ * */
+class LLVMVisitor : public Visitor
 {
 protected:
     std::unique_ptr<llvm::LLVMContext> context;
     std::unique_ptr<llvm::IRBuilder<>> builder;
     std::unique_ptr<llvm::Module> module;
     vec_basic symbols;
+    //! The symbols of the replacements found by `cse()` follow the inputs
+    std::size_t n_inputs;
     std::vector<llvm::Value *> symbol_ptrs;
     llvm::Value *result_;
     intptr_t func;
+    intptr_t func_batch;
+    std::string cache_dir;
+    std::unique_ptr<LLVMObjectCache> object_cache;
+    LLVMOptions options;
+
+    //! The floating point type of the inputs and outputs
+    virtual llvm::Type *get_float_type() = 0;
+
+    //! \return the value with the index `index` in the array `ptr`
+    virtual llvm::Value *load_value(llvm::Value *ptr, llvm::Value *index)
+    {
+        auto p = builder->CreateGEP(get_float_type(), ptr, index);
+        return builder->CreateLoad(get_float_type(), p);
+    }
+
+    //! Stores `value` at the index `index` in the array `ptr`
+    virtual void store_value(llvm::Value *value, llvm::Value *ptr,
+                             llvm::Value *index)
+    {
+        auto p = builder->CreateGEP(get_float_type(), ptr, index);
+        builder->CreateStore(value, p);
+    }
 
 public:
     llvm::Value *apply(const Basic &b)
@@ -65,87 +251,270 @@ public:
         return result_;
     }
 
-    void init(const vec_basic &x, const Basic &b)
+    /*! Generates IR for the replacements found by `cse()` (whose symbols
+     *  are added to `symbols`) and then for the `outputs`, once the inputs
+     *  are in `symbol_ptrs`.
+     * */
+    std::vector<llvm::Value *> apply_outputs(const vec_basic &inputs,
+                                             const vec_pair &replacements,
+                                             const vec_basic &outputs)
+    {
+        symbols = inputs;
+        for (auto &r : replacements) {
+            llvm::Value *v = apply(*r.second);
+            symbols.push_back(r.first);
+            symbol_ptrs.push_back(v);
+        }
+        std::vector<llvm::Value *> output_vals;
+        for (auto &p : outputs) {
+            output_vals.push_back(apply(*p));
+        }
+        return output_vals;
+    }
+
+    void init(const vec_basic &x, const Basic &b, bool cse = true)
     {
-        init(x, {b.rcp_from_this()});
+        init(x, {b.rcp_from_this()}, cse);
     }
 
-    void init(const vec_basic &inputs, const vec_basic &outputs)
+    /*! Compiles `outputs`. With `cse`, their common subexpressions are
+     *  computed once and shared, instead of relying on GVN to find them.
+     *
+     *  If a cache directory is set, the object code is loaded from it
+     *  instead when `outputs` were compiled before for the same CPU.
+     * */
+    void init(const vec_basic &inputs, const vec_basic &outputs,
+              bool cse = true)
     {
         llvm::InitializeNativeTarget();
         llvm::InitializeNativeTargetAsmPrinter();
         llvm::InitializeNativeTargetAsmParser();
-        context = llvm::make_unique<llvm::LLVMContext>();
-        symbols = inputs;
+        context.reset(new llvm::LLVMContext());
+
+        // Generate code for the host CPU by default, so that the loop of the
+        // batch function is vectorized with its widest vector instructions
+        std::string cpu = options.cpu;
+        if (cpu.empty()) {
+            cpu = llvm::sys::getHostCPUName().str();
+        }
+        llvm::TargetOptions target_options;
+        if (options.fast_math) {
+            target_options.UnsafeFPMath = true;
+            target_options.NoInfsFPMath = true;
+            target_options.NoNaNsFPMath = true;
+        }
+        if (options.fast_math or options.fp_contract) {
+            target_options.AllowFPOpFusion = llvm::FPOpFusion::Fast;
+        }
+        std::unique_ptr<llvm::TargetMachine> tm(
+            llvm::EngineBuilder()
+                .setMCPU(cpu)
+                .setMAttrs(options.features)
+                .setTargetOptions(target_options)
+                .selectTarget());
+
+        object_cache.reset();
+        if (not cache_dir.empty()) {
+            object_cache.reset(new LLVMObjectCache(
+                cache_dir, cache_key(inputs, outputs, cse, cpu)));
+        }
+        // The functions are not generated when the object code was read from
+        // the cache, the JIT then only loads it
+        bool cached = object_cache and object_cache->load();
+        create_module(*tm);
+        if (not cached) {
+            generate(inputs, outputs, cse, *tm);
+        }
+        create_engine(cpu, target_options);
+        if (cached and (func == 0 or func_batch == 0)) {
+            // The cached object lacks the functions, compile them instead,
+            // which also replaces it in the cache
+            create_module(*tm);
+            generate(inputs, outputs, cse, *tm);
+            create_engine(cpu, target_options);
+        }
+        if (func == 0 or func_batch == 0) {
+            throw SymEngineException("LLVM failed to compile the functions");
+        }
+    }
+
+    /*! Compiles the gradient of `f` w.r.t. `inputs`, built by `gradient()`.
+     *  The outputs are the partial derivatives in the order of `inputs`,
+     *  preceded by the value of `f` if `with_value` is set.
+     * */
+    void init_gradient(const vec_basic &inputs, const Basic &f,
+                       bool with_value = false, bool cse = true)
+    {
+        init(inputs, gradient_outputs(f.rcp_from_this(), inputs, with_value),
+             cse);
+    }
+
+    /*! Sets the directory in which the object code of the compiled functions
+     *  is stored by `init()`, which is created if necessary. An empty `dir`,
+     *  the default, disables the cache. The entries are not removed and
+     *  should be deleted after an update of SymEngine.
+     * */
+    void set_cache_dir(const std::string &dir)
+    {
+        if (not dir.empty()) {
+            llvm::sys::fs::create_directories(dir);
+        }
+        cache_dir = dir;
+    }
+
+    //! Sets the options used by the following calls of `init()`
+    void set_options(const LLVMOptions &opts)
+    {
+        options = opts;
+    }
+
+    const LLVMOptions &get_options() const
+    {
+        return options;
+    }
+
+protected:
+    /*! \return the key of the object code for `outputs` in the cache, the
+     *  printed expressions and everything else the code depends on
+     * */
+    std::string cache_key(const vec_basic &inputs, const vec_basic &outputs,
+                          bool cse, const std::string &cpu) const
+    {
+        LLVMCacheKeyPrinter printer;
+        std::ostringstream key;
+        // The visitor determines the types and the code of the functions
+        key << typeid(*this).name() << "\n" << LLVM_VERSION_STRING << "\n"
+            << cpu << "\n";
+        for (auto &f : options.features) {
+            key << f << " ";
+        }
+        key << "\n" << options.opt_level << " " << options.fast_math << " "
+            << options.fp_contract << " " << options.intrinsics << " " << cse
+            << "\n" << inputs.size() << "\n";
+        for (auto &p : inputs) {
+            key << printer.apply(*p) << "\n";
+        }
+        key << outputs.size() << "\n";
+        for (auto &p : outputs) {
+            key << printer.apply(*p) << "\n";
+        }
+        return key.str();
+    }
+
+    //! Creates an empty `module` for the target of `tm`
+    void create_module(llvm::TargetMachine &tm)
+    {
+        module.reset(new llvm::Module("SymEngine", *context));
+        module->setTargetTriple(tm.getTargetTriple().str());
+        module->setDataLayout(tm.createDataLayout());
+    }
+
+    //! Compiles `module`, or loads the object code of the cache instead
+    void create_engine(const std::string &cpu,
+                       const llvm::TargetOptions &target_options)
+    {
+        const llvm::CodeGenOpt::Level levels[]
+            = {llvm::CodeGenOpt::Level::None, llvm::CodeGenOpt::Level::Less,
+               llvm::CodeGenOpt::Level::Default,
+               llvm::CodeGenOpt::Level::Aggressive};
+        std::string error;
+        auto executionengine
+            = llvm::EngineBuilder(std::move(module))
+                  .setEngineKind(llvm::EngineKind::Kind::JIT)
+                  .setOptLevel(levels[std::min(options.opt_level, 3u)])
+                  .setMCPU(cpu)
+                  .setMAttrs(options.features)
+                  .setTargetOptions(target_options)
+                  .setErrorStr(&error)
+                  .create();
+        if (executionengine == nullptr) {
+            throw SymEngineException("Failed to create the LLVM JIT: "
+                                     + error);
+        }
+        executionengine->setObjectCache(object_cache.get());
+        executionengine->finalizeObject();
 
-        // Create some module to put our function into it.
-        module = llvm::make_unique<llvm::Module>("SymEngine", *context);
-        module->setDataLayout("");
+        // Get the symbol's address
+        func = (intptr_t)executionengine->getFunctionAddress("symengine_func");
+        func_batch = (intptr_t)executionengine->getFunctionAddress(
+            "symengine_func_batch");
+    }
+
+    //! Generates and optimizes the functions of `init()` in `module`
+    void generate(const vec_basic &inputs, const vec_basic &outputs, bool cse,
+                  llvm::TargetMachine &tm)
+    {
+        symbols = inputs;
+        n_inputs = inputs.size();
+        symbol_ptrs.clear();
+        vec_pair replacements;
+        vec_basic reduced_exprs;
+        if (cse) {
+            SymEngine::cse(replacements, reduced_exprs, outputs);
+        } else {
+            reduced_exprs = outputs;
+        }
 
         // Create a new pass manager attached to it.
-        auto fpm = llvm::make_unique<llvm::legacy::FunctionPassManager>(
-            module.get());
-
-        // Provide basic AliasAnalysis support for GVN.
-        // fpm->add(llvm::createBasicAliasAnalysisPass());
-        // Do simple "peephole" optimizations and bit-twiddling optzns.
-        fpm->add(llvm::createInstructionCombiningPass());
-        // Reassociate expressions.
-        fpm->add(llvm::createReassociatePass());
-        // Eliminate Common SubExpressions.
-        fpm->add(llvm::createGVNPass());
-        // Simplify the control flow graph (deleting unreachable blocks, etc).
-        fpm->add(llvm::createCFGSimplificationPass());
-        fpm->add(llvm::createPartiallyInlineLibCallsPass());
-        fpm->add(llvm::createLoadCombinePass());
-        fpm->add(llvm::createInstructionSimplifierPass());
-        fpm->add(llvm::createMemCpyOptPass());
-        fpm->add(llvm::createMergedLoadStoreMotionPass());
-        fpm->add(llvm::createBitTrackingDCEPass());
-        fpm->add(llvm::createAggressiveDCEPass());
+        std::unique_ptr<llvm::legacy::FunctionPassManager> fpm(
+            new llvm::legacy::FunctionPassManager(module.get()));
+
+        fpm->add(llvm::createTargetTransformInfoWrapperPass(
+            tm.getTargetIRAnalysis()));
+        // No IR passes at level 0, only the basic ones at level 1
+        if (options.opt_level >= 1) {
+            // Provide basic AliasAnalysis support for GVN.
+            // fpm->add(llvm::createBasicAliasAnalysisPass());
+            // Do simple "peephole" optimizations and bit-twiddling optzns.
+            fpm->add(llvm::createInstructionCombiningPass());
+            // Reassociate expressions.
+            fpm->add(llvm::createReassociatePass());
+            // Eliminate Common SubExpressions.
+            fpm->add(llvm::createGVNPass());
+            // Simplify the control flow graph (deleting unreachable blocks,
+            // etc).
+            fpm->add(llvm::createCFGSimplificationPass());
+        }
+        if (options.opt_level >= 2) {
+            fpm->add(llvm::createPartiallyInlineLibCallsPass());
+#if LLVM_VERSION_MAJOR < 5
+            fpm->add(llvm::createLoadCombinePass());
+#endif
+#if LLVM_VERSION_MAJOR >= 7
+            fpm->add(llvm::createInstSimplifyLegacyPass());
+#else
+            fpm->add(llvm::createInstructionSimplifierPass());
+#endif
+            fpm->add(llvm::createMemCpyOptPass());
+            fpm->add(llvm::createMergedLoadStoreMotionPass());
+            fpm->add(llvm::createBitTrackingDCEPass());
+            fpm->add(llvm::createAggressiveDCEPass());
+            // Vectorize the loop over the points of the batch function
+            fpm->add(llvm::createLoopRotatePass());
+            fpm->add(llvm::createLICMPass());
+            fpm->add(llvm::createIndVarSimplifyPass());
+            fpm->add(llvm::createLoopVectorizePass());
+            fpm->add(llvm::createInstructionCombiningPass());
+            fpm->add(llvm::createCFGSimplificationPass());
+        }
 
         fpm->doInitialization();
 
         std::vector<llvm::Type *> inp;
         for (int i = 0; i < 2; i++) {
-            inp.push_back(
-                llvm::PointerType::get(llvm::Type::getDoubleTy(*context), 0));
+            inp.push_back(llvm::PointerType::get(get_float_type(), 0));
         }
         llvm::FunctionType *function_type = llvm::FunctionType::get(
             llvm::Type::getVoidTy(*context), inp, false);
-        auto F = llvm::Function::Create(
-            function_type, llvm::Function::InternalLinkage, "", module.get());
+        auto F = llvm::Function::Create(function_type,
+                                        llvm::Function::ExternalLinkage,
+                                        "symengine_func", module.get());
         F->setCallingConv(llvm::CallingConv::C);
-        {
-            llvm::SmallVector<llvm::AttributeSet, 4> attrs;
-            llvm::AttributeSet PAS;
-            {
-                llvm::AttrBuilder B;
-                B.addAttribute(llvm::Attribute::ReadOnly);
-                B.addAttribute(llvm::Attribute::NoCapture);
-                PAS = llvm::AttributeSet::get(module->getContext(), 1U, B);
-            }
-
-            attrs.push_back(PAS);
-            {
-                llvm::AttrBuilder B;
-                B.addAttribute(llvm::Attribute::NoCapture);
-                PAS = llvm::AttributeSet::get(module->getContext(), 2U, B);
-            }
-
-            attrs.push_back(PAS);
-            {
-                llvm::AttrBuilder B;
-                B.addAttribute(llvm::Attribute::NoUnwind);
-                B.addAttribute(llvm::Attribute::UWTable);
-                PAS = llvm::AttributeSet::get(module->getContext(), ~0U, B);
-            }
-
-            attrs.push_back(PAS);
-
-            F->setAttributes(
-                llvm::AttributeSet::get(module->getContext(), attrs));
-        }
+        add_param_attribute(F, 0, llvm::Attribute::ReadOnly);
+        add_param_attribute(F, 0, llvm::Attribute::NoCapture);
+        add_param_attribute(F, 1, llvm::Attribute::NoCapture);
+        F->addFnAttr(llvm::Attribute::NoUnwind);
+        F->addFnAttr(llvm::Attribute::UWTable);
 
         // Add a basic block to the function. As before, it automatically
         // inserts
@@ -156,43 +525,39 @@ public:
         // Create a basic block builder with default parameters.  The builder
         // will
         // automatically append instructions to the basic block `BB'.
-        builder = llvm::make_unique<llvm::IRBuilder<>>(BB);
+        builder.reset(new llvm::IRBuilder<>(BB));
         builder->SetInsertPoint(BB);
         auto fmf = llvm::FastMathFlags();
-        // fmf.setUnsafeAlgebra();
+        if (options.fast_math) {
+#if LLVM_VERSION_MAJOR >= 6
+            fmf.setFast();
+#else
+            fmf.setUnsafeAlgebra();
+#endif
+        }
         builder->setFastMathFlags(fmf);
 
         // Load all the symbols and create references
+        // The indices have the width of a pointer, so that the offsets in the
+        // batch function do not overflow with large inputs
+        auto intptr = module->getDataLayout().getIntPtrType(*context);
         auto input_arg = &(*(F->args().begin()));
         for (unsigned i = 0; i < inputs.size(); i++) {
             if (not is_a<Symbol>(*inputs[i])) {
                 throw SymEngineException("Input contains a non-symbol.");
             }
-            auto index
-                = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), i);
-            auto ptr = builder->CreateGEP(llvm::Type::getDoubleTy(*context),
-                                          input_arg, index);
-            result_
-                = builder->CreateLoad(llvm::Type::getDoubleTy(*context), ptr);
+            result_ = load_value(input_arg, llvm::ConstantInt::get(intptr, i));
             symbol_ptrs.push_back(result_);
         }
 
-        auto it = ++(F->args().begin());
-        auto out = &(*it);
-        std::vector<llvm::Value *> output_vals;
-
+        auto out = &(*std::next(F->arg_begin()));
         // Generate Ir for all the output exprs and save references
-        for (unsigned i = 0; i < outputs.size(); i++) {
-            output_vals.push_back(apply(*outputs[i]));
-        }
+        std::vector<llvm::Value *> output_vals
+            = apply_outputs(inputs, replacements, reduced_exprs);
 
         // Store all the output exprs at the end
         for (unsigned i = 0; i < outputs.size(); i++) {
-            auto index
-                = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), i);
-            auto ptr = builder->CreateGEP(llvm::Type::getDoubleTy(*context),
-                                          out, index);
-            builder->CreateStore(output_vals[i], ptr);
+            store_value(output_vals[i], out, llvm::ConstantInt::get(intptr, i));
         }
 
         // Create the return instruction and add it to the basic block
@@ -207,39 +572,170 @@ public:
         // Optimize the function.
         fpm->run(*F);
 
+        // The batch function `void f(const T *inps, T *outs, size_t n)`
+        // evaluates the outputs at `n` points in a loop, see call_batch()
+        inp.push_back(intptr);
+        function_type = llvm::FunctionType::get(
+            llvm::Type::getVoidTy(*context), inp, false);
+        auto FB = llvm::Function::Create(function_type,
+                                         llvm::Function::ExternalLinkage,
+                                         "symengine_func_batch", module.get());
+        FB->setCallingConv(llvm::CallingConv::C);
+        FB->setDoesNotThrow();
+        for (unsigned i = 0; i < 2; i++) {
+            add_param_attribute(FB, i, llvm::Attribute::NoAlias);
+            add_param_attribute(FB, i, llvm::Attribute::NoCapture);
+        }
+        add_param_attribute(FB, 0, llvm::Attribute::ReadOnly);
+        auto args = FB->arg_begin();
+        input_arg = &(*args);
+        out = &(*(++args));
+        llvm::Value *n = &(*(++args));
+
+        auto zero = llvm::ConstantInt::get(intptr, 0);
+        auto entry = llvm::BasicBlock::Create(*context, "entry", FB);
+        auto loop = llvm::BasicBlock::Create(*context, "loop", FB);
+        auto exit = llvm::BasicBlock::Create(*context, "exit", FB);
+        builder->SetInsertPoint(entry);
+        builder->CreateCondBr(builder->CreateICmpNE(n, zero), loop, exit);
+
+        // The j-th input (output) at the i-th point is at index `j * n + i`
+        builder->SetInsertPoint(loop);
+        llvm::PHINode *index = builder->CreatePHI(intptr, 2);
+        index->addIncoming(zero, entry);
+        symbol_ptrs.clear();
+        for (unsigned i = 0; i < inputs.size(); i++) {
+            auto offset = builder->CreateNUWAdd(
+                builder->CreateNUWMul(llvm::ConstantInt::get(intptr, i), n),
+                index);
+            symbol_ptrs.push_back(load_value(input_arg, offset));
+        }
+        output_vals = apply_outputs(inputs, replacements, reduced_exprs);
+        for (unsigned i = 0; i < outputs.size(); i++) {
+            auto offset = builder->CreateNUWAdd(
+                builder->CreateNUWMul(llvm::ConstantInt::get(intptr, i), n),
+                index);
+            store_value(output_vals[i], out, offset);
+        }
+        auto next
+            = builder->CreateNUWAdd(index, llvm::ConstantInt::get(intptr, 1));
+        index->addIncoming(next, builder->GetInsertBlock());
+        builder->CreateCondBr(builder->CreateICmpULT(next, n), loop, exit);
+
+        builder->SetInsertPoint(exit);
+        builder->CreateRetVoid();
+        llvm::verifyFunction(*FB);
+        fpm->run(*FB);
+
         // std::cout << "Optimized LLVM IR" << std::endl;
         // module->dump();
+    }
 
-        // Now we create the JIT.
-        std::string error;
-        auto executionengine
-            = llvm::EngineBuilder(std::move(module))
-                  .setEngineKind(llvm::EngineKind::Kind::JIT)
-                  .setOptLevel(llvm::CodeGenOpt::Level::Aggressive)
-                  .setErrorStr(&error)
-                  .create();
-        // std::cout << error << std::endl;
-        executionengine->finalizeObject();
+    //! Adds the attribute `kind` to the argument `i`, counted from 0, of `f`
+    static void add_param_attribute(llvm::Function *f, unsigned i,
+                                    llvm::Attribute::AttrKind kind)
+    {
+#if LLVM_VERSION_MAJOR >= 5
+        f->addParamAttr(i, kind);
+#else
+        f->addAttribute(i + 1, kind);
+#endif
+    }
 
-        // Get the symbol's address
-        func = (intptr_t)executionengine->getPointerToFunction(F);
+    llvm::Value *get_float_constant(double d)
+    {
+        return llvm::ConstantFP::get(get_float_type(), d);
     }
 
-    double call(const std::vector<double> &vec)
+    llvm::Function *get_powi()
     {
-        double ret;
-        ((double (*)(const double *, double *))func)(vec.data(), &ret);
-        return ret;
+        std::vector<llvm::Type *> arg_type;
+        arg_type.push_back(get_float_type());
+        arg_type.push_back(llvm::Type::getInt32Ty(*context));
+        return llvm::Intrinsic::getDeclaration(module.get(),
+                                               llvm::Intrinsic::powi, arg_type);
     }
 
-    void call(double *outs, const double *inps)
+    llvm::Function *get_float_intrinsic(llvm::Intrinsic::ID id, unsigned n = 1)
+    {
+        std::vector<llvm::Type *> arg_type(n, get_float_type());
+        return llvm::Intrinsic::getDeclaration(module.get(), id, arg_type);
+    }
+
+    /*! \return the libm function `name` with `n` arguments, like `sinf`
+     *  instead of `sin` for float
+     * */
+    llvm::Function *get_libm_function(const std::string &name, unsigned n = 1)
     {
-        ((double (*)(const double *, double *))func)(inps, outs);
+        auto type = get_float_type();
+        std::vector<llvm::Type *> arg_type(n, type);
+        auto callee = module->getOrInsertFunction(
+            type->isFloatTy() ? name + "f" : name,
+            llvm::FunctionType::get(type, arg_type, false));
+#if LLVM_VERSION_MAJOR >= 9
+        auto fun = llvm::cast<llvm::Function>(callee.getCallee());
+#else
+        auto fun = llvm::cast<llvm::Function>(callee);
+#endif
+        fun->setDoesNotAccessMemory();
+        fun->setDoesNotThrow();
+        return fun;
+    }
+
+    //! \return the intrinsic `id`, or the libm function `name` without
+    //! `options.intrinsics`
+    llvm::Function *get_float_function(llvm::Intrinsic::ID id,
+                                       const std::string &name, unsigned n = 1)
+    {
+        if (options.intrinsics) {
+            return get_float_intrinsic(id, n);
+        }
+        return get_libm_function(name, n);
+    }
+
+    llvm::Value *call_function(llvm::Function *fun,
+                               std::vector<llvm::Value *> args)
+    {
+        auto r = builder->CreateCall(fun, args);
+        r->setTailCall(true);
+        return r;
     }
 
+public:
+    void bvisit(const Symbol &x)
+    {
+        // The symbols of the replacements come first, as an input that
+        // isn't used by the outputs may have the same name
+        for (std::size_t i = n_inputs; i < symbols.size(); ++i) {
+            if (eq(x, *symbols[i])) {
+                result_ = symbol_ptrs[i];
+                return;
+            }
+        }
+        for (std::size_t i = 0; i < n_inputs; ++i) {
+            if (eq(x, *symbols[i])) {
+                result_ = symbol_ptrs[i];
+                return;
+            }
+        }
+        throw std::runtime_error("Symbol not in the symbols vector.");
+    };
+};
+
+//! Base of the visitors whose values are real numbers of `get_float_type()`
+class LLVMRealVisitor : public BaseVisitor<LLVMRealVisitor, LLVMVisitor>
+{
+public:
+    // Classes not implemented are
+    // Subs, UpperGamma, LowerGamma, Dirichlet_eta, Zeta
+    // LeviCivita, KroneckerDelta, FunctionSymbol, LambertW
+    // Derivative, Complex, ComplexDouble, ComplexMPC
+
+    using LLVMVisitor::bvisit;
+
     void set_double(double d)
     {
-        result_ = llvm::ConstantFP::get(llvm::Type::getDoubleTy(*context), d);
+        result_ = get_float_constant(d);
     }
 
     void bvisit(const Integer &x, bool as_int32 = false)
@@ -249,8 +745,7 @@ public:
             result_ = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context),
                                              d, true);
         } else {
-            result_ = llvm::ConstantFP::get(llvm::Type::getDoubleTy(*context),
-                                            mp_get_d(x.i));
+            set_double(mp_get_d(x.i));
         }
     }
 
@@ -271,6 +766,17 @@ public:
     }
 #endif
 
+    void bvisit(const Infty &x)
+    {
+        if (x.is_positive()) {
+            set_double(std::numeric_limits<double>::infinity());
+        } else if (x.is_negative()) {
+            set_double(-std::numeric_limits<double>::infinity());
+        } else {
+            throw NotImplementedError("Complex infinity is not real.");
+        }
+    }
+
     void bvisit(const Add &x)
     {
         llvm::Value *tmp, *tmp1, *tmp2;
@@ -294,7 +800,7 @@ public:
             //} else {
             //    std::vector<llvm::Value *> args({tmp1, tmp2, tmp});
             //    tmp =
-            //    builder->CreateCall(get_double_intrinsic(llvm::Intrinsic::fma,
+            //    builder->CreateCall(get_float_intrinsic(llvm::Intrinsic::fma,
             //    3), args);
             //}
         }
@@ -311,33 +817,21 @@ public:
         result_ = tmp;
     }
 
-    llvm::Function *get_powi()
-    {
-        std::vector<llvm::Type *> arg_type;
-        arg_type.push_back(llvm::Type::getDoubleTy(*context));
-        arg_type.push_back(llvm::Type::getInt32Ty(*context));
-        return llvm::Intrinsic::getDeclaration(module.get(),
-                                               llvm::Intrinsic::powi, arg_type);
-    }
-
-    llvm::Function *get_double_intrinsic(llvm::Intrinsic::ID id, unsigned n = 1)
-    {
-        std::vector<llvm::Type *> arg_type(n,
-                                           llvm::Type::getDoubleTy(*context));
-        return llvm::Intrinsic::getDeclaration(module.get(), id, arg_type);
-    }
-
     void bvisit(const Pow &x)
     {
         std::vector<llvm::Value *> args;
         llvm::Function *fun;
         if (eq(*(x.get_base()), *E)) {
             args.push_back(apply(*x.get_exp()));
-            fun = get_double_intrinsic(llvm::Intrinsic::exp, 1);
+            fun = get_float_function(llvm::Intrinsic::exp, "exp");
 
         } else if (eq(*(x.get_base()), *integer(2))) {
             args.push_back(apply(*x.get_exp()));
-            fun = get_double_intrinsic(llvm::Intrinsic::exp2, 1);
+            fun = get_float_function(llvm::Intrinsic::exp2, "exp2");
+
+        } else if (eq(*(x.get_exp()), *rational(1, 2))) {
+            args.push_back(apply(*x.get_base()));
+            fun = get_float_function(llvm::Intrinsic::sqrt, "sqrt");
 
         } else {
             if (is_a<Integer>(*x.get_exp())) {
@@ -354,82 +848,862 @@ public:
             } else {
                 args.push_back(apply(*x.get_base()));
                 args.push_back(apply(*x.get_exp()));
-                fun = get_double_intrinsic(llvm::Intrinsic::pow, 2);
+                fun = get_float_function(llvm::Intrinsic::pow, "pow", 2);
             }
         }
-        auto r = builder->CreateCall(fun, args);
-        r->setTailCall(true);
-        result_ = r;
+        result_ = call_function(fun, args);
+    }
+
+    //! Applies the intrinsic `id` (or the libm function `name`) to `x`
+    void apply_function(llvm::Intrinsic::ID id, const std::string &name,
+                        const OneArgFunction &x)
+    {
+        result_ = call_function(get_float_function(id, name),
+                                {apply(*x.get_arg())});
+    }
+
+    //! Applies the libm function `name` to the argument of `x`
+    void apply_libm(const std::string &name, const OneArgFunction &x)
+    {
+        result_ = call_function(get_libm_function(name), {apply(*x.get_arg())});
+    }
+
+    //! Applies the libm function `name` to the inverse of the argument
+    void apply_libm_inverse(const std::string &name, const OneArgFunction &x)
+    {
+        llvm::Value *arg = apply(*x.get_arg());
+        arg = builder->CreateFDiv(get_float_constant(1.0), arg);
+        result_ = call_function(get_libm_function(name), {arg});
+    }
+
+    //! Sets `result_` to its inverse
+    void invert()
+    {
+        result_ = builder->CreateFDiv(get_float_constant(1.0), result_);
     }
 
     void bvisit(const Sin &x)
     {
-        std::vector<llvm::Value *> args;
-        llvm::Function *fun;
-        args.push_back(apply(*x.get_arg()));
-        fun = get_double_intrinsic(llvm::Intrinsic::sin, 1);
-        auto r = builder->CreateCall(fun, args);
-        r->setTailCall(true);
-        result_ = r;
+        apply_function(llvm::Intrinsic::sin, "sin", x);
     }
 
     void bvisit(const Cos &x)
     {
-        std::vector<llvm::Value *> args;
-        llvm::Function *fun;
-        args.push_back(apply(*x.get_arg()));
-        fun = get_double_intrinsic(llvm::Intrinsic::cos, 1);
-        auto r = builder->CreateCall(fun, args);
-        r->setTailCall(true);
-        result_ = r;
+        apply_function(llvm::Intrinsic::cos, "cos", x);
     }
 
     void bvisit(const Tan &x)
     {
-        throw std::runtime_error("Not implemented.");
+        apply_libm("tan", x);
     }
 
-    void bvisit(const Symbol &x)
+    void bvisit(const Cot &x)
     {
-        unsigned i = 0;
-        for (auto &symb : symbols) {
-            if (eq(x, *symb)) {
-                result_ = symbol_ptrs[i];
-                return;
-            }
-            ++i;
-        }
-        throw std::runtime_error("Symbol not in the symbols vector.");
-    };
+        apply_libm("tan", x);
+        invert();
+    }
 
-    void bvisit(const Log &x)
+    void bvisit(const Csc &x)
     {
-        throw std::runtime_error("Not implemented.");
-    };
+        apply_function(llvm::Intrinsic::sin, "sin", x);
+        invert();
+    }
 
-    void bvisit(const Constant &x)
+    void bvisit(const Sec &x)
     {
-        if (eq(x, *pi)) {
-            set_double(3.1415926535897932);
-        } else if (eq(x, *E)) {
-            set_double(2.7182818284590452);
-        } else if (eq(x, *EulerGamma)) {
-            set_double(0.57721566490153286);
-        } else {
-            throw SymEngineException("Constant " + x.get_name()
-                                     + " is not implemented.");
-        }
-    };
+        apply_function(llvm::Intrinsic::cos, "cos", x);
+        invert();
+    }
 
-    void bvisit(const Abs &x)
+    void bvisit(const ASin &x)
     {
-        throw std::runtime_error("Not implemented.");
-    };
+        apply_libm("asin", x);
+    }
 
-    void bvisit(const Basic &)
+    void bvisit(const ACos &x)
     {
-        throw std::runtime_error("Not implemented.");
+        apply_libm("acos", x);
+    }
+
+    void bvisit(const ATan &x)
+    {
+        apply_libm("atan", x);
+    }
+
+    void bvisit(const ACot &x)
+    {
+        apply_libm_inverse("atan", x);
+    }
+
+    void bvisit(const ACsc &x)
+    {
+        apply_libm_inverse("asin", x);
+    }
+
+    void bvisit(const ASec &x)
+    {
+        apply_libm_inverse("acos", x);
+    }
+
+    void bvisit(const ATan2 &x)
+    {
+        result_ = call_function(get_libm_function("atan2", 2),
+                                {apply(*x.get_num()), apply(*x.get_den())});
+    }
+
+    void bvisit(const Sinh &x)
+    {
+        apply_libm("sinh", x);
+    }
+
+    void bvisit(const Cosh &x)
+    {
+        apply_libm("cosh", x);
+    }
+
+    void bvisit(const Tanh &x)
+    {
+        apply_libm("tanh", x);
+    }
+
+    void bvisit(const Coth &x)
+    {
+        apply_libm("tanh", x);
+        invert();
+    }
+
+    void bvisit(const Csch &x)
+    {
+        apply_libm("sinh", x);
+        invert();
+    }
+
+    void bvisit(const Sech &x)
+    {
+        apply_libm("cosh", x);
+        invert();
+    }
+
+    void bvisit(const ASinh &x)
+    {
+        apply_libm("asinh", x);
+    }
+
+    void bvisit(const ACosh &x)
+    {
+        apply_libm("acosh", x);
+    }
+
+    void bvisit(const ATanh &x)
+    {
+        apply_libm("atanh", x);
+    }
+
+    void bvisit(const ACoth &x)
+    {
+        apply_libm_inverse("atanh", x);
+    }
+
+    void bvisit(const ACsch &x)
+    {
+        apply_libm_inverse("asinh", x);
+    }
+
+    void bvisit(const ASech &x)
+    {
+        apply_libm_inverse("acosh", x);
+    }
+
+    void bvisit(const Log &x)
+    {
+        apply_function(llvm::Intrinsic::log, "log", x);
+    };
+
+    void bvisit(const Abs &x)
+    {
+        apply_function(llvm::Intrinsic::fabs, "fabs", x);
+    };
+
+    void bvisit(const Gamma &x)
+    {
+        apply_libm("tgamma", x);
+    }
+
+    void bvisit(const LogGamma &x)
+    {
+        apply_libm("lgamma", x);
+    }
+
+    void bvisit(const Erf &x)
+    {
+        apply_libm("erf", x);
+    }
+
+    void bvisit(const Erfc &x)
+    {
+        apply_libm("erfc", x);
+    }
+
+    void bvisit(const Max &x)
+    {
+        auto fun = get_float_function(llvm::Intrinsic::maxnum, "fmax", 2);
+        auto args = x.get_args();
+        llvm::Value *tmp = apply(*args[0]);
+        for (unsigned i = 1; i < args.size(); i++) {
+            tmp = call_function(fun, {tmp, apply(*args[i])});
+        }
+        result_ = tmp;
+    }
+
+    void bvisit(const Min &x)
+    {
+        auto fun = get_float_function(llvm::Intrinsic::minnum, "fmin", 2);
+        auto args = x.get_args();
+        llvm::Value *tmp = apply(*args[0]);
+        for (unsigned i = 1; i < args.size(); i++) {
+            tmp = call_function(fun, {tmp, apply(*args[i])});
+        }
+        result_ = tmp;
+    }
+
+    //! \return the `i1` value of the condition `b` of a Piecewise
+    llvm::Value *apply_condition(const Boolean &b)
+    {
+        if (is_a<BooleanAtom>(b)) {
+            return builder->getInt1(static_cast<const BooleanAtom &>(b)
+                                        .get_val());
+        } else if (is_a<Contains>(b)) {
+            auto &c = static_cast<const Contains &>(b);
+            if (is_a<Interval>(*c.get_set())) {
+                auto &i = static_cast<const Interval &>(*c.get_set());
+                llvm::Value *v = apply(*c.get_expr());
+                llvm::Value *start = apply(*i.start_);
+                llvm::Value *end = apply(*i.end_);
+                llvm::Value *l = i.left_open_
+                                     ? builder->CreateFCmpOLT(start, v)
+                                     : builder->CreateFCmpOLE(start, v);
+                llvm::Value *r = i.right_open_ ? builder->CreateFCmpOLT(v, end)
+                                               : builder->CreateFCmpOLE(v, end);
+                return builder->CreateAnd(l, r);
+            }
+        } else if (is_a<And>(b)) {
+            llvm::Value *r = builder->getInt1(true);
+            for (auto &p : static_cast<const And &>(b).get_container()) {
+                r = builder->CreateAnd(r, apply_condition(*p));
+            }
+            return r;
+        } else if (is_a<Or>(b)) {
+            llvm::Value *r = builder->getInt1(false);
+            for (auto &p : static_cast<const Or &>(b).get_container()) {
+                r = builder->CreateOr(r, apply_condition(*p));
+            }
+            return r;
+        } else if (is_a<Not>(b)) {
+            return builder->CreateNot(
+                apply_condition(*static_cast<const Not &>(b).get_arg()));
+        }
+        throw NotImplementedError("Condition not implemented.");
+    }
+
+    void bvisit(const Piecewise &x)
+    {
+        // All pieces are evaluated and the first one whose condition holds
+        // is selected, so that no branches are needed. NaN if there is none.
+        auto &vec = x.get_vec();
+        llvm::Value *r = llvm::ConstantFP::getNaN(get_float_type());
+        for (auto it = vec.rbegin(); it != vec.rend(); ++it) {
+            llvm::Value *value = apply(*it->first);
+            r = builder->CreateSelect(apply_condition(*it->second), value, r);
+        }
+        result_ = r;
+    }
+
+    void bvisit(const Constant &x)
+    {
+        set_double(eval_double(x));
     };
+
+    void bvisit(const Basic &)
+    {
+        throw std::runtime_error("Not implemented.");
+    };
+};
+
+class LLVMDoubleVisitor : public LLVMRealVisitor
+{
+protected:
+    llvm::Type *get_float_type() override
+    {
+        return llvm::Type::getDoubleTy(*context);
+    }
+
+public:
+    double call(const std::vector<double> &vec)
+    {
+        double ret;
+        ((void (*)(const double *, double *))func)(vec.data(), &ret);
+        return ret;
+    }
+
+    void call(double *outs, const double *inps)
+    {
+        ((void (*)(const double *, double *))func)(inps, outs);
+    }
+
+    /*! Evaluates all outputs at `n` points. The inputs are stored by symbol,
+     *  `inps[j * n + i]` is the value of the j-th symbol at the i-th point,
+     *  and the outputs the same way, `outs[k * n + i]`.
+     * */
+    void call_batch(double *outs, const double *inps, std::size_t n)
+    {
+        ((void (*)(const double *, double *, std::size_t))func_batch)(
+            inps, outs, n);
+    }
+};
+
+/*! Evaluates in single precision, which halves the memory traffic of
+ *  `call_batch()` and doubles the width of its vector instructions.
+ * */
+class LLVMFloatVisitor : public LLVMRealVisitor
+{
+protected:
+    llvm::Type *get_float_type() override
+    {
+        return llvm::Type::getFloatTy(*context);
+    }
+
+public:
+    float call(const std::vector<float> &vec)
+    {
+        float ret;
+        ((void (*)(const float *, float *))func)(vec.data(), &ret);
+        return ret;
+    }
+
+    void call(float *outs, const float *inps)
+    {
+        ((void (*)(const float *, float *))func)(inps, outs);
+    }
+
+    //! Evaluates all outputs at `n` points, see LLVMDoubleVisitor
+    void call_batch(float *outs, const float *inps, std::size_t n)
+    {
+        ((void (*)(const float *, float *, std::size_t))func_batch)(inps, outs,
+                                                                    n);
+    }
+};
+
+/*! Evaluates complex expressions. A value is a `{double, double}` struct of
+ *  its real and imaginary parts, and the arithmetic and the functions are
+ *  expressed with real operations on the parts. The inputs and outputs are
+ *  arrays of `std::complex<double>`.
+ * */
+class LLVMComplexDoubleVisitor
+    : public BaseVisitor<LLVMComplexDoubleVisitor, LLVMVisitor>
+{
+public:
+    // Classes not implemented are
+    // Subs, UpperGamma, LowerGamma, Dirichlet_eta, Zeta
+    // LeviCivita, KroneckerDelta, FunctionSymbol, LambertW
+    // Derivative, ATan2, Gamma, LogGamma, Erf, Erfc, Max, Min, Piecewise
+
+    using LLVMVisitor::bvisit;
+
+protected:
+    llvm::Type *get_float_type() override
+    {
+        return llvm::Type::getDoubleTy(*context);
+    }
+
+    llvm::Type *get_complex_type()
+    {
+        return llvm::StructType::get(*context,
+                                     {get_float_type(), get_float_type()});
+    }
+
+    // The complex value with the index `index` is at `2 * index`
+    llvm::Value *load_value(llvm::Value *ptr, llvm::Value *index) override
+    {
+        index = builder->CreateShl(index, 1);
+        llvm::Value *re = LLVMVisitor::load_value(ptr, index);
+        index = builder->CreateAdd(
+            index, llvm::ConstantInt::get(index->getType(), 1));
+        return make_complex(re, LLVMVisitor::load_value(ptr, index));
+    }
+
+    void store_value(llvm::Value *value, llvm::Value *ptr,
+                     llvm::Value *index) override
+    {
+        index = builder->CreateShl(index, 1);
+        LLVMVisitor::store_value(real_part(value), ptr, index);
+        index = builder->CreateAdd(
+            index, llvm::ConstantInt::get(index->getType(), 1));
+        LLVMVisitor::store_value(imag_part(value), ptr, index);
+    }
+
+    llvm::Value *make_complex(llvm::Value *re, llvm::Value *im)
+    {
+        llvm::Value *z = llvm::UndefValue::get(get_complex_type());
+        z = builder->CreateInsertValue(z, re, {0});
+        return builder->CreateInsertValue(z, im, {1});
+    }
+
+    llvm::Value *make_complex(double re, double im)
+    {
+        return make_complex(get_float_constant(re), get_float_constant(im));
+    }
+
+    llvm::Value *real_part(llvm::Value *z)
+    {
+        return builder->CreateExtractValue(z, {0});
+    }
+
+    llvm::Value *imag_part(llvm::Value *z)
+    {
+        return builder->CreateExtractValue(z, {1});
+    }
+
+    llvm::Value *call_real(const std::string &name, llvm::Value *x)
+    {
+        return call_function(get_libm_function(name), {x});
+    }
+
+    llvm::Value *call_real(llvm::Intrinsic::ID id, const std::string &name,
+                           llvm::Value *x)
+    {
+        return call_function(get_float_function(id, name), {x});
+    }
+
+    llvm::Value *add(llvm::Value *a, llvm::Value *b)
+    {
+        return make_complex(
+            builder->CreateFAdd(real_part(a), real_part(b)),
+            builder->CreateFAdd(imag_part(a), imag_part(b)));
+    }
+
+    llvm::Value *sub(llvm::Value *a, llvm::Value *b)
+    {
+        return make_complex(
+            builder->CreateFSub(real_part(a), real_part(b)),
+            builder->CreateFSub(imag_part(a), imag_part(b)));
+    }
+
+    llvm::Value *mul(llvm::Value *a, llvm::Value *b)
+    {
+        llvm::Value *ar = real_part(a), *ai = imag_part(a);
+        llvm::Value *br = real_part(b), *bi = imag_part(b);
+        return make_complex(
+            builder->CreateFSub(builder->CreateFMul(ar, br),
+                                builder->CreateFMul(ai, bi)),
+            builder->CreateFAdd(builder->CreateFMul(ar, bi),
+                                builder->CreateFMul(ai, br)));
+    }
+
+    llvm::Value *div(llvm::Value *a, llvm::Value *b)
+    {
+        llvm::Value *ar = real_part(a), *ai = imag_part(a);
+        llvm::Value *br = real_part(b), *bi = imag_part(b);
+        llvm::Value *d = builder->CreateFAdd(builder->CreateFMul(br, br),
+                                             builder->CreateFMul(bi, bi));
+        llvm::Value *re = builder->CreateFAdd(builder->CreateFMul(ar, br),
+                                              builder->CreateFMul(ai, bi));
+        llvm::Value *im = builder->CreateFSub(builder->CreateFMul(ai, br),
+                                              builder->CreateFMul(ar, bi));
+        return make_complex(builder->CreateFDiv(re, d),
+                            builder->CreateFDiv(im, d));
+    }
+
+    llvm::Value *inverse(llvm::Value *z)
+    {
+        return div(make_complex(1.0, 0.0), z);
+    }
+
+    //! \return `i * z`
+    llvm::Value *mul_i(llvm::Value *z)
+    {
+        return make_complex(builder->CreateFNeg(imag_part(z)), real_part(z));
+    }
+
+    llvm::Value *exp(llvm::Value *z)
+    {
+        llvm::Value *r
+            = call_real(llvm::Intrinsic::exp, "exp", real_part(z));
+        llvm::Value *im = imag_part(z);
+        return make_complex(
+            builder->CreateFMul(r, call_real(llvm::Intrinsic::cos, "cos", im)),
+            builder->CreateFMul(r,
+                                call_real(llvm::Intrinsic::sin, "sin", im)));
+    }
+
+    //! \return the principal value of the logarithm of `z`
+    llvm::Value *log(llvm::Value *z)
+    {
+        llvm::Value *re = real_part(z), *im = imag_part(z);
+        llvm::Value *abs
+            = call_function(get_libm_function("hypot", 2), {re, im});
+        llvm::Value *arg
+            = call_function(get_libm_function("atan2", 2), {im, re});
+        return make_complex(call_real(llvm::Intrinsic::log, "log", abs), arg);
+    }
+
+    llvm::Value *sqrt(llvm::Value *z)
+    {
+        llvm::Value *l = log(z);
+        llvm::Value *half = get_float_constant(0.5);
+        return exp(make_complex(builder->CreateFMul(real_part(l), half),
+                                builder->CreateFMul(imag_part(l), half)));
+    }
+
+    //! \return `z**n` by repeated squaring
+    llvm::Value *powi(llvm::Value *z, long n)
+    {
+        bool negative = n < 0;
+        unsigned long m = negative ? -static_cast<unsigned long>(n) : n;
+        llvm::Value *r = make_complex(1.0, 0.0);
+        for (; m > 0; m >>= 1) {
+            if (m & 1) {
+                r = mul(r, z);
+            }
+            if (m > 1) {
+                z = mul(z, z);
+            }
+        }
+        return negative ? inverse(r) : r;
+    }
+
+    llvm::Value *sin(llvm::Value *z)
+    {
+        llvm::Value *re = real_part(z), *im = imag_part(z);
+        return make_complex(
+            builder->CreateFMul(call_real(llvm::Intrinsic::sin, "sin", re),
+                                call_real("cosh", im)),
+            builder->CreateFMul(call_real(llvm::Intrinsic::cos, "cos", re),
+                                call_real("sinh", im)));
+    }
+
+    llvm::Value *cos(llvm::Value *z)
+    {
+        llvm::Value *re = real_part(z), *im = imag_part(z);
+        return make_complex(
+            builder->CreateFMul(call_real(llvm::Intrinsic::cos, "cos", re),
+                                call_real("cosh", im)),
+            builder->CreateFNeg(builder->CreateFMul(
+                call_real(llvm::Intrinsic::sin, "sin", re),
+                call_real("sinh", im))));
+    }
+
+    llvm::Value *sinh(llvm::Value *z)
+    {
+        llvm::Value *re = real_part(z), *im = imag_part(z);
+        return make_complex(
+            builder->CreateFMul(call_real("sinh", re),
+                                call_real(llvm::Intrinsic::cos, "cos", im)),
+            builder->CreateFMul(call_real("cosh", re),
+                                call_real(llvm::Intrinsic::sin, "sin", im)));
+    }
+
+    llvm::Value *cosh(llvm::Value *z)
+    {
+        llvm::Value *re = real_part(z), *im = imag_part(z);
+        return make_complex(
+            builder->CreateFMul(call_real("cosh", re),
+                                call_real(llvm::Intrinsic::cos, "cos", im)),
+            builder->CreateFMul(call_real("sinh", re),
+                                call_real(llvm::Intrinsic::sin, "sin", im)));
+    }
+
+    //! \return `asinh(z) = log(z + sqrt(z**2 + 1))`
+    llvm::Value *asinh(llvm::Value *z)
+    {
+        return log(add(z, sqrt(add(mul(z, z), make_complex(1.0, 0.0)))));
+    }
+
+    //! \return `acosh(z) = log(z + sqrt(z + 1) * sqrt(z - 1))`
+    llvm::Value *acosh(llvm::Value *z)
+    {
+        llvm::Value *one = make_complex(1.0, 0.0);
+        return log(add(z, mul(sqrt(add(z, one)), sqrt(sub(z, one)))));
+    }
+
+    //! \return `atanh(z) = (log(1 + z) - log(1 - z)) / 2`
+    llvm::Value *atanh(llvm::Value *z)
+    {
+        llvm::Value *one = make_complex(1.0, 0.0);
+        return mul(make_complex(0.5, 0.0),
+                   sub(log(add(one, z)), log(sub(one, z))));
+    }
+
+    //! \return `asin(z) = -i asinh(i z)`
+    llvm::Value *asin(llvm::Value *z)
+    {
+        return mul(make_complex(0.0, -1.0), asinh(mul_i(z)));
+    }
+
+    //! \return `acos(z) = pi / 2 - asin(z)`
+    llvm::Value *acos(llvm::Value *z)
+    {
+        return sub(make_complex(1.5707963267948966, 0.0), asin(z));
+    }
+
+    //! \return `atan(z) = -i atanh(i z)`
+    llvm::Value *atan(llvm::Value *z)
+    {
+        return mul(make_complex(0.0, -1.0), atanh(mul_i(z)));
+    }
+
+public:
+    void bvisit(const Integer &x)
+    {
+        result_ = make_complex(mp_get_d(x.i), 0.0);
+    }
+
+    void bvisit(const Rational &x)
+    {
+        result_ = make_complex(mp_get_d(x.i), 0.0);
+    }
+
+    void bvisit(const RealDouble &x)
+    {
+        result_ = make_complex(x.i, 0.0);
+    }
+
+#ifdef HAVE_SYMENGINE_MPFR
+    void bvisit(const RealMPFR &x)
+    {
+        result_ = make_complex(mpfr_get_d(x.i.get_mpfr_t(), MPFR_RNDN), 0.0);
+    }
+#endif
+
+    void bvisit(const Complex &x)
+    {
+        result_ = make_complex(mp_get_d(x.real_), mp_get_d(x.imaginary_));
+    }
+
+    void bvisit(const ComplexDouble &x)
+    {
+        result_ = make_complex(x.i.real(), x.i.imag());
+    }
+
+#ifdef HAVE_SYMENGINE_MPC
+    void bvisit(const ComplexMPC &x)
+    {
+        mpfr_class t(x.get_prec());
+        double real, imag;
+        mpc_real(t.get_mpfr_t(), x.i.get_mpc_t(), MPFR_RNDN);
+        real = mpfr_get_d(t.get_mpfr_t(), MPFR_RNDN);
+        mpc_imag(t.get_mpfr_t(), x.i.get_mpc_t(), MPFR_RNDN);
+        imag = mpfr_get_d(t.get_mpfr_t(), MPFR_RNDN);
+        result_ = make_complex(real, imag);
+    }
+#endif
+
+    void bvisit(const Constant &x)
+    {
+        result_ = make_complex(eval_double(x), 0.0);
+    };
+
+    void bvisit(const Add &x)
+    {
+        llvm::Value *tmp = apply(*x.coef_);
+        for (const auto &p : x.get_dict()) {
+            tmp = add(tmp, mul(apply(*p.first), apply(*p.second)));
+        }
+        result_ = tmp;
+    }
+
+    void bvisit(const Mul &x)
+    {
+        llvm::Value *tmp = make_complex(1.0, 0.0);
+        for (const auto &p : x.get_args()) {
+            tmp = mul(tmp, apply(*p));
+        }
+        result_ = tmp;
+    }
+
+    void bvisit(const Pow &x)
+    {
+        const Basic &exp_ = *x.get_exp();
+        if (eq(*(x.get_base()), *E)) {
+            result_ = exp(apply(exp_));
+        } else if (is_a<Integer>(exp_)
+                   and mp_fits_slong_p(static_cast<const Integer &>(exp_).i)) {
+            result_ = powi(apply(*x.get_base()),
+                           mp_get_si(static_cast<const Integer &>(exp_).i));
+        } else if (eq(exp_, *rational(1, 2))) {
+            result_ = sqrt(apply(*x.get_base()));
+        } else {
+            // z**w = exp(w log(z))
+            result_ = exp(mul(apply(exp_), log(apply(*x.get_base()))));
+        }
+    }
+
+    void bvisit(const Log &x)
+    {
+        result_ = log(apply(*x.get_arg()));
+    }
+
+    void bvisit(const Abs &x)
+    {
+        llvm::Value *z = apply(*x.get_arg());
+        result_ = make_complex(
+            call_function(get_libm_function("hypot", 2),
+                          {real_part(z), imag_part(z)}),
+            get_float_constant(0.0));
+    }
+
+    void bvisit(const Sin &x)
+    {
+        result_ = sin(apply(*x.get_arg()));
+    }
+
+    void bvisit(const Cos &x)
+    {
+        result_ = cos(apply(*x.get_arg()));
+    }
+
+    void bvisit(const Tan &x)
+    {
+        llvm::Value *z = apply(*x.get_arg());
+        result_ = div(sin(z), cos(z));
+    }
+
+    void bvisit(const Cot &x)
+    {
+        llvm::Value *z = apply(*x.get_arg());
+        result_ = div(cos(z), sin(z));
+    }
+
+    void bvisit(const Csc &x)
+    {
+        result_ = inverse(sin(apply(*x.get_arg())));
+    }
+
+    void bvisit(const Sec &x)
+    {
+        result_ = inverse(cos(apply(*x.get_arg())));
+    }
+
+    void bvisit(const ASin &x)
+    {
+        result_ = asin(apply(*x.get_arg()));
+    }
+
+    void bvisit(const ACos &x)
+    {
+        result_ = acos(apply(*x.get_arg()));
+    }
+
+    void bvisit(const ATan &x)
+    {
+        result_ = atan(apply(*x.get_arg()));
+    }
+
+    void bvisit(const ACot &x)
+    {
+        result_ = atan(inverse(apply(*x.get_arg())));
+    }
+
+    void bvisit(const ACsc &x)
+    {
+        result_ = asin(inverse(apply(*x.get_arg())));
+    }
+
+    void bvisit(const ASec &x)
+    {
+        result_ = acos(inverse(apply(*x.get_arg())));
+    }
+
+    void bvisit(const Sinh &x)
+    {
+        result_ = sinh(apply(*x.get_arg()));
+    }
+
+    void bvisit(const Cosh &x)
+    {
+        result_ = cosh(apply(*x.get_arg()));
+    }
+
+    void bvisit(const Tanh &x)
+    {
+        llvm::Value *z = apply(*x.get_arg());
+        result_ = div(sinh(z), cosh(z));
+    }
+
+    void bvisit(const Coth &x)
+    {
+        llvm::Value *z = apply(*x.get_arg());
+        result_ = div(cosh(z), sinh(z));
+    }
+
+    void bvisit(const Csch &x)
+    {
+        result_ = inverse(sinh(apply(*x.get_arg())));
+    }
+
+    void bvisit(const Sech &x)
+    {
+        result_ = inverse(cosh(apply(*x.get_arg())));
+    }
+
+    void bvisit(const ASinh &x)
+    {
+        result_ = asinh(apply(*x.get_arg()));
+    }
+
+    void bvisit(const ACosh &x)
+    {
+        result_ = acosh(apply(*x.get_arg()));
+    }
+
+    void bvisit(const ATanh &x)
+    {
+        result_ = atanh(apply(*x.get_arg()));
+    }
+
+    void bvisit(const ACoth &x)
+    {
+        result_ = atanh(inverse(apply(*x.get_arg())));
+    }
+
+    void bvisit(const ACsch &x)
+    {
+        result_ = asinh(inverse(apply(*x.get_arg())));
+    }
+
+    void bvisit(const ASech &x)
+    {
+        result_ = acosh(inverse(apply(*x.get_arg())));
+    }
+
+    void bvisit(const Basic &)
+    {
+        throw NotImplementedError("Not Implemented");
+    };
+
+    std::complex<double> call(const std::vector<std::complex<double>> &vec)
+    {
+        std::complex<double> ret;
+        ((void (*)(const double *, double *))func)(
+            reinterpret_cast<const double *>(vec.data()),
+            reinterpret_cast<double *>(&ret));
+        return ret;
+    }
+
+    void call(std::complex<double> *outs, const std::complex<double> *inps)
+    {
+        ((void (*)(const double *, double *))func)(
+            reinterpret_cast<const double *>(inps),
+            reinterpret_cast<double *>(outs));
+    }
+
+    //! Evaluates all outputs at `n` points, see LLVMDoubleVisitor
+    void call_batch(std::complex<double> *outs,
+                    const std::complex<double> *inps, std::size_t n)
+    {
+        ((void (*)(const double *, double *, std::size_t))func_batch)(
+            reinterpret_cast<const double *>(inps),
+            reinterpret_cast<double *>(outs), n);
+    }
 };
 }
 #endif
@@ -74,6 +74,8 @@ public:
 
 typedef std::vector<std::pair<int, int>> permutelist;
 
+class CSRMatrix;
+
 // ----------------------------- Dense Matrix --------------------------------//
 class DenseMatrix : public MatrixBase
 {
@@ -146,10 +148,12 @@ public:
 
     // Return the Jacobian of the matrix
     friend void jacobian(const DenseMatrix &A, const DenseMatrix &x,
-                         DenseMatrix &result);
+                         DenseMatrix &result, unsigned nthreads);
+    friend void jacobian(const DenseMatrix &A, const DenseMatrix &x,
+                         CSRMatrix &result, unsigned nthreads);
     // Return the Jacobian of the matrix using sdiff
     friend void sjacobian(const DenseMatrix &A, const DenseMatrix &x,
-                          DenseMatrix &result);
+                          DenseMatrix &result, unsigned nthreads);
 
     // Differentiate the matrix element-wise
     friend void diff(const DenseMatrix &A, const RCP<const Symbol> &x,
@@ -366,10 +370,25 @@ private:
     unsigned col_;
 };
 
-// Return the Jacobian of the matrix
-void jacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result);
+// Return the Jacobian of the matrix. The rows are differentiated by
+// `nthreads` threads if OpenMP is enabled, 0 being the default of OpenMP.
+void jacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result,
+              unsigned nthreads = 0);
+// Return the Jacobian as a sparse matrix, which holds only the entries of
+// the symbols that occur in the rows and whose derivative is not zero
+void jacobian(const DenseMatrix &A, const DenseMatrix &x, CSRMatrix &result,
+              unsigned nthreads = 0);
 // Return the Jacobian of the matrix using sdiff
-void sjacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result);
+void sjacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result,
+               unsigned nthreads = 0);
+
+// Return the Hessian of `f` w.r.t. the symbols `x`. Only the upper triangle
+// is differentiated, the lower one is its mirror image.
+void hessian(const RCP<const Basic> &f, const DenseMatrix &x,
+             DenseMatrix &result, unsigned nthreads = 0);
+// Return the Hessian as a sparse matrix
+void hessian(const RCP<const Basic> &f, const DenseMatrix &x,
+             CSRMatrix &result, unsigned nthreads = 0);
 
 // Differentiate all the elements
 void diff(const DenseMatrix &A, const RCP<const Symbol> &x,
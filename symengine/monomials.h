@@ -14,6 +14,99 @@ namespace SymEngine
 //! Monomial multiplication
 void monomial_mul(const vec_int &A, const vec_int &B, vec_int &C);
 
+#ifdef __SIZEOF_INT128__
+//! Two 64-bit words, for the packed monomials that don't fit into one
+__extension__ typedef unsigned __int128 uint128;
+#endif
+
+/*! Packed representation of exponent vectors: all exponents are stored in
+    one unsigned integer of type `Word`, `bits` bits each, the first exponent
+    in the most significant field. Two packed monomials are multiplied by
+    adding them and compared by comparing them (in lexicographic order of
+    the exponents).
+
+    A packing is set up for a maximum exponent, which must not be exceeded by
+    any product that is formed, so that no field overflows into the next one.
+    `init()` fails if the exponents need more bits than `Word` has, and
+    `pack()` fails for exponents outside of [0, max_exp]; the callers then
+    try a wider `Word` or fall back to the exponent vectors.
+*/
+template <typename Word>
+class MonomialPacking
+{
+private:
+    unsigned int size_;
+    unsigned int bits_;
+    uint64_t max_exp_;
+
+    bool fits(int e) const
+    {
+        return e >= 0 and static_cast<uint64_t>(e) <= max_exp_;
+    }
+    bool fits(unsigned int e) const
+    {
+        return e <= max_exp_;
+    }
+
+public:
+    //! \return false if `size` exponents up to `max_exp` don't fit a `Word`
+    bool init(unsigned int size, uint64_t max_exp)
+    {
+        const unsigned int width = 8 * sizeof(Word);
+        unsigned int bits = 1;
+        while (bits < 64 and (max_exp >> bits) != 0)
+            bits++;
+        // The shifts in pack() and unpack() need bits < width
+        if (size == 0 or bits >= width or bits * size > width)
+            return false;
+        size_ = size;
+        bits_ = bits;
+        max_exp_ = max_exp;
+        return true;
+    }
+
+    template <typename Vec>
+    bool pack(const Vec &v, Word &m) const
+    {
+        SYMENGINE_ASSERT(v.size() == size_)
+        m = 0;
+        for (auto e : v) {
+            if (not fits(e))
+                return false;
+            m = (m << bits_) | static_cast<Word>(e);
+        }
+        return true;
+    }
+
+    //! `v` must have `size` elements
+    template <typename Vec>
+    void unpack(Word m, Vec &v) const
+    {
+        SYMENGINE_ASSERT(v.size() == size_)
+        const Word mask = (Word(1) << bits_) - 1;
+        for (unsigned int i = size_; i-- > 0;) {
+            v[i] = static_cast<typename Vec::value_type>(m & mask);
+            m >>= bits_;
+        }
+    }
+};
+
+//! Hash of packed monomials, which `std::hash` lacks for `uint128`
+struct PackedMonomialHash {
+    std::size_t operator()(uint64_t m) const
+    {
+        return std::hash<uint64_t>()(m);
+    }
+#ifdef __SIZEOF_INT128__
+    std::size_t operator()(uint128 m) const
+    {
+        return std::hash<uint64_t>()(static_cast<uint64_t>(m)
+                                     ^ (static_cast<uint64_t>(m >> 64)
+                                        * 0x9e3779b97f4a7c15ULL));
+    }
+#endif
+};
+
 } // SymEngine
 
 #endif
@@ -86,6 +86,8 @@ hash_t Mul::__hash__() const
 
 bool Mul::__eq__(const Basic &o) const
 {
+    if (this == &o)
+        return true;
     if (is_a<Mul>(o) and eq(*coef_, *(static_cast<const Mul &>(o).coef_))
         and unified_eq(dict_, static_cast<const Mul &>(o).dict_))
         return true;
@@ -127,7 +129,7 @@ RCP<const SymEngine::Basic> Mul::from_dict(const RCP<const Number> &coef,
                 }
             } else {
                 // For coef*x or coef*x**3 we simply return Mul:
-                return make_rcp<const Mul>(coef, std::move(d));
+                return intern(make_rcp<const Mul>(coef, std::move(d)));
             }
         }
         if (coef->is_one()) {
@@ -135,12 +137,12 @@ RCP<const SymEngine::Basic> Mul::from_dict(const RCP<const Number> &coef,
             if (eq(*p->second, *one)) {
                 return p->first;
             }
-            return make_rcp<const Pow>(p->first, p->second);
+            return intern(make_rcp<const Pow>(p->first, p->second));
         } else {
-            return make_rcp<const Mul>(coef, std::move(d));
+            return intern(make_rcp<const Mul>(coef, std::move(d)));
         }
     } else {
-        return make_rcp<const Mul>(coef, std::move(d));
+        return intern(make_rcp<const Mul>(coef, std::move(d)));
     }
 }
 
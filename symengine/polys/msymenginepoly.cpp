@@ -5,18 +5,44 @@ namespace SymEngine
 
 RCP<const Basic> MIntPoly::as_symbolic() const
 {
-    vec_basic args;
+    bool symbols_only = true;
+    for (const auto &sym : vars_)
+        symbols_only = symbols_only and is_a<Symbol>(*sym);
+    if (not symbols_only) {
+        // Generators like x**(1/2) need pow() to simplify their powers
+        vec_basic args;
+        for (const auto &p : poly_.dict_) {
+            RCP<const Basic> res = integer(p.second);
+            int whichvar = 0;
+            for (auto sym : vars_) {
+                if (0 != p.first[whichvar])
+                    res = SymEngine::mul(res,
+                                         pow(sym, integer(p.first[whichvar])));
+                whichvar++;
+            }
+            args.push_back(res);
+        }
+        return SymEngine::add(args);
+    }
+    // With Symbols as the generators, the monomials are distinct and already
+    // in canonical form, so the Add is assembled directly
+    umap_basic_num d;
+    RCP<const Number> coef = zero;
+    d.reserve(poly_.dict_.size());
     for (const auto &p : poly_.dict_) {
-        RCP<const Basic> res = integer(p.second);
-        int whichvar = 0;
-        for (auto sym : vars_) {
+        map_basic_basic m;
+        unsigned int whichvar = 0;
+        for (const auto &sym : vars_) {
             if (0 != p.first[whichvar])
-                res = SymEngine::mul(res, pow(sym, integer(p.first[whichvar])));
+                m.insert({sym, integer(p.first[whichvar])});
             whichvar++;
         }
-        args.push_back(res);
+        if (m.empty())
+            coef = integer(p.second);
+        else
+            insert(d, Mul::from_dict(one, std::move(m)), integer(p.second));
     }
-    return SymEngine::add(args);
+    return Add::from_dict(coef, std::move(d));
 }
 
 hash_t MIntPoly::__hash__() const
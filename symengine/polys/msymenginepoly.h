@@ -1,6 +1,8 @@
 #ifndef SYMENGINE_POLYNOMIALS_MULTIVARIATE
 #define SYMENGINE_POLYNOMIALS_MULTIVARIATE
 
+#include <limits>
+
 #include <symengine/expression.h>
 #include <symengine/monomials.h>
 #include <symengine/polys/uintpoly.h>
@@ -9,6 +11,19 @@
 namespace SymEngine
 {
 
+//! `r += a * b` for polynomial coefficients
+template <typename Value>
+inline void coef_addmul(Value &r, const Value &a, const Value &b)
+{
+    r += a * b;
+}
+
+inline void coef_addmul(integer_class &r, const integer_class &a,
+                        const integer_class &b)
+{
+    mp_addmul(r, a, b);
+}
+
 template <typename Vec, typename Value, typename Wrapper>
 class UDictWrapper
 {
@@ -130,11 +145,56 @@ public:
         return static_cast<Wrapper &>(*this);
     }
 
-    static Wrapper mul(const Wrapper &a, const Wrapper &b)
+    //! \return the largest exponent of any variable (0 if there is none)
+    long max_exponent() const
+    {
+        long m = 0;
+        for (auto const &t : dict_) {
+            for (auto e : t.first)
+                m = std::max(m, static_cast<long>(e));
+        }
+        return m;
+    }
+
+    //! \return the largest total degree of a term (0 if there is none)
+    long max_total_degree() const
+    {
+        long m = 0;
+        for (auto const &t : dict_) {
+            long d = 0;
+            for (auto e : t.first)
+                d += e;
+            m = std::max(m, d);
+        }
+        return m;
+    }
+
+    /*! Multiplies `a` and `b`. With `nthreads` > 1 the product is formed in
+        parallel (if SymEngine was built with WITH_OPENMP), see
+        `mul_heap()`. */
+    static Wrapper mul(const Wrapper &a, const Wrapper &b,
+                       unsigned nthreads = 1)
     {
         SYMENGINE_ASSERT(a.vec_size == b.vec_size)
 
         Wrapper p(a.vec_size);
+        uint64_t max_exp = static_cast<uint64_t>(a.max_exponent())
+                           + static_cast<uint64_t>(b.max_exponent());
+        typedef typename Vec::value_type Exp;
+        if (max_exp > static_cast<uint64_t>(std::numeric_limits<Exp>::max()))
+            throw SymEngineException("Exponent of the product too large");
+        MonomialPacking<uint64_t> packing;
+        bool one_word = packing.init(a.vec_size, max_exp);
+        if (one_word and mul_packed(a, b, packing, p, nthreads))
+            return p;
+#ifdef __SIZEOF_INT128__
+        // Two words if the exponents don't fit into one
+        MonomialPacking<uint128> packing2;
+        if (not one_word and packing2.init(a.vec_size, max_exp)
+            and mul_packed(a, b, packing2, p, nthreads))
+            return p;
+#endif
+
         for (auto const &a_ : a.dict_) {
             for (auto const &b_ : b.dict_) {
 
@@ -160,6 +220,210 @@ public:
         return p;
     }
 
+private:
+    template <typename Word>
+    using PackedTerms = std::vector<std::pair<Word, const Value *>>;
+    template <typename Word>
+    using PackedProduct = std::vector<std::pair<Word, Value>>;
+
+    /* Multiplies `a` and `b` with the monomials packed into words, so that
+     * the inner loops neither allocate nor hash exponent vectors. Returns
+     * false if some exponent can't be packed (e.g. a negative one).
+     *
+     * Dense products, where many of the pairs of terms give the same
+     * monomial, are accumulated in a hash table. Otherwise the hash table
+     * would end up with about one entry per pair of terms, and the terms are
+     * merged in order with a heap instead (see `mul_heap()`). */
+    template <typename Word>
+    static bool mul_packed(const Wrapper &a, const Wrapper &b,
+                           const MonomialPacking<Word> &packing, Wrapper &p,
+                           unsigned nthreads)
+    {
+        PackedTerms<Word> ta, tb;
+        if (not pack_terms(a, packing, ta) or not pack_terms(b, packing, tb))
+            return false;
+
+        PackedProduct<Word> r;
+        // Number of monomials of total degree up to d in n variables
+        double d = a.max_total_degree() + b.max_total_degree(), monomials = 1;
+        for (unsigned int i = 1; i <= a.vec_size; i++)
+            monomials *= (d + i) / i;
+        if (nthreads <= 1 and 4 * monomials < double(ta.size()) * tb.size())
+            mul_hash(ta, tb, r);
+        else
+            mul_heap(ta, tb, r, nthreads);
+
+        Vec target(a.vec_size, 0);
+        p.dict_.reserve(r.size());
+        for (auto &t : r) {
+            packing.unpack(t.first, target);
+            p.dict_.insert({target, std::move(t.second)});
+        }
+        return true;
+    }
+
+    template <typename Word>
+    static bool pack_terms(const Wrapper &a,
+                           const MonomialPacking<Word> &packing,
+                           PackedTerms<Word> &v)
+    {
+        v.reserve(a.dict_.size());
+        Word m;
+        for (auto const &t : a.dict_) {
+            if (not packing.pack(t.first, m))
+                return false;
+            v.push_back({m, &t.second});
+        }
+        return true;
+    }
+
+    template <typename Word>
+    static void mul_hash(const PackedTerms<Word> &ta,
+                         const PackedTerms<Word> &tb, PackedProduct<Word> &out)
+    {
+        flat_hash_map<Word, Value, PackedMonomialHash, std::equal_to<Word>> r;
+        r.reserve(std::min(ta.size() * tb.size(), 4 * (ta.size() + tb.size())));
+        for (auto const &a_ : ta) {
+            for (auto const &b_ : tb)
+                coef_addmul(r[a_.first + b_.first], *a_.second, *b_.second);
+        }
+        out.reserve(r.size());
+        for (auto &t : r) {
+            if (t.second != 0)
+                out.push_back({t.first, std::move(t.second)});
+        }
+    }
+
+    /* Johnson's algorithm: with both factors sorted by decreasing monomials,
+     * the products of one term of `ta` with all terms of `tb` form a sorted
+     * sequence. A heap with the next product of each of these sequences
+     * yields all products in decreasing order, so that equal monomials come
+     * out one after the other and are summed up right away. Besides the
+     * result, this only needs memory for a heap with one entry per term of
+     * the smaller factor.
+     *
+     * With several threads, the range of monomials of the product is split
+     * into intervals, and the products falling into each of them are merged
+     * separately. */
+    template <typename Word>
+    static void mul_heap(PackedTerms<Word> ta, PackedTerms<Word> tb,
+                         PackedProduct<Word> &out, unsigned nthreads)
+    {
+        if (ta.size() > tb.size())
+            std::swap(ta, tb);
+        auto greater = [](const std::pair<Word, const Value *> &x,
+                          const std::pair<Word, const Value *> &y) {
+            return x.first > y.first;
+        };
+        std::sort(ta.begin(), ta.end(), greater);
+        std::sort(tb.begin(), tb.end(), greater);
+
+        if (nthreads <= 1 or ta.size() * tb.size() < 4096) {
+            mul_heap_range(ta, tb, Word(0), ~Word(0), out);
+            return;
+        }
+
+        // Split at quantiles of a sample of the products, into more
+        // intervals than threads to balance the load
+        std::vector<Word> sample;
+        std::size_t step_a = std::max<std::size_t>(1, ta.size() / 64),
+                    step_b = std::max<std::size_t>(1, tb.size() / 64);
+        for (std::size_t i = 0; i < ta.size(); i += step_a) {
+            for (std::size_t j = 0; j < tb.size(); j += step_b)
+                sample.push_back(ta[i].first + tb[j].first);
+        }
+        std::sort(sample.begin(), sample.end(), std::greater<Word>());
+        std::size_t nranges = 4 * nthreads;
+        // Interval k is [bounds[k + 1], bounds[k] - 1]
+        std::vector<Word> bounds;
+        for (std::size_t k = 1; k < nranges; k++) {
+            Word s = sample[k * sample.size() / nranges];
+            if (s > 0 and (bounds.empty() or s < bounds.back()))
+                bounds.push_back(s);
+        }
+        bounds.push_back(0);
+        std::vector<PackedProduct<Word>> outs(bounds.size());
+        long n = bounds.size();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+        for (long k = 0; k < n; k++) {
+            Word hi = (k == 0) ? ~Word(0) : bounds[k - 1] - 1;
+            mul_heap_range(ta, tb, bounds[k], hi, outs[k]);
+        }
+
+        std::size_t size = 0;
+        for (auto &o : outs)
+            size += o.size();
+        out.reserve(size);
+        for (auto &o : outs) {
+            for (auto &t : o)
+                out.push_back(std::move(t));
+        }
+    }
+
+    // Appends the terms of the product with monomials in [lo, hi] to `out`
+    template <typename Word>
+    static void mul_heap_range(const PackedTerms<Word> &ta,
+                               const PackedTerms<Word> &tb, Word lo, Word hi,
+                               PackedProduct<Word> &out)
+    {
+        struct Entry {
+            Word m;
+            std::size_t i, j;
+        };
+        auto less = [](const Entry &x, const Entry &y) { return x.m < y.m; };
+
+        // tb is sorted, so the products of ta[i] with monomials in [lo, hi]
+        // are those of a contiguous range of tb, [j, end[i])
+        std::vector<Entry> heap;
+        std::vector<std::size_t> end(ta.size());
+        heap.reserve(ta.size());
+        for (std::size_t i = 0; i < ta.size(); i++) {
+            Word m = ta[i].first;
+            if (m > hi)
+                continue;
+            auto first = std::partition_point(
+                tb.begin(), tb.end(),
+                [&](const std::pair<Word, const Value *> &t) {
+                    return t.first > hi - m;
+                });
+            auto last = tb.end();
+            if (m < lo) {
+                last = std::partition_point(
+                    first, tb.end(),
+                    [&](const std::pair<Word, const Value *> &t) {
+                        return t.first >= lo - m;
+                    });
+            }
+            if (first != last) {
+                heap.push_back({m + first->first, i,
+                                std::size_t(first - tb.begin())});
+                end[i] = last - tb.begin();
+            }
+        }
+        std::make_heap(heap.begin(), heap.end(), less);
+
+        while (not heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), less);
+            Entry &e = heap.back();
+            if (out.empty() or out.back().first != e.m) {
+                if (not out.empty() and out.back().second == 0)
+                    out.pop_back();
+                out.push_back({e.m, Value(0)});
+            }
+            coef_addmul(out.back().second, *ta[e.i].second, *tb[e.j].second);
+            if (++e.j < end[e.i]) {
+                e.m = ta[e.i].first + tb[e.j].first;
+                std::push_heap(heap.begin(), heap.end(), less);
+            } else {
+                heap.pop_back();
+            }
+        }
+        if (not out.empty() and out.back().second == 0)
+            out.pop_back();
+    }
+
+public:
+
     static Wrapper pow(const Wrapper &a, unsigned int p)
     {
         Wrapper tmp = a, res(a.vec_size);
@@ -529,6 +793,16 @@ RCP<const Poly> mul_mpoly(const Poly &a, const Poly &b)
     return Poly::from_container(s, std::move(x));
 }
 
+//! Multiplies `a` and `b` using up to `nthreads` threads
+template <typename Poly>
+RCP<const Poly> mul_mpoly(const Poly &a, const Poly &b, unsigned nthreads)
+{
+    typename Poly::container_type x, y;
+    set_basic s = get_translated_container(x, y, a, b);
+    return Poly::from_container(
+        s, Poly::container_type::mul(x, y, nthreads));
+}
+
 template <typename Poly>
 RCP<const Poly> neg_mpoly(const Poly &a)
 {
@@ -64,6 +64,8 @@ hash_t Pow::__hash__() const
 
 bool Pow::__eq__(const Basic &o) const
 {
+    if (this == &o)
+        return true;
     if (is_a<Pow>(o) and eq(*base_, *(static_cast<const Pow &>(o).base_))
         and eq(*exp_, *(static_cast<const Pow &>(o).exp_)))
         return true;
@@ -129,13 +131,13 @@ RCP<const Basic> pow(const RCP<const Basic> &a, const RCP<const Basic> &b)
                 return static_cast<const Rational &>(*b)
                     .rpowrat(static_cast<const Integer &>(*a));
             } else if (is_a<Complex>(*a)) {
-                return make_rcp<const Pow>(a, b);
+                return intern(make_rcp<const Pow>(a, b));
             } else {
                 return rcp_static_cast<const Number>(a)
                     ->pow(*rcp_static_cast<const Number>(b));
             }
         } else if (is_a<Complex>(*b)) {
-            return make_rcp<const Pow>(a, b);
+            return intern(make_rcp<const Pow>(a, b));
         } else {
             return rcp_static_cast<const Number>(a)
                 ->pow(*rcp_static_cast<const Number>(b));
@@ -154,7 +156,7 @@ RCP<const Basic> pow(const RCP<const Basic> &a, const RCP<const Basic> &b)
         RCP<const Pow> A = rcp_static_cast<const Pow>(a);
         return pow(A->get_base(), mul(A->get_exp(), b));
     }
-    return make_rcp<const Pow>(a, b);
+    return intern(make_rcp<const Pow>(a, b));
 }
 
 // This function can overflow, but it is fast.
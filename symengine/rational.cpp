@@ -43,6 +43,9 @@ RCP<const Number> Rational::from_mpq(rational_class &&i)
 
 RCP<const Number> Rational::from_two_ints(const Integer &n, const Integer &d)
 {
+    long n_, d_;
+    if (n.get_si(n_) and d.get_si(d_))
+        return from_two_ints(n_, d_);
     if (d.i == 0)
         throw DivisionByZeroError("Division By Zero");
     rational_class q(n.i, d.i);
@@ -54,10 +57,120 @@ RCP<const Number> Rational::from_two_ints(const Integer &n, const Integer &d)
     return Rational::from_mpq(std::move(q));
 }
 
+namespace
+{
+
+// Euclid's algorithm on magnitudes, gcd(0, 0) == 0
+inline unsigned long gcd_ui(unsigned long a, unsigned long b)
+{
+    while (b != 0) {
+        unsigned long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+inline unsigned long abs_ui(long a)
+{
+    return a < 0 ? 0UL - static_cast<unsigned long>(a)
+                 : static_cast<unsigned long>(a);
+}
+
+// Halves and thirds n/d with |n| <= rational_cache_max are cached, just like
+// the small integers (see `integer_cache()`)
+const long rational_cache_max = 64;
+
+const RCP<const Number> &cached_rational(long n, long d)
+{
+    static const RCP<const Number> *cache = []() {
+        const long m = 2 * rational_cache_max + 1;
+        RCP<const Number> *c = new RCP<const Number>[2 * m];
+        for (long d = 2; d <= 3; d++) {
+            for (long n = -rational_cache_max; n <= rational_cache_max; n++) {
+                if (n % d == 0)
+                    continue;
+                c[(d - 2) * m + n + rational_cache_max]
+                    = make_rcp<const Rational>(
+                        rational_class(integer_class(n), integer_class(d)));
+            }
+        }
+        return c;
+    }();
+    return cache[(d - 2) * (2 * rational_cache_max + 1) + n
+                 + rational_cache_max];
+}
+
+// Returns n/d for d > 0 and gcd(n, d) == 1
+RCP<const Number> from_canonical_si(long n, long d)
+{
+    if (d == 1)
+        return integer(n);
+    if (d <= 3 and n >= -rational_cache_max and n <= rational_cache_max)
+        return cached_rational(n, d);
+    return make_rcp<const Rational>(
+        rational_class(integer_class(n), integer_class(d)));
+}
+
+// Reduces n/d (d > 0, n and d not LONG_MIN) to canonical form
+RCP<const Number> from_si(long n, long d)
+{
+    long g
+        = static_cast<long>(gcd_ui(abs_ui(n), static_cast<unsigned long>(d)));
+    return from_canonical_si(n / g, d / g);
+}
+
+// Computes n1/d1 + n2/d2 for canonical operands in overflow checked `long`
+// arithmetic; false on overflow
+bool checked_add_si(long n1, long d1, long n2, long d2,
+                    RCP<const Number> &r)
+{
+    long g = static_cast<long>(gcd_ui(static_cast<unsigned long>(d1),
+                                      static_cast<unsigned long>(d2)));
+    long n, d, t1, t2;
+    if (not checked_mul(n1, d2 / g, t1) or not checked_mul(n2, d1 / g, t2)
+        or not checked_add(t1, t2, n) or not checked_mul(d1, d2 / g, d)
+        or n == LONG_MIN)
+        return false;
+    r = from_si(n, d);
+    return true;
+}
+
+// Computes n1/d1 * n2/d2 for canonical operands in overflow checked `long`
+// arithmetic; false on overflow
+bool checked_mul_si(long n1, long d1, long n2, long d2,
+                    RCP<const Number> &r)
+{
+    if (n1 == 0 or n2 == 0) {
+        r = integer(0);
+        return true;
+    }
+    // Cancelling the cross terms first keeps the result canonical
+    long g1
+        = static_cast<long>(gcd_ui(abs_ui(n1), static_cast<unsigned long>(d2)));
+    long g2
+        = static_cast<long>(gcd_ui(abs_ui(n2), static_cast<unsigned long>(d1)));
+    long n, d;
+    if (not checked_mul(n1 / g1, n2 / g2, n)
+        or not checked_mul(d1 / g2, d2 / g1, d))
+        return false;
+    r = from_canonical_si(n, d);
+    return true;
+}
+
+} // anonymous namespace
+
 RCP<const Number> Rational::from_two_ints(long n, long d)
 {
     if (d == 0)
         throw DivisionByZeroError("Division By Zero");
+    if (n != LONG_MIN and d != LONG_MIN) {
+        if (d < 0) {
+            n = -n;
+            d = -d;
+        }
+        return from_si(n, d);
+    }
     rational_class q(n, d);
 
     // This is potentially slow, but has to be done, since 'n/d' might not be
@@ -67,6 +180,76 @@ RCP<const Number> Rational::from_two_ints(long n, long d)
     return Rational::from_mpq(q);
 }
 
+RCP<const Number> Rational::addrat(const Rational &other) const
+{
+    long n1, d1, n2, d2;
+    RCP<const Number> r;
+    if (get_si(n1, d1) and other.get_si(n2, d2)
+        and checked_add_si(n1, d1, n2, d2, r))
+        return r;
+    return from_mpq(this->i + other.i);
+}
+
+RCP<const Number> Rational::addrat(const Integer &other) const
+{
+    long n1, d1, n2;
+    RCP<const Number> r;
+    if (get_si(n1, d1) and other.get_si(n2)
+        and checked_add_si(n1, d1, n2, 1, r))
+        return r;
+    return from_mpq(this->i + other.i);
+}
+
+RCP<const Number> Rational::subrat(const Rational &other) const
+{
+    long n1, d1, n2, d2;
+    RCP<const Number> r;
+    if (get_si(n1, d1) and other.get_si(n2, d2)
+        and checked_add_si(n1, d1, -n2, d2, r))
+        return r;
+    return from_mpq(this->i - other.i);
+}
+
+RCP<const Number> Rational::subrat(const Integer &other) const
+{
+    long n1, d1, n2;
+    RCP<const Number> r;
+    if (get_si(n1, d1) and other.get_si(n2) and n2 != LONG_MIN
+        and checked_add_si(n1, d1, -n2, 1, r))
+        return r;
+    return from_mpq(this->i - other.i);
+}
+
+RCP<const Number> Rational::rsubrat(const Integer &other) const
+{
+    long n1, d1, n2;
+    RCP<const Number> r;
+    if (get_si(n1, d1) and other.get_si(n2)
+        and checked_add_si(n2, 1, -n1, d1, r))
+        return r;
+    return from_mpq(other.i - this->i);
+}
+
+RCP<const Number> Rational::mulrat(const Rational &other) const
+{
+    long n1, d1, n2, d2;
+    RCP<const Number> r;
+    if (get_si(n1, d1) and other.get_si(n2, d2)
+        and checked_mul_si(n1, d1, n2, d2, r))
+        return r;
+    return from_mpq(this->i * other.i);
+}
+
+RCP<const Number> Rational::mulrat(const Integer &other) const
+{
+    long n1, d1, n2;
+    RCP<const Number> r;
+    if (get_si(n1, d1) and other.get_si(n2)
+        and checked_mul_si(n1, d1, n2, 1, r))
+        return r;
+    return from_mpq(this->i * other.i);
+}
+
 hash_t Rational::__hash__() const
 {
     // only the least significant bits that fit into "signed long int" are
@@ -45,6 +45,20 @@ public:
     * */
     static RCP<const Number> from_two_ints(const Integer &n, const Integer &d);
     static RCP<const Number> from_two_ints(const long n, const long d);
+    /*! \return `true` and sets `n`, `d` to the numerator and denominator if
+     *  both fit into a `long` (and are not LONG_MIN, so that they can be
+     *  negated).
+     * */
+    inline bool get_si(long &n, long &d) const
+    {
+        const integer_class &num = SymEngine::get_num(this->i);
+        const integer_class &den = SymEngine::get_den(this->i);
+        if (not mp_fits_slong_p(num) or not mp_fits_slong_p(den))
+            return false;
+        n = mp_get_si(num);
+        d = mp_get_si(den);
+        return n != LONG_MIN and d != LONG_MIN;
+    }
     //! Convert to `rational_class`.
     inline rational_class as_rational_class() const
     {
@@ -95,49 +109,28 @@ public:
     /*! Add Rationals
      * \param other of type Rational
      * */
-    inline RCP<const Number> addrat(const Rational &other) const
-    {
-        return from_mpq(this->i + other.i);
-    }
+    RCP<const Number> addrat(const Rational &other) const;
     /*! Add Rationals
      * \param other of type Integer
      * */
-    inline RCP<const Number> addrat(const Integer &other) const
-    {
-        return from_mpq(this->i + other.i);
-    }
+    RCP<const Number> addrat(const Integer &other) const;
     /*! Subtract Rationals
      * \param other of type Rational
      * */
-    inline RCP<const Number> subrat(const Rational &other) const
-    {
-        return from_mpq(this->i - other.i);
-    }
+    RCP<const Number> subrat(const Rational &other) const;
     /*! Subtract Rationals
      * \param other of type Integer
      * */
-    inline RCP<const Number> subrat(const Integer &other) const
-    {
-        return from_mpq(this->i - other.i);
-    }
-    inline RCP<const Number> rsubrat(const Integer &other) const
-    {
-        return from_mpq(other.i - this->i);
-    }
+    RCP<const Number> subrat(const Integer &other) const;
+    RCP<const Number> rsubrat(const Integer &other) const;
     /*! Multiply Rationals
      * \param other of type Rational
      * */
-    inline RCP<const Number> mulrat(const Rational &other) const
-    {
-        return from_mpq(this->i * other.i);
-    }
+    RCP<const Number> mulrat(const Rational &other) const;
     /*! Multiply Rationals
      * \param other of type Integer
      * */
-    inline RCP<const Number> mulrat(const Integer &other) const
-    {
-        return from_mpq(this->i * other.i);
-    }
+    RCP<const Number> mulrat(const Integer &other) const;
     /*! Divide Rationals
      * \param other of type Rational
      * */
@@ -11,15 +11,138 @@ RCP<const Basic> msubs(const RCP<const Basic> &x,
 RCP<const Basic> ssubs(const RCP<const Basic> &x,
                        const map_basic_basic &subs_dict);
 
+/*! Replaces the keys of `subs_dict` in an expression.
+ *
+ * Every distinct subexpression is substituted once, shared subexpressions
+ * are looked up in `visited_`. A node none of whose arguments changed is
+ * returned as it is instead of being rebuilt, and so is a subexpression
+ * whose symbol signature rules out all keys. Large dictionaries are
+ * looked up in a hash table instead of `subs_dict`. Deep expressions are
+ * substituted by `visit_args()` with an explicit stack.
+ * */
 class SubsVisitor : public BaseVisitor<SubsVisitor>
 {
 protected:
     RCP<const Basic> result_;
     const map_basic_basic &subs_dict_;
+    // The results of the subexpressions substituted so far
+    umap_basic_basic visited_;
+    // A copy of `subs_dict_` for the dictionaries with many entries
+    umap_basic_basic lookup_;
+    // Whether some keys are Numbers or Muls, which are looked up for the
+    // coefficients and terms of an Add
+    bool number_keys_ = false;
+    bool mul_keys_ = false;
+    // The union of the signatures of the keys, and whether some key has no
+    // symbols. Otherwise, a subexpression with none of their symbols
+    // contains no key.
+    hash_t keys_signature_ = 0;
+    bool constant_keys_ = false;
+    // The depth of the recursion of `apply()` through `bvisit`
+    unsigned depth_ = 0;
+
+    //! \return the value of `x` in `subs_dict_` or null
+    const RCP<const Basic> *find(const RCP<const Basic> &x) const
+    {
+        if (lookup_.empty()) {
+            auto it = subs_dict_.find(x);
+            return it == subs_dict_.end() ? nullptr : &it->second;
+        }
+        auto it = lookup_.find(x);
+        return it == lookup_.end() ? nullptr : &it->second;
+    }
+
+    //! \return `true` if `x` is not a key and can't contain one
+    bool has_no_keys(const Basic &x) const
+    {
+        return is_a<Symbol>(x) or is_a_Number(x)
+               or (not constant_keys_
+                   and (symbol_signature(x) & keys_signature_) == 0);
+    }
+
+    typedef std::vector<std::pair<RCP<const Basic>, bool>> stack_type;
+
+    //! Pushes the arguments of `x` that its `bvisit` substitutes by a visit
+    void push_args(const Basic &x, stack_type &stack) const
+    {
+        auto push = [&](const RCP<const Basic> &a) {
+            if (find(a) == nullptr and not has_no_keys(*a)
+                and visited_.find(a) == visited_.end())
+                stack.push_back({a, false});
+        };
+        if (is_a<Add>(x)) {
+            for (const auto &p : static_cast<const Add &>(x).get_dict()) {
+                if (eq(*p.second, *one)) {
+                    if (find(p.first) != nullptr)
+                        continue;
+                } else if (mul_keys_
+                           and find(Add::from_dict(zero, {{p.first, p.second}}))
+                                   != nullptr) {
+                    continue;
+                }
+                push(p.first);
+            }
+        } else if (is_a<Mul>(x)) {
+            for (const auto &p : static_cast<const Mul &>(x).get_dict()) {
+                if (eq(*p.second, *one))
+                    push(p.first);
+                else
+                    push(make_rcp<Pow>(p.first, p.second));
+            }
+        } else if (is_a<Pow>(x) or is_a_sub<OneArgFunction>(x)
+                   or is_a_sub<TwoArgFunction>(x)
+                   or is_a_sub<MultiArgFunction>(x)
+                   or is_a_sub<FunctionSymbol>(x)) {
+            for (const auto &a : x.get_args())
+                push(a);
+        }
+    }
+
+    /*! Substitutes the arguments of `x`, and theirs, before `x` itself, in
+     *  a loop with an explicit stack instead of the recursion of `bvisit`,
+     *  so that deep expressions don't overflow the stack. The `bvisit` of
+     *  each node then finds its arguments in `visited_`. Derivatives and
+     *  Subs substitute their arguments themselves.
+     *
+     *  The extra lookups make this slower than the recursion, so `apply()`
+     *  only switches to it beyond a recursion depth of `max_depth`.
+     * */
+    void visit_args(const Basic &x)
+    {
+        stack_type stack;
+        push_args(x, stack);
+        while (not stack.empty()) {
+            RCP<const Basic> y = stack.back().first;
+            if (visited_.find(y) != visited_.end()) {
+                // Reached through another node in the meantime
+                stack.pop_back();
+            } else if (stack.back().second) {
+                stack.pop_back();
+                y->accept(*this);
+                visited_.insert({y, result_});
+            } else {
+                stack.back().second = true;
+                push_args(*y, stack);
+            }
+        }
+    }
 
 public:
+    //! The depth of the recursion beyond which `visit_args()` is used
+    static const unsigned max_depth = 1000;
+
     SubsVisitor(const map_basic_basic &subs_dict) : subs_dict_(subs_dict)
     {
+        for (const auto &p : subs_dict_) {
+            number_keys_ = number_keys_ or is_a_Number(*p.first);
+            mul_keys_ = mul_keys_ or is_a<Mul>(*p.first);
+            hash_t signature = symbol_signature(*p.first);
+            keys_signature_ |= signature;
+            constant_keys_ = constant_keys_ or signature == 0;
+        }
+        // Below this size, the binary search in `subs_dict_` is faster
+        if (subs_dict_.size() > 8)
+            lookup_.insert(subs_dict_.begin(), subs_dict_.end());
     }
     // TODO : Polynomials, Series, Sets
     void bvisit(const Basic &x)
@@ -29,40 +152,57 @@ public:
 
     void bvisit(const Add &x)
     {
-        SymEngine::umap_basic_num d;
-        RCP<const Number> coef;
+        bool changed = false;
+        RCP<const Number> coef = x.coef_;
+        // The terms to add to `coef`: the terms of `x` with their
+        // coefficients, or the values that replace them with coefficient 1
+        std::vector<std::pair<RCP<const Number>, RCP<const Basic>>> terms;
+        terms.reserve(x.dict_.size());
 
-        auto it = subs_dict_.find(x.coef_);
-        if (it != subs_dict_.end()) {
+        const RCP<const Basic> *v;
+        if (number_keys_ and (v = find(x.coef_)) != nullptr) {
             coef = zero;
-            Add::coef_dict_add_term(outArg(coef), d, one, it->second);
-        } else {
-            coef = x.coef_;
+            terms.push_back({one, *v});
+            changed = true;
         }
 
         for (const auto &p : x.dict_) {
-            auto it
-                = subs_dict_.find(Add::from_dict(zero, {{p.first, p.second}}));
-            if (it != subs_dict_.end()) {
-                Add::coef_dict_add_term(outArg(coef), d, one, it->second);
+            // The term is `p.first` if its coefficient is 1, and a Mul
+            // otherwise
+            v = nullptr;
+            if (eq(*p.second, *one)) {
+                v = find(p.first);
+            } else if (mul_keys_) {
+                v = find(Add::from_dict(zero, {{p.first, p.second}}));
+            }
+            if (v != nullptr) {
+                terms.push_back({one, *v});
+                changed = true;
+            } else if (number_keys_ and (v = find(p.second)) != nullptr) {
+                terms.push_back({one, mul(*v, apply(p.first))});
+                changed = true;
             } else {
-                it = subs_dict_.find(p.second);
-                if (it != subs_dict_.end()) {
-                    Add::coef_dict_add_term(outArg(coef), d, one,
-                                            mul(it->second, apply(p.first)));
-                } else {
-                    Add::coef_dict_add_term(outArg(coef), d, p.second,
-                                            apply(p.first));
-                }
+                RCP<const Basic> t = apply(p.first);
+                changed = changed or t.get() != p.first.get();
+                terms.push_back({p.second, t});
             }
         }
+        if (not changed) {
+            result_ = x.rcp_from_this();
+            return;
+        }
+
+        SymEngine::umap_basic_num d;
+        for (const auto &t : terms)
+            Add::coef_dict_add_term(outArg(coef), d, t.first, t.second);
         result_ = Add::from_dict(coef, std::move(d));
     }
 
     void bvisit(const Mul &x)
     {
-        RCP<const Number> coef = x.coef_;
-        map_basic_basic d;
+        std::vector<RCP<const Basic>> factors;
+        factors.reserve(x.dict_.size());
+        bool changed = false;
         for (const auto &p : x.dict_) {
             RCP<const Basic> factor_old;
             if (eq(*p.second, *one)) {
@@ -71,7 +211,24 @@ public:
                 factor_old = make_rcp<Pow>(p.first, p.second);
             }
             RCP<const Basic> factor = apply(factor_old);
-            if (factor == factor_old) {
+            if (factor.get() == factor_old.get()) {
+                factors.push_back(RCP<const Basic>());
+            } else {
+                factors.push_back(factor);
+                changed = true;
+            }
+        }
+        if (not changed) {
+            result_ = x.rcp_from_this();
+            return;
+        }
+
+        RCP<const Number> coef = x.coef_;
+        map_basic_basic d;
+        auto f = factors.begin();
+        for (const auto &p : x.dict_) {
+            const RCP<const Basic> &factor = *f++;
+            if (factor.is_null()) {
                 // TODO: Check if Mul::dict_add_term is enough
                 Mul::dict_add_term_new(outArg(coef), d, p.second, p.first);
             } else if (is_a_Number(*factor)) {
@@ -236,14 +393,38 @@ public:
 
     RCP<const Basic> apply(const RCP<const Basic> &x)
     {
-        auto it = subs_dict_.find(x);
-        if (it != subs_dict_.end()) {
-            result_ = it->second;
+        const RCP<const Basic> *v = find(x);
+        if (v != nullptr) {
+            result_ = *v;
+        } else if (has_no_keys(*x)) {
+            result_ = x;
         } else {
-            x->accept(*this);
+            auto it = visited_.find(x);
+            if (it != visited_.end()) {
+                // An unchanged subexpression is returned as it is, so that
+                // the callers see it didn't change
+                if (it->second.get() == it->first.get())
+                    result_ = x;
+                else
+                    result_ = it->second;
+            } else {
+                if (depth_ >= max_depth)
+                    visit_args(*x);
+                ++depth_;
+                x->accept(*this);
+                --depth_;
+                visited_.insert({x, result_});
+            }
         }
         return result_;
     }
+
+    //! \return `x` with its arguments substituted, even if `x` is a key
+    RCP<const Basic> apply_args(const Basic &x)
+    {
+        x.accept(*this);
+        return result_;
+    }
 };
 
 class MSubsVisitor : public BaseVisitor<MSubsVisitor, SubsVisitor>
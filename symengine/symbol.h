@@ -49,7 +49,7 @@ public:
 //! inline version to return `Symbol`
 inline RCP<const Symbol> symbol(const std::string &name)
 {
-    return make_rcp<const Symbol>(name);
+    return intern(make_rcp<const Symbol>(name));
 }
 
 } // SymEngine
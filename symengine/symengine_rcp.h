@@ -347,6 +347,33 @@ public:
     {
     }
 
+    // Don't use these two functions directly. They are only needed by caches
+    // that keep weak (non-owning) pointers to instances, like the interning
+    // table in basic.cpp. `_try_incref()` increments the reference counter
+    // unless it already dropped to zero (i.e. the instance is being deleted)
+    // and returns whether it did so. `_decref()` must only be called after
+    // a successful `_try_incref()` while another RCP still owns the instance.
+    bool _try_incref() const
+    {
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+        unsigned int c = refcount_.load();
+        while (c != 0) {
+            if (refcount_.compare_exchange_weak(c, c + 1))
+                return true;
+        }
+        return false;
+#else
+        if (refcount_ == 0)
+            return false;
+        ++refcount_;
+        return true;
+#endif
+    }
+    void _decref() const
+    {
+        --refcount_;
+    }
+
 private:
 #else
     mutable RCP<T> weak_self_ptr_;
@@ -1121,3 +1121,72 @@ TEST_CASE("Expand3: arit", "[arit]")
                      .count()
               << "ms" << std::endl;
 }
+
+TEST_CASE("Expand with several threads: arit", "[arit]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> w = symbol("w");
+    RCP<const Basic> e, f, r1, r2;
+
+    // The threads are only used if SymEngine is built with WITH_OPENMP, as
+    // in the OpenMP build on Travis. Otherwise the expansions are serial.
+    // Large enough to be split across the threads
+    e = pow(add(add(add(x, y), z), w), integer(12));
+    f = mul(e, add(e, w));
+    r1 = expand(f);
+    for (unsigned n : {1, 2, 4}) {
+        r2 = expand(f, n);
+        REQUIRE(eq(*r1, *r2));
+    }
+
+    // Terms that cancel between the parts of different threads
+    e = pow(add(add(add(x, y), integer(2)), Rational::from_two_ints(1, 3)),
+            integer(20));
+    f = sub(mul(e, add(e, w)), pow(e, integer(2)));
+    r1 = expand(f);
+    r2 = expand(f, 4);
+    REQUIRE(eq(*r1, *r2));
+    REQUIRE(eq(*r2, *expand(mul(e, w))));
+}
+
+TEST_CASE("Expand polynomials: arit", "[arit]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> r;
+
+    // Large enough to be expanded as an MIntPoly
+    r = expand(pow(add(x, y), integer(20)));
+    REQUIRE(is_a<Add>(*r));
+    REQUIRE(rcp_static_cast<const Add>(r)->dict_.size() == 21);
+    REQUIRE(eq(*rcp_static_cast<const Add>(r)->dict_.at(
+                   mul(pow(x, integer(10)), pow(y, integer(10)))),
+               *integer(184756)));
+    REQUIRE(eq(*rcp_static_cast<const Add>(r)->dict_.at(pow(x, integer(20))),
+               *integer(1)));
+
+    // Same result as the generic expansion, including cancellations and the
+    // constant term
+    RCP<const Basic> e = pow(add(add(x, mul(integer(2), y)), integer(-3)),
+                             integer(6));
+    RCP<const Basic> f = mul(e, pow(sub(mul(x, z), y), integer(3)));
+    f = sub(f, mul(e, pow(y, integer(3))));
+    r = expand(f);
+    RCP<const Basic> r2 = expand(f, 2);
+    REQUIRE(eq(*r, *r2));
+    REQUIRE(eq(*expand(sub(f, r)), *zero));
+
+    // Not polynomials with integer coefficients
+    f = pow(add(add(x, y), Rational::from_two_ints(1, 2)), integer(8));
+    r = expand(f);
+    REQUIRE(eq(*rcp_static_cast<const Add>(r)->dict_.at(pow(x, integer(8))),
+               *integer(1)));
+    REQUIRE(eq(*rcp_static_cast<const Add>(r)->coef_,
+               *Rational::from_two_ints(1, 256)));
+    f = mul(pow(add(x, y), integer(10)), pow(x, integer(-1)));
+    r = expand(f);
+    REQUIRE(rcp_static_cast<const Add>(r)->dict_.size() == 11);
+}
@@ -15,6 +15,7 @@ using SymEngine::map_basic_basic;
 using SymEngine::umap_basic_basic;
 using SymEngine::map_uint_mpz;
 using SymEngine::unified_compare;
+using SymEngine::unified_eq;
 using SymEngine::map_int_Expr;
 using SymEngine::multiset_basic;
 using SymEngine::vec_basic;
@@ -31,6 +32,8 @@ using SymEngine::make_rcp;
 using SymEngine::print_stack_on_segfault;
 using SymEngine::Complex;
 using SymEngine::has_symbol;
+using SymEngine::may_have_symbol;
+using SymEngine::symbol_signature;
 using SymEngine::coeff;
 using SymEngine::is_a;
 using SymEngine::rcp_static_cast;
@@ -40,6 +43,13 @@ using SymEngine::function_symbol;
 using SymEngine::rational_class;
 using SymEngine::pi;
 using SymEngine::diff;
+using SymEngine::DiffCache;
+using SymEngine::gradient;
+using SymEngine::gradient_outputs;
+using SymEngine::expand;
+using SymEngine::real_double;
+using SymEngine::eval_double;
+using SymEngine::SymEngineException;
 using SymEngine::sdiff;
 using SymEngine::DivisionByZeroError;
 
@@ -204,6 +214,142 @@ TEST_CASE("Symbol dict: Basic", "[basic]")
     REQUIRE(unified_compare(msba, {x, y, i3}) == -1);
 }
 
+TEST_CASE("flat containers: Basic", "[basic]")
+{
+    vec_basic syms;
+    for (int i = 0; i < 20; i++)
+        syms.push_back(symbol("x" + std::to_string(i)));
+
+    // Grows past the inline capacity and keeps the RCPBasicKeyLess order
+    map_basic_basic m;
+    set_basic s;
+    multiset_basic ms;
+    for (int i = 19; i >= 0; i--) {
+        REQUIRE(m.insert({syms[i], integer(i)}).second);
+        REQUIRE(s.insert(syms[i]).second);
+        ms.insert(syms[i]);
+        ms.insert(syms[i]);
+    }
+    REQUIRE(not m.insert({syms[3], integer(5)}).second);
+    REQUIRE(not s.insert(syms[3]).second);
+    REQUIRE(m.size() == 20);
+    REQUIRE(s.size() == 20);
+    REQUIRE(ms.size() == 40);
+    REQUIRE(ms.count(syms[3]) == 2);
+    REQUIRE(std::is_sorted(s.begin(), s.end(), SymEngine::RCPBasicKeyLess()));
+    REQUIRE(std::equal(s.begin(), s.end(), m.begin(),
+                       [](const RCP<const Basic> &a,
+                          const std::pair<RCP<const Basic>, RCP<const Basic>>
+                              &b) { return a.get() == b.first.get(); }));
+    for (int i = 0; i < 20; i++) {
+        REQUIRE(eq(*m.at(syms[i]), *integer(i)));
+        REQUIRE(s.count(syms[i]) == 1);
+    }
+    REQUIRE(m.find(symbol("y")) == m.end());
+
+    m[syms[5]] = integer(7);
+    REQUIRE(eq(*m[syms[5]], *integer(7)));
+    REQUIRE(m.erase(syms[5]) == 1);
+    REQUIRE(m.erase(syms[5]) == 0);
+    REQUIRE(ms.erase(syms[5]) == 2);
+    s.erase(s.find(syms[5]));
+    REQUIRE(m.size() == 19);
+    REQUIRE(s.size() == 19);
+    REQUIRE(ms.size() == 38);
+
+    // Copies and moves of both inline and heap allocated containers
+    map_basic_basic m2 = m;
+    REQUIRE(unified_eq(m, m2));
+    map_basic_basic m3 = std::move(m2);
+    REQUIRE(unified_eq(m, m3));
+    REQUIRE(m2.empty());
+    set_basic s2 = {syms[1], syms[0]};
+    set_basic s3 = std::move(s2);
+    REQUIRE(s3.size() == 2);
+    REQUIRE(unified_compare(s3, set_basic({syms[0], syms[1]})) == 0);
+    s3 = s;
+    REQUIRE(unified_eq(s3, s));
+    s3.swap(s2);
+    REQUIRE(s3.empty());
+    REQUIRE(s2.size() == 19);
+}
+
+TEST_CASE("flat hash map: Basic", "[basic]")
+{
+    vec_basic syms;
+    for (int i = 0; i < 200; i++)
+        syms.push_back(symbol("x" + std::to_string(i)));
+
+    umap_basic_num m;
+    REQUIRE(m.empty());
+    REQUIRE(m.find(syms[0]) == m.end());
+    REQUIRE(m.begin() == m.end());
+    for (int i = 0; i < 200; i++) {
+        auto r = m.insert({syms[i], integer(i)});
+        REQUIRE(r.second);
+        REQUIRE(eq(*r.first->second, *integer(i)));
+    }
+    REQUIRE(m.size() == 200);
+    REQUIRE(not m.insert({syms[3], integer(7)}).second);
+    REQUIRE(eq(*m.at(syms[3]), *integer(3)));
+    CHECK_THROWS_AS(m.at(symbol("y")), std::out_of_range);
+    m[syms[3]] = integer(-3);
+    REQUIRE(eq(*m[syms[3]], *integer(-3)));
+    unsigned n = 0;
+    for (const auto &p : m) {
+        REQUIRE(m.count(p.first) == 1);
+        n++;
+    }
+    REQUIRE(n == 200);
+
+    // Erase every other key, the rest must still be found
+    for (int i = 0; i < 200; i += 2)
+        REQUIRE(m.erase(syms[i]) == 1);
+    REQUIRE(m.erase(syms[0]) == 0);
+    REQUIRE(m.size() == 100);
+    for (int i = 0; i < 200; i++)
+        REQUIRE(m.count(syms[i]) == static_cast<unsigned>(i % 2));
+    for (auto it = m.begin(); it != m.end();) {
+        if (eq(*it->first, *syms[1]) or eq(*it->first, *syms[3]))
+            it = m.erase(it);
+        else
+            ++it;
+    }
+    REQUIRE(m.size() == 98);
+
+    // Reinserting reuses the deleted slots
+    for (int i = 0; i < 200; i += 2)
+        m.insert({syms[i], integer(i)});
+    REQUIRE(m.size() == 198);
+
+    umap_basic_num m2 = m;
+    REQUIRE(unified_eq(m, m2));
+    m2[syms[1]] = one;
+    REQUIRE(not unified_eq(m, m2));
+    umap_basic_num m3 = std::move(m2);
+    REQUIRE(m2.empty());
+    REQUIRE(m3.size() == 199);
+    std::size_t buckets = m3.bucket_count();
+    m3.reserve(1000);
+    REQUIRE(m3.bucket_count() > buckets);
+    REQUIRE(m3.size() == 199);
+    m3.rehash(0);
+    REQUIRE(m3.bucket_count() == buckets);
+    REQUIRE(eq(*m3.at(syms[1]), *one));
+    // Reserving less than the size never shrinks the table
+    m3.reserve(1);
+    REQUIRE(m3.bucket_count() == buckets);
+    REQUIRE(m3.find(symbol("y")) == m3.end());
+    REQUIRE(eq(*m3.at(syms[1]), *one));
+    m3.clear();
+    REQUIRE(m3.empty());
+    REQUIRE(m3.find(syms[1]) == m3.end());
+
+    umap_basic_basic b = {{syms[0], syms[1]}, {syms[1], syms[0]}};
+    REQUIRE(b.size() == 2);
+    REQUIRE(eq(*b[syms[0]], *syms[1]));
+}
+
 TEST_CASE("Add: basic", "[basic]")
 {
     umap_basic_num m, m2;
@@ -506,6 +652,98 @@ TEST_CASE("Diff: Basic", "[basic]")
     REQUIRE(eq(*r1, *r2));
 }
 
+TEST_CASE("Diff: cache", "[basic]")
+{
+    RCP<const Symbol> x = symbol("x");
+    RCP<const Symbol> y = symbol("y");
+    RCP<const Basic> r1, r2;
+
+    // Every level uses the previous one twice
+    RCP<const Basic> e = add(x, y);
+    for (int i = 0; i < 6; i++)
+        e = add(sin(e), cos(mul(e, y)));
+    r1 = diff(e, x, true);
+    r2 = diff(e, x);
+    REQUIRE(eq(*r1, *r2));
+
+    DiffCache cache;
+    REQUIRE(eq(*diff(e, x, cache), *r2));
+    REQUIRE(cache.size() > 0);
+    REQUIRE(eq(*diff(e, y, cache), *diff(e, y)));
+    size_t n = cache.size();
+    REQUIRE(eq(*diff(e, x, cache), *r2));
+    REQUIRE(cache.size() == n);
+    cache.clear();
+    REQUIRE(cache.size() == 0);
+
+    DiffCache small(4);
+    REQUIRE(eq(*diff(e, x, small), *r2));
+    REQUIRE(small.size() <= 4);
+
+    // Without the cache, this takes 2^50 steps
+    for (int i = 0; i < 44; i++)
+        e = add(sin(e), cos(mul(e, y)));
+    r1 = diff(e, x, true);
+    REQUIRE(not eq(*r1, *zero));
+}
+
+TEST_CASE("Diff: gradient", "[basic]")
+{
+    RCP<const Symbol> x = symbol("x");
+    RCP<const Symbol> y = symbol("y");
+    RCP<const Symbol> z = symbol("z");
+    RCP<const Basic> i2 = integer(2);
+    RCP<const Basic> i3 = integer(3);
+    RCP<const Basic> f;
+    vec_basic g;
+
+    f = add(mul(i3, pow(x, i2)), mul(x, y));
+    g = gradient(f, {x, y, z});
+    REQUIRE(g.size() == 3);
+    REQUIRE(eq(*expand(g[0]), *add(mul(integer(6), x), y)));
+    REQUIRE(eq(*expand(g[1]), *x));
+    REQUIRE(eq(*g[2], *zero));
+
+    // Every kind of node, compared with `diff` at a point
+    f = add(mul(sin(mul(x, y)), pow(add(x, z), y)),
+            add(exp(mul(x, z)), log(add(x, pow(y, i2)))));
+    f = mul(f, cos(f));
+    map_basic_basic point = {{x, real_double(0.3)},
+                             {y, real_double(1.7)},
+                             {z, real_double(1.2)}};
+    std::vector<RCP<const Symbol>> syms = {x, y, z};
+    g = gradient(f, {x, y, z, x});
+    REQUIRE(g.size() == 4);
+    for (unsigned i = 0; i < 3; i++) {
+        double d1 = eval_double(*g[i]->subs(point));
+        double d2 = eval_double(*diff(f, syms[i])->subs(point));
+        REQUIRE(std::abs(d1 - d2) < 1e-12 * std::abs(d2));
+    }
+    REQUIRE(eq(*g[3], *g[0]));
+
+    // Other functions are differentiated as a whole
+    f = mul(x, function_symbol("f", {x, y}));
+    g = gradient(f, {x, y});
+    REQUIRE(eq(*expand(g[0]), *expand(diff(f, x))));
+    REQUIRE(eq(*expand(g[1]), *expand(diff(f, y))));
+
+    CHECK_THROWS_AS(gradient(f, {mul(x, y)}), SymEngineException &);
+
+    vec_basic outputs = gradient_outputs(f, {x, y}, true);
+    REQUIRE(outputs.size() == 3);
+    REQUIRE(eq(*outputs[0], *f));
+    REQUIRE(eq(*outputs[1], *g[0]));
+    REQUIRE(eq(*outputs[2], *g[1]));
+    REQUIRE(gradient_outputs(f, {x, y}, false).size() == 2);
+
+    // A chain too deep for a recursive traversal
+    f = y;
+    for (int i = 0; i < 100000; i++)
+        f = sin(add(f, y));
+    g = gradient(add(f, mul(i3, x)), {x});
+    REQUIRE(eq(*g[0], *i3));
+}
+
 TEST_CASE("compare: Basic", "[basic]")
 {
     RCP<const Basic> r1, r2;
@@ -806,6 +1044,47 @@ TEST_CASE("has_symbol: Basic", "[basic]")
     REQUIRE(not has_symbol(*r1, *z));
 }
 
+TEST_CASE("symbol_signature: Basic", "[basic]")
+{
+    RCP<const Symbol> x = symbol("x"), y = symbol("y");
+    RCP<const Basic> r1 = add(x, pow(y, integer(2)));
+    REQUIRE(may_have_symbol(*r1, *x));
+    REQUIRE(may_have_symbol(*r1, *y));
+    REQUIRE(may_have_symbol(*sin(r1), *x));
+#ifdef WITH_SYMENGINE_SYMBOL_SIGNATURE
+    REQUIRE(symbol_signature(*integer(2)) == 0);
+    REQUIRE(symbol_signature(*pi) == 0);
+    REQUIRE(symbol_signature(*r1)
+            == (symbol_signature(*x) | symbol_signature(*y)));
+    REQUIRE(symbol_signature(*sin(r1)) == symbol_signature(*r1));
+    if (symbol_signature(*x) != symbol_signature(*y))
+        REQUIRE(not may_have_symbol(*sin(mul(x, integer(3))), *y));
+#endif
+
+    // More symbols than bits
+    vec_basic v;
+    RCP<const Basic> r2 = zero;
+    for (int i = 0; i < 100; i++) {
+        v.push_back(symbol("x" + std::to_string(i)));
+        r2 = add(r2, sin(mul(v.back(), pow(v.back(), y))));
+    }
+    for (int i = 0; i < 100; i++) {
+        REQUIRE(has_symbol(*r2, *rcp_static_cast<const Symbol>(v[i])));
+        REQUIRE(not has_symbol(*r2, *symbol("z" + std::to_string(i))));
+        REQUIRE(eq(*r2->diff(symbol("z" + std::to_string(i))), *zero));
+    }
+    REQUIRE(free_symbols(*r2).size() == 101);
+
+#ifdef WITH_SYMENGINE_SYMBOL_SIGNATURE
+    // A chain too deep for a recursive computation
+    RCP<const Basic> r3 = x;
+    for (int i = 0; i < 100000; i++)
+        r3 = sin(add(r3, y));
+    REQUIRE(symbol_signature(*r3)
+            == (symbol_signature(*x) | symbol_signature(*y)));
+#endif
+}
+
 TEST_CASE("coeff: Basic", "[basic]")
 {
     RCP<const Basic> r1, r2;
@@ -875,3 +1154,73 @@ TEST_CASE("args: Basic", "[basic]")
     r1 = log(pi);
     REQUIRE(vec_basic_eq_perm(r1->get_args(), {pi}));
 }
+
+TEST_CASE("interning: Basic", "[basic]")
+{
+    RCP<const Basic> x, y, r1, r2, r3;
+
+    SymEngine::set_interning(true);
+    if (not SymEngine::interning_enabled()) {
+        // Interning is not available with Teuchos::RCP
+        return;
+    }
+    size_t n = SymEngine::interned_count();
+    x = symbol("x");
+    y = symbol("y");
+    REQUIRE(x.get() == symbol("x").get());
+    REQUIRE(x.get() != y.get());
+
+    r1 = mul(x, add(y, pow(x, integer(2))));
+    r2 = mul(add(pow(x, integer(2)), y), x);
+    REQUIRE(r1.get() == r2.get());
+    REQUIRE(r1->is_interned());
+
+    r3 = add(r1, integer(1));
+    REQUIRE(r3.get() == add(integer(1), r2).get());
+    REQUIRE(SymEngine::interned_count() > n);
+
+    // Entries are weak and go away together with the last reference
+    r1.reset();
+    r2.reset();
+    r3.reset();
+    x.reset();
+    y.reset();
+    REQUIRE(SymEngine::interned_count() == n);
+
+    SymEngine::set_interning(false);
+    x = symbol("x");
+    REQUIRE(not x->is_interned());
+    REQUIRE(x.get() != symbol("x").get());
+}
+
+TEST_CASE("allocation stats and arena: Basic", "[basic]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> r;
+
+    SymEngine::reset_allocation_stats();
+    r = add(x, integer(5));
+    std::vector<SymEngine::AllocationStats> stats
+        = SymEngine::allocation_stats();
+    REQUIRE(stats.size() == SymEngine::TypeID_Count);
+#if defined(WITH_SYMENGINE_POOL_ALLOCATOR)
+    REQUIRE(stats[SymEngine::ADD].allocations == 1);
+    REQUIRE(stats[SymEngine::ADD].bytes >= sizeof(Add));
+    // Small integers come from the cache
+    REQUIRE(stats[SymEngine::INTEGER].allocations == 0);
+#endif
+
+    double d;
+    {
+        SymEngine::BasicArena arena;
+        RCP<const Basic> y = symbol("y");
+        d = eval_double(
+            *expand(pow(add(r, y), integer(3)))->subs({{x, one}, {y, one}}));
+        // Instances may outlive the arena
+        r = mul(r, y);
+    }
+    REQUIRE(std::abs(d - 343.0) < 1e-12);
+    REQUIRE(r->__str__() == "y*(5 + x)");
+    r = pow(r, integer(2));
+    REQUIRE(r->__str__() == "y**2*(5 + x)**2");
+}
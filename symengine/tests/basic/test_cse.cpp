@@ -0,0 +1,109 @@
+#include "catch.hpp"
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/functions.h>
+
+using SymEngine::Basic;
+using SymEngine::RCP;
+using SymEngine::symbol;
+using SymEngine::integer;
+using SymEngine::add;
+using SymEngine::mul;
+using SymEngine::pow;
+using SymEngine::sin;
+using SymEngine::cos;
+using SymEngine::vec_basic;
+using SymEngine::vec_pair;
+using SymEngine::map_basic_basic;
+using SymEngine::cse;
+
+// Substitutes the replacements back, last one first
+RCP<const Basic> unreduce(const vec_pair &replacements, RCP<const Basic> e)
+{
+    for (auto it = replacements.rbegin(); it != replacements.rend(); ++it)
+        e = e->subs({{it->first, it->second}});
+    return e;
+}
+
+TEST_CASE("cse: Basic", "[cse]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> x0 = symbol("x0");
+    RCP<const Basic> x1 = symbol("x1");
+    RCP<const Basic> s = sin(add(x, y));
+    vec_pair replacements;
+    vec_basic reduced;
+
+    // x + y only occurs inside of sin(x + y), so it is not replaced
+    cse(replacements, reduced, {mul(s, z), add(s, z)});
+    REQUIRE(replacements.size() == 1);
+    REQUIRE(eq(*replacements[0].first, *x0));
+    REQUIRE(eq(*replacements[0].second, *s));
+    REQUIRE(reduced.size() == 2);
+    REQUIRE(eq(*reduced[0], *mul(x0, z)));
+    REQUIRE(eq(*reduced[1], *add(x0, z)));
+
+    // Nothing to replace
+    replacements.clear();
+    reduced.clear();
+    cse(replacements, reduced, {add(x, y), mul(x, y)});
+    REQUIRE(replacements.empty());
+    REQUIRE(eq(*reduced[0], *add(x, y)));
+    REQUIRE(eq(*reduced[1], *mul(x, y)));
+
+    // Nested subexpressions, with powers inside of products and terms with
+    // coefficients inside of sums. The symbol x0 is taken already.
+    RCP<const Basic> p = pow(add(x, x0), integer(2));
+    RCP<const Basic> c = cos(mul(integer(2), p));
+    vec_basic exprs = {add(mul(integer(3), c), mul(p, y)), mul(p, c),
+                       add(c, sin(c)), c};
+    replacements.clear();
+    reduced.clear();
+    cse(replacements, reduced, exprs);
+    REQUIRE(replacements.size() == 2);
+    REQUIRE(eq(*replacements[0].first, *x1));
+    REQUIRE(eq(*replacements[0].second, *p));
+    REQUIRE(eq(*replacements[1].second,
+               *cos(mul(integer(2), replacements[0].first))));
+    REQUIRE(eq(*reduced[3], *replacements[1].first));
+    for (unsigned i = 0; i < exprs.size(); i++)
+        REQUIRE(eq(*unreduce(replacements, reduced[i]), *exprs[i]));
+}
+
+TEST_CASE("cse: Terms and deep expressions", "[cse]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> s = sin(x);
+    RCP<const Basic> t = mul(integer(2), s);
+    vec_pair replacements;
+    vec_basic reduced;
+
+    // The term 2*sin(x) of the sum is replaced, although it is counted
+    // after the sum, so its replacement has to be moved before the sum's
+    RCP<const Basic> a = add(t, y);
+    vec_basic exprs = {a, a, cos(t), sin(t)};
+    cse(replacements, reduced, exprs);
+    REQUIRE(replacements.size() == 3);
+    for (unsigned i = 0; i < exprs.size(); i++)
+        REQUIRE(eq(*unreduce(replacements, reduced[i]), *exprs[i]));
+
+    // Deep expressions don't overflow the stack
+    RCP<const Basic> e = x;
+    for (unsigned i = 0; i < 100000; i++)
+        e = sin(add(e, y));
+    replacements.clear();
+    reduced.clear();
+    cse(replacements, reduced, {e, cos(e)});
+    REQUIRE(replacements.size() == 1);
+    REQUIRE(replacements[0].second.get() == e.get());
+    REQUIRE(eq(*reduced[0], *replacements[0].first));
+    REQUIRE(eq(*reduced[1], *cos(replacements[0].first)));
+}
@@ -90,3 +90,54 @@ TEST_CASE("fix#461: integer", "[integer]")
     ir = integer(val);
     REQUIRE(val == ir->as_integer_class());
 }
+
+TEST_CASE("machine word fast path: integer", "[integer]")
+{
+    long lmax = std::numeric_limits<long>::max();
+    long lmin = std::numeric_limits<long>::min();
+    RCP<const Integer> imax = integer(lmax);
+    RCP<const Integer> imin = integer(lmin);
+    RCP<const Integer> i1 = integer(1);
+    RCP<const Integer> im1 = integer(-1);
+    RCP<const Integer> i2 = integer(2);
+    long r = 0;
+
+    REQUIRE(imax->get_si(r));
+    REQUIRE(r == lmax);
+    REQUIRE(not imax->addint(*i1)->get_si(r));
+
+    // Results that overflow a long are promoted to integer_class
+    REQUIRE(imax->addint(*i1)->as_integer_class() == integer_class(lmax) + 1);
+    REQUIRE(imin->subint(*i1)->as_integer_class() == integer_class(lmin) - 1);
+    REQUIRE(imax->mulint(*i2)->as_integer_class() == integer_class(lmax) * 2);
+    REQUIRE(imin->mulint(*im1)->as_integer_class() == -integer_class(lmin));
+    REQUIRE(imin->neg()->as_integer_class() == -integer_class(lmin));
+    REQUIRE(eq(*imax->addint(*im1)->addint(*i1), *imax));
+
+    REQUIRE(eq(*i2->powint(*integer(62)), *integer(4611686018427387904L)));
+    REQUIRE(i2->powint(*integer(100))->__str__()
+            == "1267650600228229401496703205376");
+    REQUIRE(eq(*im1->powint(*integer(12345)), *im1));
+    REQUIRE(eq(*integer(-3)->powint(*integer(3)), *integer(-27)));
+    REQUIRE(eq(*integer(7)->powint(*integer(0)), *i1));
+}
+
+TEST_CASE("small integer cache: integer", "[integer]")
+{
+    RCP<const Integer> i2 = integer(2);
+    RCP<const Integer> i3 = integer(3);
+
+    REQUIRE(integer(2).get() == i2.get());
+    REQUIRE(integer(2u).get() == i2.get());
+    REQUIRE(integer(integer_class(2)).get() == i2.get());
+    REQUIRE(i2->addint(*i3).get() == integer(5).get());
+    REQUIRE(i2->mulint(*i3).get() == integer(6).get());
+    REQUIRE(i3->neg().get() == integer(-3).get());
+    REQUIRE(integer(-1024).get() == integer(-1024).get());
+    REQUIRE(integer(1024).get() == integer(1024).get());
+
+    // Values outside of the cache are allocated every time
+    REQUIRE(integer(1025).get() != integer(1025).get());
+    REQUIRE(integer(-1025).get() != integer(-1025).get());
+    REQUIRE(eq(*integer(1025), *integer(1025)));
+}
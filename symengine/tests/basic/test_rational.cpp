@@ -12,6 +12,8 @@ using SymEngine::rational;
 using SymEngine::Number;
 using SymEngine::is_a;
 using SymEngine::SymEngineException;
+using SymEngine::integer_class;
+using SymEngine::rational_class;
 
 TEST_CASE("Rational", "[rational]")
 {
@@ -75,3 +77,41 @@ TEST_CASE("Rational is_power, nth root", "[rational is_power, nth root]")
     REQUIRE(res->__eq__(*q3_5));
     CHECK_THROWS_AS(q9_25->nth_root(outArg(res), 0), SymEngineException);
 }
+
+TEST_CASE("Rational machine word fast path", "[rational]")
+{
+    long lmax = std::numeric_limits<long>::max();
+    RCP<const Number> q1_2 = rational(1, 2);
+    RCP<const Number> q1_3 = rational(1, 3);
+    RCP<const Number> qm1_6 = rational(-1, 6);
+    RCP<const Number> r;
+
+    REQUIRE(eq(*rational(6, -4), *rational(-3, 2)));
+    REQUIRE(eq(*rational(0, -7), *integer(0)));
+    REQUIRE(eq(*rational(-8, -4), *integer(2)));
+
+    REQUIRE(eq(*q1_2->add(*q1_3), *rational(5, 6)));
+    REQUIRE(eq(*q1_2->add(*qm1_6), *rational(1, 3)));
+    REQUIRE(eq(*q1_2->add(*q1_2), *integer(1)));
+    REQUIRE(eq(*q1_2->sub(*q1_2), *integer(0)));
+    REQUIRE(eq(*q1_3->sub(*integer(1)), *rational(-2, 3)));
+    REQUIRE(eq(*integer(1)->sub(*q1_3), *rational(2, 3)));
+    REQUIRE(eq(*q1_2->mul(*rational(4, 3)), *rational(2, 3)));
+    REQUIRE(eq(*q1_2->mul(*integer(6)), *integer(3)));
+    REQUIRE(eq(*q1_3->mul(*integer(0)), *integer(0)));
+    REQUIRE(eq(*qm1_6->mul(*rational(-3, 5)), *rational(1, 10)));
+
+    // Halves and thirds with small numerators are cached
+    REQUIRE(q1_2.get() == rational(2, 4).get());
+    REQUIRE(q1_3->sub(*integer(1)).get() == rational(-2, 3).get());
+    REQUIRE(rational(1, 5).get() != rational(1, 5).get());
+
+    // Results that overflow a long are promoted to rational_class
+    r = rational(lmax, 2)->add(*rational(lmax, 3));
+    REQUIRE(is_a<Rational>(*r));
+    REQUIRE(static_cast<const Rational &>(*r).i
+            == rational_class(integer_class(lmax) * 5, 6));
+    r = rational(lmax, 2)->mul(*rational(lmax, 3));
+    REQUIRE(static_cast<const Rational &>(*r).i
+            == rational_class(integer_class(lmax) * integer_class(lmax), 6));
+}
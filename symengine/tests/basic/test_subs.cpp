@@ -21,6 +21,7 @@ using SymEngine::erf;
 using SymEngine::RCP;
 using SymEngine::rcp_dynamic_cast;
 using SymEngine::map_basic_basic;
+using SymEngine::vec_basic;
 using SymEngine::print_stack_on_segfault;
 using SymEngine::real_double;
 using SymEngine::kronecker_delta;
@@ -453,3 +454,59 @@ TEST_CASE("SSubs: subs", "[ssubs]")
     auto t = ssubs(f->diff(x), {{f, g}});
     REQUIRE(eq(*t, *g->diff(x)));
 }
+
+TEST_CASE("Shared subexpressions: subs", "[subs]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> w = symbol("w");
+
+    // Every level uses the previous one twice
+    RCP<const Basic> e = add(x, y), f = add(integer(2), y);
+    for (int i = 0; i < 6; i++) {
+        e = add(sin(e), mul(e, z));
+        f = add(sin(f), mul(f, z));
+    }
+    REQUIRE(eq(*e->subs({{x, integer(2)}}), *f));
+
+    // Without the memo table, this takes 2^60 steps
+    for (int i = 0; i < 54; i++)
+        e = add(sin(e), mul(e, z));
+    RCP<const Basic> r = e->subs({{x, integer(2)}});
+    REQUIRE(neq(*r, *e));
+    // Nothing is rebuilt if no key occurs
+    r = e->subs({{w, integer(2)}});
+    REQUIRE(r.get() == e.get());
+
+    // A dictionary with many entries
+    map_basic_basic d;
+    RCP<const Basic> s = zero, t = zero;
+    for (int i = 0; i < 20; i++) {
+        RCP<const Basic> a = symbol("a" + std::to_string(i));
+        d[a] = integer(i);
+        s = add(s, mul(a, sin(a)));
+        t = add(t, mul(integer(i), sin(integer(i))));
+    }
+    REQUIRE(eq(*s->subs(d), *t));
+    REQUIRE(eq(*add(s, x)->subs(d), *add(t, x)));
+
+    // A chain too deep for a recursive traversal
+    e = x;
+    for (int i = 0; i < 30000; i++)
+        e = sin(add(e, y));
+    r = e->subs({{y, integer(2)}});
+    bool ok = true;
+    for (int i = 0; i < 30000 and ok; i++) {
+        // r is sin(2 + t)
+        vec_basic args = r->get_args();
+        ok = args.size() == 1;
+        if (ok) {
+            args = args[0]->get_args();
+            ok = args.size() == 2 and eq(*args[0], *integer(2));
+            r = args[1];
+        }
+    }
+    REQUIRE(ok);
+    REQUIRE(eq(*r, *x));
+}
@@ -517,6 +517,50 @@ void test_free_symbols()
     basic_free_stack(z);
 }
 
+void test_cse()
+{
+    basic x, y, e, s;
+    basic_new_stack(x);
+    basic_new_stack(y);
+    basic_new_stack(e);
+    basic_new_stack(s);
+    symbol_set(x, "x");
+    symbol_set(y, "y");
+
+    // sin(x + y) * y and sin(x + y) + y share sin(x + y)
+    basic_add(s, x, y);
+    basic_sin(s, s);
+    CVecBasic *exprs = vecbasic_new();
+    basic_mul(e, s, y);
+    vecbasic_push_back(exprs, e);
+    basic_add(e, s, y);
+    vecbasic_push_back(exprs, e);
+
+    CVecBasic *replacement_syms = vecbasic_new();
+    CVecBasic *replacement_exprs = vecbasic_new();
+    CVecBasic *reduced_exprs = vecbasic_new();
+    basic_cse(replacement_syms, replacement_exprs, reduced_exprs, exprs);
+    SYMENGINE_C_ASSERT(vecbasic_size(replacement_syms) == 1);
+    SYMENGINE_C_ASSERT(vecbasic_size(replacement_exprs) == 1);
+    SYMENGINE_C_ASSERT(vecbasic_size(reduced_exprs) == 2);
+
+    vecbasic_get(replacement_exprs, 0, e);
+    SYMENGINE_C_ASSERT(basic_eq(e, s));
+    vecbasic_get(replacement_syms, 0, x);
+    vecbasic_get(reduced_exprs, 0, e);
+    basic_mul(s, x, y);
+    SYMENGINE_C_ASSERT(basic_eq(e, s));
+
+    vecbasic_free(exprs);
+    vecbasic_free(replacement_syms);
+    vecbasic_free(replacement_exprs);
+    vecbasic_free(reduced_exprs);
+    basic_free_stack(x);
+    basic_free_stack(y);
+    basic_free_stack(e);
+    basic_free_stack(s);
+}
+
 void test_get_type()
 {
     basic x, y;
@@ -1505,6 +1549,7 @@ int main(int argc, char *argv[])
     test_CMapBasicBasic();
     test_get_args();
     test_free_symbols();
+    test_cse();
     test_get_type();
     test_hash();
     test_subs();
@@ -129,6 +129,11 @@ TEST_CASE("eval_double: eval_double", "[eval_double]")
         REQUIRE(::fabs(val - vec[i].second) < 1e-12);
     }
 
+    for (unsigned i = 0; i < vec.size(); i++) {
+        double val = eval_double_iterative(*vec[i].first);
+        REQUIRE(val == eval_double(*vec[i].first));
+    }
+
     // Symbol must raise an exception
     CHECK_THROWS_AS(eval_double(*symbol("x")), SymEngineException);
     CHECK_THROWS_AS(eval_double_single_dispatch(*symbol("x")),
@@ -144,12 +149,73 @@ TEST_CASE("eval_double: eval_double", "[eval_double]")
     CHECK_THROWS_AS(eval_double_single_dispatch(*zeta(r1, r2)),
                     NotImplementedError);
 
+    CHECK_THROWS_AS(eval_double_iterative(*symbol("x")), SymEngineException);
+    CHECK_THROWS_AS(eval_double_iterative(*add(r1, zeta(r1, r2))),
+                    NotImplementedError);
+
     CHECK_THROWS_AS(eval_double(*constant("dummy")), SymEngineException);
     CHECK_THROWS_AS(eval_double_single_dispatch(*constant("dummy")),
                     SymEngineException);
     // ... we don't test the rest of functions that are not implemented.
 }
 
+TEST_CASE("eval_double_iterative: deep and shared", "[eval_double]")
+{
+    // Terms with coefficients, rational and real exponents and a shared
+    // subexpression, evaluated in the same order of operations as eval_double
+    RCP<const Basic> e = sin(integer(1));
+    for (int i = 0; i < 8; i++) {
+        RCP<const Basic> f = add(mul(integer(3), e), div(integer(1), e));
+        e = pow(add(mul(mul(integer(3), f), cos(f)), real_double(0.25)),
+                div(integer(2), integer(3)));
+    }
+    REQUIRE(eval_double_iterative(*e) == eval_double(*e));
+
+    // A deep expression, as in benchmarks/bench_eval_double.cpp
+    e = sin(integer(1));
+    for (int i = 0; i < 10000; i++) {
+        e = pow(add(mul(add(e, pow(integer(2), integer(-3))), integer(3)),
+                    integer(1)),
+                div(integer(2), integer(3)));
+    }
+    REQUIRE(eval_double_iterative(*e) == eval_double(*e));
+}
+
+TEST_CASE("eval_double: symbol values and EvalPlan", "[eval_double]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> c = add(sin(integer(2)), pow(integer(3), pi));
+    RCP<const Basic> e
+        = add(mul(c, pow(add(x, integer(1)), div(integer(3), integer(2)))),
+              add(mul(integer(3), mul(y, cos(x))), mul(x, c)));
+    e = add(e, SymEngine::atan2(y, c));
+    vec_basic syms = {x, y, z};
+
+    SymEngine::EvalPlan plan(*e, syms);
+    std::vector<std::vector<double>> points
+        = {{0.5, 2.0, 0.0}, {0.5, -1.0, 0.0}, {0.5, -1.0, 7.0},
+           {1.5, -1.0, 7.0}, {1.5, 2.5, 7.0}};
+    for (const auto &v : points) {
+        SymEngine::map_basic_basic m = {{x, real_double(v[0])},
+                                        {y, real_double(v[1])},
+                                        {z, real_double(v[2])}};
+        double expected = eval_double(*e->subs(m));
+        REQUIRE(eval_double(*e, syms, v) == expected);
+        REQUIRE(plan.call(v) == expected);
+    }
+
+    // Constants and symbols alone
+    SymEngine::EvalPlan plan2(*c, syms);
+    REQUIRE(plan2.call({1.0, 2.0, 3.0}) == eval_double(*c));
+    SymEngine::EvalPlan plan3(*y, syms);
+    REQUIRE(plan3.call({1.0, 2.0, 3.0}) == 2.0);
+
+    CHECK_THROWS_AS(eval_double(*e, {x}, {1.0}), SymEngineException);
+    CHECK_THROWS_AS(SymEngine::EvalPlan(*e, {x, z}), SymEngineException);
+}
+
 TEST_CASE("eval_complex_double: eval_double", "[eval_double]")
 {
     RCP<const Basic> r1, r2, r3, r4, r5;
@@ -1,7 +1,10 @@
 #include "catch.hpp"
 #include <chrono>
+#include <cstdio>
+#include <fstream>
 
 #include <symengine/lambda_double.h>
+#include <symengine/bytecode_double.h>
 #include <symengine/symengine_exception.h>
 
 #ifdef HAVE_SYMENGINE_LLVM
@@ -9,6 +12,11 @@
 using SymEngine::LLVMDoubleVisitor;
 #endif
 
+#ifdef HAVE_SYMENGINE_CCODE_DOUBLE
+#include <symengine/ccode_double.h>
+using SymEngine::CCodeDoubleVisitor;
+#endif
+
 using SymEngine::Basic;
 using SymEngine::RCP;
 using SymEngine::real_double;
@@ -21,10 +29,19 @@ using SymEngine::vec_basic;
 using SymEngine::complex_double;
 using SymEngine::LambdaRealDoubleVisitor;
 using SymEngine::LambdaComplexDoubleVisitor;
+using SymEngine::BytecodeRealDoubleVisitor;
 using SymEngine::max;
 using SymEngine::sin;
 using SymEngine::cos;
 using SymEngine::E;
+using SymEngine::pi;
+using SymEngine::div;
+using SymEngine::sqrt;
+using SymEngine::tan;
+using SymEngine::atan2;
+using SymEngine::sinh;
+using SymEngine::log;
+using SymEngine::abs;
 using SymEngine::gamma;
 using SymEngine::loggamma;
 using SymEngine::min;
@@ -133,6 +150,184 @@ TEST_CASE("Evaluate functions", "[lambda_gamma]")
     REQUIRE(::fabs(d - 0.88020506957408169) < 1e-12);
 }
 
+TEST_CASE("Evaluate to double with bytecode", "[bytecode_double]")
+{
+    RCP<const Basic> x, y, z, r, s;
+    double d, d2;
+    x = symbol("x");
+    y = symbol("y");
+    z = symbol("z");
+
+    r = add(x, add(mul(y, z), pow(x, integer(2))));
+
+    BytecodeRealDoubleVisitor v;
+    v.init({x, y, z}, *r);
+
+    d = v.call({1.5, 2.0, 3.0});
+    REQUIRE(::fabs(d - 9.75) < 1e-12);
+
+    d = v.call({1.5, -1.0, 2.0});
+    REQUIRE(::fabs(d - 1.75) < 1e-12);
+
+    r = max({x, add(mul(y, z), integer(3))});
+    v.init({x, y, z}, *r);
+    d = v.call({4.0, 1.0, 2.5});
+    REQUIRE(::fabs(d - 5.5) < 1e-12);
+
+    r = min({pow(x, y), add(mul(y, z), integer(3))});
+    v.init({x, y, z}, *r);
+    d = v.call({4.0, 2.0, 2.5});
+    REQUIRE(::fabs(d - 8.0) < 1e-12);
+
+    // Constant subexpressions are folded
+    r = add(mul(integer(2), pi), sin(integer(1)));
+    v.init({x}, *r);
+    REQUIRE(v.size() == 0);
+    REQUIRE(::fabs(v.call({0.0}) - 7.12465629198748) < 1e-12);
+
+    // Compare with LambdaRealDoubleVisitor for an expression using
+    // divisions, integer and rational powers and other functions
+    r = add(div(sin(x), pow(y, integer(3))),
+            mul(sqrt(add(x, z)), pow(E, mul(integer(-2), y))));
+    r = add(r, div(atan2(y, z), add(log(abs(x)), tan(z))));
+    r = add(r, mul(sinh(x), pow(add(x, y), div(integer(-1), integer(2)))));
+    r = add(mul(r, r), gamma(y));
+
+    LambdaRealDoubleVisitor v2;
+    v2.init({x, y, z}, *r);
+    v.init({x, y, z}, *r);
+    d = v.call({1.5, 2.0, 3.0});
+    d2 = v2.call({1.5, 2.0, 3.0});
+    REQUIRE(::fabs((d - d2) / d2) < 1e-12);
+
+    // Several outputs share subexpressions
+    s = sin(add(x, y));
+    vec_basic outputs = {mul(s, z), add(s, z), pow(s, integer(5)), y};
+    v.init({x, y, z}, outputs);
+    double outs[4], inps[3] = {0.5, 1.0, 2.0};
+    v.call(outs, inps);
+    d = std::sin(1.5);
+    REQUIRE(::fabs(outs[0] - d * 2.0) < 1e-12);
+    REQUIRE(::fabs(outs[1] - (d + 2.0)) < 1e-12);
+    REQUIRE(::fabs(outs[2] - std::pow(d, 5)) < 1e-12);
+    REQUIRE(outs[3] == 1.0);
+
+    // Evaluating to double when there are complex doubles raise an exception
+    CHECK_THROWS_AS(
+        v.init({x}, *add(complex_double(std::complex<double>(1, 2)), x)),
+        NotImplementedError);
+
+    // Undefined symbols raise an exception
+    CHECK_THROWS_AS(v.init({x}, *r), SymEngineException);
+}
+
+TEST_CASE("Evaluate at many points", "[lambda_double]")
+{
+    RCP<const Basic> x, y, s;
+    x = symbol("x");
+    y = symbol("y");
+    s = sin(add(x, y));
+    vec_basic outputs = {mul(s, y), add(pow(x, integer(3)), s),
+                         div(integer(1), add(x, integer(2)))};
+
+    // More points than fit into one block of the bytecode
+    const unsigned n = 150;
+    std::vector<double> inps(2 * n), outs(3 * n), outs2(3 * n), expected(3 * n);
+    for (unsigned i = 0; i < n; i++) {
+        double a = 0.01 * i, b = 1.0 - 0.02 * i;
+        inps[i] = a;
+        inps[n + i] = b;
+        expected[i] = std::sin(a + b) * b;
+        expected[n + i] = a * a * a + std::sin(a + b);
+        expected[2 * n + i] = 1.0 / (a + 2.0);
+    }
+
+    LambdaRealDoubleVisitor v;
+    v.init({x, y}, outputs);
+    v.call_batch(outs.data(), inps.data(), n);
+    BytecodeRealDoubleVisitor v2;
+    v2.init({x, y}, outputs);
+    v2.call_batch(outs2.data(), inps.data(), n);
+    for (unsigned i = 0; i < 3 * n; i++) {
+        REQUIRE(::fabs(outs[i] - expected[i]) < 1e-12);
+        REQUIRE(::fabs(outs2[i] - expected[i]) < 1e-12);
+    }
+
+    // An unused input may have the name of a symbol introduced by cse
+    double inps2[3] = {inps[7], inps[n + 7], 100.0}, outs3[3];
+    for (bool cse : {true, false}) {
+        v.init({x, y, symbol("x0")}, outputs, cse);
+        v.call(outs3, inps2);
+        for (unsigned k = 0; k < 3; k++) {
+            REQUIRE(::fabs(outs3[k] - expected[k * n + 7]) < 1e-12);
+        }
+    }
+
+    // The intermediates of cse are kept in the buffer of each call, so a
+    // copy of the visitor doesn't refer to the original
+    {
+        LambdaRealDoubleVisitor v4;
+        v4.init({x, y}, outputs, true);
+        v = v4;
+    }
+    std::fill(outs.begin(), outs.end(), 0.0);
+    v.call_batch(outs.data(), inps.data(), n);
+    for (unsigned i = 0; i < 3 * n; i++) {
+        REQUIRE(::fabs(outs[i] - expected[i]) < 1e-12);
+    }
+#ifdef HAVE_SYMENGINE_LLVM
+    LLVMDoubleVisitor v3;
+    v3.init({x, y}, outputs);
+    v3.call_batch(outs2.data(), inps.data(), n);
+    for (unsigned i = 0; i < 3 * n; i++) {
+        REQUIRE(::fabs(outs2[i] - expected[i]) < 1e-12);
+    }
+    // The count is unsigned, no points leave the outputs untouched
+    std::fill(outs2.begin(), outs2.end(), -1.0);
+    v3.call_batch(outs2.data(), inps.data(), 0);
+    for (unsigned i = 0; i < 3 * n; i++) {
+        REQUIRE(outs2[i] == -1.0);
+    }
+#endif
+}
+
+TEST_CASE("Evaluate a gradient", "[lambda_double]")
+{
+    RCP<const Basic> x, y, f;
+    x = symbol("x");
+    y = symbol("y");
+    // f = sin(x*y) * (x + y)^2
+    f = mul(sin(mul(x, y)), pow(add(x, y), integer(2)));
+
+    double a = 0.7, b = -1.3, outs[3];
+    double inps[2] = {a, b};
+    double g0 = std::sin(a * b) * (a + b) * (a + b);
+    double gx = b * std::cos(a * b) * (a + b) * (a + b)
+                + 2 * std::sin(a * b) * (a + b);
+    double gy = a * std::cos(a * b) * (a + b) * (a + b)
+                + 2 * std::sin(a * b) * (a + b);
+
+    LambdaRealDoubleVisitor v;
+    v.init_gradient({x, y}, *f, true);
+    v.call(outs, inps);
+    REQUIRE(::fabs(outs[0] - g0) < 1e-12);
+    REQUIRE(::fabs(outs[1] - gx) < 1e-12);
+    REQUIRE(::fabs(outs[2] - gy) < 1e-12);
+
+    v.init_gradient({x, y}, *f, false, false);
+    v.call(outs, inps);
+    REQUIRE(::fabs(outs[0] - gx) < 1e-12);
+    REQUIRE(::fabs(outs[1] - gy) < 1e-12);
+#ifdef HAVE_SYMENGINE_LLVM
+    LLVMDoubleVisitor v2;
+    v2.init_gradient({x, y}, *f, true);
+    v2.call(outs, inps);
+    REQUIRE(::fabs(outs[0] - g0) < 1e-12);
+    REQUIRE(::fabs(outs[1] - gx) < 1e-12);
+    REQUIRE(::fabs(outs[2] - gy) < 1e-12);
+#endif
+}
+
 #ifdef HAVE_SYMENGINE_LLVM
 
 TEST_CASE("Check llvm and lambda are equal", "[llvm_double]")
@@ -175,4 +370,312 @@ TEST_CASE("Check llvm and lambda are equal", "[llvm_double]")
 
     REQUIRE(::fabs((d - d2) / d) < 1e-12);
 }
+
+TEST_CASE("Load llvm functions from the cache", "[llvm_double]")
+{
+    RCP<const Basic> x, y, s;
+    x = symbol("x");
+    y = symbol("y");
+    s = sin(add(x, y));
+    vec_basic outputs = {mul(s, y), add(pow(x, integer(3)), s)};
+
+    llvm::SmallString<128> dir;
+    REQUIRE(not llvm::sys::fs::createUniqueDirectory("symengine_cache", dir));
+    double inps[2] = {0.5, 1.5}, outs[2], outs2[2], outs3[2];
+
+    LLVMDoubleVisitor v;
+    v.set_cache_dir(std::string(dir.str()));
+    v.init({x, y}, outputs);
+    v.call(outs, inps);
+    // Loaded from the cache
+    LLVMDoubleVisitor v2;
+    v2.set_cache_dir(std::string(dir.str()));
+    v2.init({x, y}, outputs);
+    v2.call(outs2, inps);
+    for (unsigned k = 0; k < 2; k++) {
+        REQUIRE(::fabs(outs[k] - outs2[k]) < 1e-15);
+    }
+    v2.call_batch(outs2, inps, 1);
+    // Different outputs are compiled again
+    v2.init({x, y}, {outputs[1], outputs[0]});
+    v2.call(outs3, inps);
+    for (unsigned k = 0; k < 2; k++) {
+        REQUIRE(::fabs(outs[k] - outs2[k]) < 1e-15);
+        REQUIRE(::fabs(outs[k] - outs3[1 - k]) < 1e-15);
+    }
+    llvm::sys::fs::remove_directories(dir);
+
+    // An entry stored for another key, as after a collision of the hashes,
+    // is compiled again instead of being loaded
+    REQUIRE(not llvm::sys::fs::createUniqueDirectory("symengine_cache", dir));
+    v.set_cache_dir(std::string(dir.str()));
+    v.init({x, y}, outputs);
+    std::error_code ec;
+    unsigned entries = 0;
+    llvm::sys::fs::directory_iterator it(dir, ec), end;
+    for (; it != end and not ec; it.increment(ec)) {
+        std::string path = it->path();
+        llvm::StringRef name(path);
+        if (name.endswith(".key") or name.endswith(".o")) {
+            std::ofstream(path) << "not the entry of the outputs";
+            entries++;
+        }
+    }
+    REQUIRE(entries == 2);
+    v2.set_cache_dir(std::string(dir.str()));
+    v2.init({x, y}, outputs);
+    v2.call(outs2, inps);
+    for (unsigned k = 0; k < 2; k++) {
+        REQUIRE(::fabs(outs[k] - outs2[k]) < 1e-15);
+    }
+    llvm::sys::fs::remove_directories(dir);
+
+    // An object file that cannot be read is compiled again and replaced
+    REQUIRE(not llvm::sys::fs::createUniqueDirectory("symengine_cache", dir));
+    v.set_cache_dir(std::string(dir.str()));
+    v.init({x, y}, outputs);
+    entries = 0;
+    for (it = llvm::sys::fs::directory_iterator(dir, ec);
+         it != end and not ec; it.increment(ec)) {
+        std::string path = it->path();
+        if (llvm::StringRef(path).endswith(".o")) {
+            std::ofstream(path) << "not an object file";
+            entries++;
+        }
+    }
+    REQUIRE(entries == 1);
+    for (unsigned i = 0; i < 2; i++) {
+        v2.init({x, y}, outputs);
+        v2.call(outs2, inps);
+        for (unsigned k = 0; k < 2; k++) {
+            REQUIRE(::fabs(outs[k] - outs2[k]) < 1e-15);
+        }
+    }
+    // Doubles that differ in the last digit have different entries
+    double a = 0.1, b = std::nextafter(a, 1.0);
+    v.init({x}, *add(x, real_double(a)));
+    v2.init({x}, *add(x, real_double(b)));
+    REQUIRE(v.call({0.0}) == a);
+    REQUIRE(v2.call({0.0}) == b);
+    llvm::sys::fs::remove_directories(dir);
+}
+
+TEST_CASE("Compile with llvm options", "[llvm_double]")
+{
+    RCP<const Basic> x, y, r;
+    x = symbol("x");
+    y = symbol("y");
+    r = add(mul(sin(x), pow(y, integer(3))),
+            div(cos(mul(x, y)), add(integer(1), pow(E, x))));
+    double expected = std::sin(0.5) * 1.5 * 1.5 * 1.5
+                      + std::cos(0.75) / (1.0 + std::exp(0.5));
+
+    SymEngine::LLVMOptions opts;
+    for (unsigned level = 0; level <= 3; level++) {
+        opts.opt_level = level;
+        opts.fast_math = (level == 3);
+        opts.intrinsics = (level != 1);
+        LLVMDoubleVisitor v;
+        v.set_options(opts);
+        v.init({x, y}, *r);
+        REQUIRE(::fabs(v.call({0.5, 1.5}) - expected) < 1e-12);
+    }
+}
+
+TEST_CASE("Evaluate functions with llvm", "[llvm_double]")
+{
+    RCP<const Basic> x, y, r;
+    x = symbol("x");
+    y = symbol("y");
+    vec_basic outputs = {tan(x),
+                         SymEngine::asin(x),
+                         SymEngine::acos(x),
+                         SymEngine::atan(x),
+                         SymEngine::acot(y),
+                         atan2(x, y),
+                         sinh(x),
+                         SymEngine::cosh(x),
+                         SymEngine::tanh(x),
+                         SymEngine::asinh(y),
+                         SymEngine::acosh(y),
+                         SymEngine::atanh(x),
+                         log(y),
+                         abs(SymEngine::sub(x, y)),
+                         gamma(y),
+                         loggamma(y),
+                         SymEngine::erf(x),
+                         SymEngine::erfc(x),
+                         max({x, y, integer(1)}),
+                         min({x, y})};
+    std::vector<double> expected
+        = {std::tan(0.25),   std::asin(0.25),      std::acos(0.25),
+           std::atan(0.25),  std::atan(1 / 1.5),   std::atan2(0.25, 1.5),
+           std::sinh(0.25),  std::cosh(0.25),      std::tanh(0.25),
+           std::asinh(1.5),  std::acosh(1.5),      std::atanh(0.25),
+           std::log(1.5),    1.25,                 std::tgamma(1.5),
+           std::lgamma(1.5), std::erf(0.25),       std::erfc(0.25),
+           1.5,              0.25};
+    std::vector<double> outs(outputs.size());
+    double inps[2] = {0.25, 1.5};
+    LLVMDoubleVisitor v;
+    v.init({x, y}, outputs);
+    v.call(outs.data(), inps);
+    for (unsigned i = 0; i < outputs.size(); i++) {
+        REQUIRE(::fabs(outs[i] - expected[i]) < 1e-12);
+    }
+
+    // Single precision
+    SymEngine::LLVMFloatVisitor f;
+    f.init({x, y}, outputs);
+    std::vector<float> outs2(outputs.size());
+    float inps2[2] = {0.25f, 1.5f};
+    f.call(outs2.data(), inps2);
+    for (unsigned i = 0; i < outputs.size(); i++) {
+        REQUIRE(::fabs(outs2[i] - expected[i]) < 1e-5);
+    }
+
+    // x in [0, 1), 2 * x for x >= 1 and 0 otherwise
+    using SymEngine::interval;
+    using SymEngine::contains;
+    using SymEngine::Infty;
+    r = SymEngine::piecewise(
+        {{x, contains(x, interval(integer(0), integer(1), false, true))},
+         {mul(integer(2), x),
+          contains(x, interval(integer(1), Infty::from_int(1)))},
+         {integer(0), SymEngine::boolTrue}});
+    v.init({x}, *r);
+    REQUIRE(::fabs(v.call({0.5}) - 0.5) < 1e-15);
+    REQUIRE(::fabs(v.call({1.0}) - 2.0) < 1e-15);
+    REQUIRE(::fabs(v.call({-1.0})) < 1e-15);
+}
+
+TEST_CASE("Check llvm and lambda are equal for complex",
+          "[llvm_complex_double]")
+{
+    RCP<const Basic> x, y;
+    x = symbol("x");
+    y = symbol("y");
+    vec_basic outputs
+        = {add(x, mul(y, complex_double(std::complex<double>(1, 2)))),
+           div(x, y),
+           pow(x, integer(3)),
+           pow(x, y),
+           SymEngine::sqrt(y),
+           sin(x),
+           cos(y),
+           tan(x),
+           sinh(x),
+           SymEngine::asin(x),
+           SymEngine::acos(y),
+           SymEngine::atan(x),
+           SymEngine::asinh(x),
+           SymEngine::acosh(y),
+           SymEngine::atanh(x),
+           log(y),
+           abs(x),
+           pow(E, x)};
+    std::vector<std::complex<double>> inps
+        = {std::complex<double>(0.5, -0.25), std::complex<double>(-1.5, 2)};
+    std::vector<std::complex<double>> outs(outputs.size()),
+        expected(outputs.size());
+
+    SymEngine::LLVMComplexDoubleVisitor v;
+    v.init({x, y}, outputs);
+    v.call(outs.data(), inps.data());
+    LambdaComplexDoubleVisitor v2;
+    v2.init({x, y}, outputs);
+    v2.call(expected.data(), inps.data());
+    for (unsigned i = 0; i < outputs.size(); i++) {
+        REQUIRE(std::abs(outs[i] - expected[i]) < 1e-12);
+    }
+}
+#endif
+
+#ifdef HAVE_SYMENGINE_CCODE_DOUBLE
+
+TEST_CASE("Evaluate with compiled C code", "[ccode_double]")
+{
+    RCP<const Basic> x, y, s, r;
+    x = symbol("x");
+    y = symbol("y");
+    s = sin(add(x, y));
+    vec_basic outputs = {mul(s, y), add(pow(x, integer(3)), s),
+                         div(integer(1), add(x, integer(2)))};
+
+    const unsigned n = 37;
+    std::vector<double> inps(2 * n), outs(3 * n), expected(3 * n);
+    for (unsigned i = 0; i < n; i++) {
+        double a = 0.01 * i, b = 1.0 - 0.02 * i;
+        inps[i] = a;
+        inps[n + i] = b;
+        expected[i] = std::sin(a + b) * b;
+        expected[n + i] = a * a * a + std::sin(a + b);
+        expected[2 * n + i] = 1.0 / (a + 2.0);
+    }
+
+    CCodeDoubleVisitor v;
+    v.init({x, y}, outputs);
+    REQUIRE(v.get_source().find("const double t0 = sin(i0 + i1);")
+            != std::string::npos);
+    REQUIRE(v.get_source().find("#pragma omp simd") != std::string::npos);
+    v.call_batch(outs.data(), inps.data(), n);
+    for (unsigned i = 0; i < 3 * n; i++) {
+        REQUIRE(::fabs(outs[i] - expected[i]) < 1e-12);
+    }
+    double inps2[3] = {inps[7], inps[n + 7], 100.0}, outs2[3];
+    for (bool cse : {true, false}) {
+        v.init({x, y, symbol("x0")}, outputs, cse);
+        v.call(outs2, inps2);
+        for (unsigned k = 0; k < 3; k++) {
+            REQUIRE(::fabs(outs2[k] - expected[k * n + 7]) < 1e-12);
+        }
+    }
+
+    outputs = {SymEngine::acot(y),
+               SymEngine::sec(x),
+               abs(SymEngine::sub(x, y)),
+               gamma(y),
+               loggamma(y),
+               max({x, y, integer(1)}),
+               min({x, y}),
+               div(x, integer(3)),
+               mul(pi, y)};
+    std::vector<double> expected2
+        = {std::atan(1 / 1.5), 1 / std::cos(0.25), 1.25,
+           std::tgamma(1.5),   std::lgamma(1.5),   1.5,
+           0.25,               0.25 / 3,           M_PI * 1.5};
+    std::vector<double> outs3(outputs.size());
+    double inps3[2] = {0.25, 1.5};
+    v.init({x, y}, outputs);
+    v.call(outs3.data(), inps3);
+    for (unsigned i = 0; i < outputs.size(); i++) {
+        REQUIRE(::fabs(outs3[i] - expected2[i]) < 1e-12);
+    }
+
+    // x in [0, 1), 2 * x for x >= 1 and 0 otherwise
+    using SymEngine::interval;
+    using SymEngine::contains;
+    using SymEngine::Infty;
+    r = SymEngine::piecewise(
+        {{x, contains(x, interval(integer(0), integer(1), false, true))},
+         {mul(integer(2), x),
+          contains(x, interval(integer(1), Infty::from_int(1)))},
+         {integer(0), SymEngine::boolTrue}});
+    v.init({x}, *r);
+    REQUIRE(::fabs(v.call({0.5}) - 0.5) < 1e-15);
+    REQUIRE(::fabs(v.call({1.0}) - 2.0) < 1e-15);
+    REQUIRE(::fabs(v.call({-1.0})) < 1e-15);
+
+    CHECK_THROWS_AS(v.init({x}, *y), SymEngineException);
+    v.set_compiler("false");
+    CHECK_THROWS_AS(v.init({x}, *x), SymEngineException);
+
+    // The compiler is not run by a shell
+    std::string marker = "symengine_test_ccode_marker";
+    std::remove(marker.c_str());
+    v.set_compiler("true; touch " + marker + ";");
+    CHECK_THROWS_AS(v.init({x}, *x), SymEngineException);
+    REQUIRE(not std::ifstream(marker));
+}
+
 #endif
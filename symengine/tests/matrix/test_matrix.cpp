@@ -23,6 +23,7 @@ using SymEngine::eye;
 using SymEngine::diag;
 using SymEngine::vec_basic;
 using SymEngine::function_symbol;
+using SymEngine::hessian;
 using SymEngine::permutelist;
 using SymEngine::SymEngineException;
 
@@ -1494,6 +1495,18 @@ TEST_CASE("Test Jacobian", "[matrices]")
                                     integer(1), x, integer(1), integer(1),
                                     integer(1), integer(0), integer(0)}));
 
+    DenseMatrix J2(4, 4);
+    jacobian(A, X, J2, 2);
+    REQUIRE(J == J2);
+
+    // Only the symbols that occur in a row are stored
+    CSRMatrix S;
+    jacobian(A, X, S);
+    REQUIRE(S == CSRMatrix(4, 4, {0, 2, 4, 8, 10}, {0, 2, 1, 2, 0, 1, 2, 3, 0,
+                                                    1},
+                           {integer(1), integer(1), z, y, z, integer(1), x,
+                            integer(1), integer(1), integer(1)}));
+
     X = DenseMatrix(4, 1, {f, y, z, t});
     CHECK_THROWS_AS(jacobian(A, X, J), SymEngineException);
 
@@ -1513,6 +1526,39 @@ TEST_CASE("Test Jacobian", "[matrices]")
     REQUIRE(J == DenseMatrix(2, 2, {y, f, integer(0), mul(integer(2), y)}));
 }
 
+TEST_CASE("Test Hessian", "[matrices]")
+{
+    DenseMatrix X, H;
+    RCP<const Basic> x = symbol("x"), y = symbol("y"), z = symbol("z"),
+                     t = symbol("t"), f = function_symbol("f", x);
+    RCP<const Basic> i2 = integer(2), i3 = integer(3);
+    // e = x**2*y + y*z**3
+    RCP<const Basic> e = add(mul(pow(x, i2), y), mul(y, pow(z, i3)));
+    X = DenseMatrix(4, 1, {x, y, z, t});
+    H = DenseMatrix(4, 4);
+    hessian(e, X, H);
+    RCP<const Basic> xy = mul(i2, y), xx = mul(i2, x),
+                     yz = mul(i3, pow(z, i2)),
+                     zz = mul(integer(6), mul(y, z));
+    REQUIRE(H == DenseMatrix(4, 4, {xy, xx, integer(0), integer(0), xx,
+                                    integer(0), yz, integer(0), integer(0), yz,
+                                    zz, integer(0), integer(0), integer(0),
+                                    integer(0), integer(0)}));
+
+    DenseMatrix H2(4, 4);
+    hessian(e, X, H2, 3);
+    REQUIRE(H == H2);
+
+    CSRMatrix S;
+    hessian(e, X, S);
+    REQUIRE(S == CSRMatrix(4, 4, {0, 2, 4, 6, 6}, {0, 1, 0, 2, 1, 2},
+                           {xy, xx, xx, yz, yz, zz}));
+
+    X = DenseMatrix(2, 1, {f, y});
+    H = DenseMatrix(2, 2);
+    CHECK_THROWS_AS(hessian(e, X, H), SymEngineException);
+}
+
 TEST_CASE("Test Diff", "[matrices]")
 {
     DenseMatrix A, J;
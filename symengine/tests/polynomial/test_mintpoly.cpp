@@ -27,6 +27,9 @@ using SymEngine::vec_basic;
 using SymEngine::vec_uint;
 using SymEngine::RCPBasicKeyLess;
 using SymEngine::MIntPoly;
+using SymEngine::MonomialPacking;
+using SymEngine::pow_mpoly;
+using SymEngine::mul_mpoly;
 
 using namespace SymEngine::literals;
 
@@ -579,6 +582,136 @@ TEST_CASE("MIntPoly from_poly", "[MIntPoly]")
 
     REQUIRE(eq(*MIntPoly::from_poly(*upoly), *mpoly));
 }
+
+TEST_CASE("MonomialPacking", "[MIntPoly]")
+{
+    MonomialPacking<uint64_t> packing;
+    uint64_t m1 = 0, m2 = 0;
+    vec_uint v(3);
+
+    REQUIRE(packing.init(3, 100));
+    REQUIRE(packing.pack(vec_uint{1, 0, 7}, m1));
+    REQUIRE(packing.pack(vec_uint{2, 5, 0}, m2));
+    // Multiplication and comparison act on the words
+    packing.unpack(m1 + m2, v);
+    REQUIRE(v == vec_uint({3, 5, 7}));
+    REQUIRE(m1 < m2);
+    REQUIRE(not packing.pack(vec_uint{1, 101, 0}, m1));
+    REQUIRE(not packing.pack(vec_int{1, -1, 0}, m1));
+
+    // 20 exponents of 10 bits each don't fit into 64 bits
+    REQUIRE(packing.init(6, 1000));
+    REQUIRE(not packing.init(20, 1000));
+    REQUIRE(not packing.init(1, uint64_t(1) << 63));
+
+#ifdef __SIZEOF_INT128__
+    // Exponents of 33 bits need two words, where a field may straddle them
+    MonomialPacking<SymEngine::uint128> packing2;
+    SymEngine::uint128 w1 = 0, w2 = 0;
+    uint64_t e = uint64_t(1) << 32;
+    REQUIRE(not packing.init(3, e));
+    REQUIRE(packing2.init(3, e));
+    REQUIRE(packing2.pack(vec_uint{1, 4294967295u, 7}, w1));
+    REQUIRE(packing2.pack(vec_uint{2, 1, 0}, w2));
+    std::vector<uint64_t> v2(3);
+    packing2.unpack(w1 + w2, v2);
+    REQUIRE(v2 == std::vector<uint64_t>({3, e, 7}));
+    REQUIRE((w1 < w2));
+    REQUIRE(not packing2.init(4, e));
+#endif
+}
+
+TEST_CASE("MIntPoly multiplication with and without packing", "[MIntPoly]")
+{
+    RCP<const Symbol> x = symbol("x");
+    RCP<const Symbol> y = symbol("y");
+    RCP<const MIntPoly> p = MIntPoly::from_dict(
+        {x, y}, {{{1, 0}, 1_z}, {{0, 1}, -1_z}, {{0, 0}, 2_z}});
+    RCP<const MIntPoly> q = pow_mpoly(*p, 2);
+    REQUIRE(eq(*q, *MIntPoly::from_dict({x, y}, {{{2, 0}, 1_z},
+                                                 {{0, 2}, 1_z},
+                                                 {{1, 1}, -2_z},
+                                                 {{1, 0}, 4_z},
+                                                 {{0, 1}, -4_z},
+                                                 {{0, 0}, 4_z}})));
+
+    // The exponents of the product need 32 bits each, so the monomials of
+    // three variables are packed into two words, and those of five variables
+    // are multiplied as exponent vectors
+    unsigned int e = 1u << 30;
+    RCP<const Symbol> z = symbol("z");
+    RCP<const Symbol> u = symbol("u");
+    RCP<const Symbol> w = symbol("w");
+    RCP<const MIntPoly> r = MIntPoly::from_dict(
+        {x, y, z}, {{{e, 1, 0}, 1_z}, {{0, e, 1}, 1_z}, {{0, 0, 0}, -1_z}});
+    REQUIRE(eq(*mul_mpoly(*r, *r),
+               *MIntPoly::from_dict({x, y, z}, {{{2 * e, 2, 0}, 1_z},
+                                                {{e, e + 1, 1}, 2_z},
+                                                {{0, 2 * e, 2}, 1_z},
+                                                {{e, 1, 0}, -2_z},
+                                                {{0, e, 1}, -2_z},
+                                                {{0, 0, 0}, 1_z}})));
+    r = MIntPoly::from_dict({x, y, z, u, w}, {{{e, 1, 0, 0, 0}, 1_z},
+                                              {{0, e, 1, 0, 0}, 1_z},
+                                              {{0, 0, 0, 0, 0}, -1_z}});
+    REQUIRE(eq(*mul_mpoly(*r, *r),
+               *MIntPoly::from_dict({x, y, z, u, w},
+                                    {{{2 * e, 2, 0, 0, 0}, 1_z},
+                                     {{e, e + 1, 1, 0, 0}, 2_z},
+                                     {{0, 2 * e, 2, 0, 0}, 1_z},
+                                     {{e, 1, 0, 0, 0}, -2_z},
+                                     {{0, e, 1, 0, 0}, -2_z},
+                                     {{0, 0, 0, 0, 0}, 1_z}})));
+
+    // Exponents that don't fit into 32 bits throw instead of wrapping
+    r = MIntPoly::from_dict({x, y}, {{{1u << 31, 1}, 1_z}});
+    CHECK_THROWS_AS(mul_mpoly(*r, *r), SymEngine::SymEngineException);
+}
+
+TEST_CASE("MIntPoly sparse multiplication", "[MIntPoly]")
+{
+    RCP<const Symbol> x = symbol("x");
+    RCP<const Symbol> y = symbol("y");
+    RCP<const Symbol> z = symbol("z");
+
+    // Terms that cancel are dropped while merging
+    RCP<const MIntPoly> p
+        = MIntPoly::from_dict({x, y}, {{{1, 0}, 1_z}, {{0, 1}, -1_z}});
+    RCP<const MIntPoly> q
+        = MIntPoly::from_dict({x, y}, {{{1, 0}, 1_z}, {{0, 1}, 1_z}});
+    REQUIRE(eq(*mul_mpoly(*p, *q),
+               *MIntPoly::from_dict({x, y},
+                                    {{{2, 0}, 1_z}, {{0, 2}, -1_z}})));
+
+    // Few of the pairs of terms give the same monomial, so the product is
+    // merged with a heap. Compare it with the product of the terms summed
+    // up one by one.
+    SymEngine::MIntDict a(3), b(3), c(3);
+    for (unsigned int i = 0; i < 60; i++) {
+        a.dict_[{i * i % 97, i * i * i % 89, i}] = integer_class(i) - 30;
+        b.dict_[{i % 7, i * 13 % 61, i * i % 53}] = integer_class(i) + 1;
+    }
+    for (auto const &s : a.dict_) {
+        for (auto const &t : b.dict_) {
+            vec_uint m = {s.first[0] + t.first[0], s.first[1] + t.first[1],
+                          s.first[2] + t.first[2]};
+            c.dict_[m] += s.second * t.second;
+        }
+    }
+    for (auto it = c.dict_.begin(); it != c.dict_.end();) {
+        if (it->second == 0)
+            it = c.dict_.erase(it);
+        else
+            ++it;
+    }
+    REQUIRE(SymEngine::MIntDict::mul(a, b) == c);
+    // The monomials are split into ranges that are merged separately
+    REQUIRE(SymEngine::MIntDict::mul(a, b, 4) == c);
+
+    RCP<const MIntPoly> r = MIntPoly::from_container({x, y, z}, std::move(a));
+    RCP<const MIntPoly> s = MIntPoly::from_container({x, y, z}, std::move(b));
+    REQUIRE(eq(*mul_mpoly(*r, *s, 4), *mul_mpoly(*r, *s)));
+}
 /*
 TEST_CASE("Testing equality of MultivariateExprPolynomials with Expressions",
           "[MultivariateExprPolynomial],[Expression]")
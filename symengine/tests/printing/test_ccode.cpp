@@ -35,6 +35,15 @@ TEST_CASE("Functions", "[ccode]")
     auto x = symbol("x");
     auto p = sin(x);
     REQUIRE(ccode(*p) == "sin(x)");
+
+    auto y = symbol("y");
+    REQUIRE(ccode(*SymEngine::abs(x)) == "fabs(x)");
+    REQUIRE(ccode(*SymEngine::gamma(x)) == "tgamma(x)");
+    REQUIRE(ccode(*SymEngine::max({x, y, integer(2)}))
+            == "fmax(2, fmax(x, y))");
+    REQUIRE(ccode(*div(y, SymEngine::cot(x))) == "y/(1.0/tan(x))");
+    REQUIRE(ccode(*SymEngine::acsc(x)) == "asin(1.0/(x))");
+    REQUIRE(ccode(*div(x, integer(2))) == "(1.0/2.0)*x");
 }
 
 TEST_CASE("Piecewise", "[ccode]")
@@ -49,6 +49,75 @@ void postorder_traversal_stop(const Basic &b, StopVisitor &v)
     b.accept(v);
 }
 
+namespace
+{
+
+/* Calls `f` for the arguments whose signatures make up the signature of `b`.
+ * \return false for the classes of unknown structure, which have all bits */
+template <typename F>
+bool for_each_signature_arg(const Basic &b, F &&f)
+{
+    if (is_a<Add>(b)) {
+        for (const auto &p : static_cast<const Add &>(b).get_dict())
+            f(*p.first);
+    } else if (is_a<Mul>(b)) {
+        for (const auto &p : static_cast<const Mul &>(b).get_dict()) {
+            f(*p.first);
+            f(*p.second);
+        }
+    } else if (is_a<Pow>(b)) {
+        f(*static_cast<const Pow &>(b).get_base());
+        f(*static_cast<const Pow &>(b).get_exp());
+    } else if (is_a_sub<Function>(b) or is_a<Derivative>(b)
+               or is_a<Subs>(b)) {
+        for (const auto &p : b.get_args())
+            f(*p);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+hash_t compute_symbol_signature(const Basic &b)
+{
+    if (is_a<Symbol>(b))
+        return hash_t(1) << (b.hash() % 63);
+    if (is_a_Number(b) or is_a<Constant>(b))
+        return 0;
+#ifdef WITH_SYMENGINE_SYMBOL_SIGNATURE
+    // The arguments whose signatures are not cached yet are computed first,
+    // in post-order with an explicit stack, so that deep expressions don't
+    // overflow the stack
+    std::vector<std::pair<const Basic *, bool>> stack;
+    auto push = [&](const Basic &a) {
+        if (a.signature_ == 0)
+            stack.push_back({&a, false});
+    };
+    for_each_signature_arg(b, push);
+    while (not stack.empty()) {
+        const Basic *a = stack.back().first;
+        if (a->signature_ != 0) {
+            stack.pop_back();
+        } else if (stack.back().second) {
+            stack.pop_back();
+            a->symbol_signature();
+        } else {
+            stack.back().second = true;
+            for_each_signature_arg(*a, push);
+        }
+    }
+#endif
+    hash_t signature = 0;
+    if (not for_each_signature_arg(
+            b, [&](const Basic &a) { signature |= symbol_signature(a); })) {
+        // The symbols may be hidden in other classes, e.g. polynomials
+        signature = ~hash_t(0) >> 1;
+    }
+    return signature;
+}
+
 bool has_symbol(const Basic &b, const Symbol &x)
 {
     // We are breaking a rule when using ptrFromRef() here, but since
@@ -92,7 +161,8 @@ public:
     void bvisit(const Basic &x)
     {
         for (const auto &p : x.get_args()) {
-            p->accept(*this);
+            if (symbol_signature(*p) != 0)
+                p->accept(*this);
         }
     }
 
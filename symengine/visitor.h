@@ -99,11 +99,25 @@ public:
 
     void bvisit(const Basic &x){};
 
+    // The preorder traversal, without the subexpressions whose signature
+    // rules out `x_`
+    void traverse(const Basic &b)
+    {
+        if (not may_have_symbol(b, *x_))
+            return;
+        b.accept(*this);
+        for (const auto &p : b.get_args()) {
+            if (stop_)
+                return;
+            traverse(*p);
+        }
+    }
+
     bool apply(const Basic &b)
     {
         has_ = false;
         stop_ = false;
-        preorder_traversal_stop(b, *this);
+        traverse(b);
         return has_;
     }
 };